@@ -0,0 +1,124 @@
+/// audio_batch.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_batch.h"
+#include "audio_codec.h"
+#include "audio_sequence.h"
+
+#include "../utils/utils_parallel.h"
+#include "../utils/utils_thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+
+namespace batch_ {
+
+// Bytes of the decoded sequences of the running jobs.
+class memory_budget {
+public:
+	explicit memory_budget (size_t budget) :
+		budget_(budget),
+		used_(0) {
+	}
+
+	void acquire (size_t size) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		released_.wait(lock, [&] { return used_ + size <= budget_; });
+		used_ += size;
+	}
+
+	void release (size_t size) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			used_ -= size;
+		}
+		released_.notify_all();
+	}
+
+	// caps the size of a job to the budget so it can run alone
+	size_t cap (size_t size) const noexcept {
+		return std::min(size, budget_);
+	}
+
+private:
+	const size_t budget_;
+	size_t used_;
+	std::mutex mutex_;
+	std::condition_variable released_;
+};
+
+void transcode (
+		const batch::job &job,
+		unsigned int thread_count,
+		memory_budget &memory) {
+	const codec::info info = probe(job.input);
+	const size_t size = memory.cap(
+		info.frame_count*info.format.channel_count()*sizeof(float));
+
+	const bool split = info.frame_count >= batch::split_frame_count;
+
+	codec::encoder_options options = job.options;
+	if (split && options.thread_count == 1) {
+		options.thread_count = thread_count;
+	}
+
+	memory.acquire(size);
+	try {
+		store_buffer(job.output,
+			load_buffer(job.input, split ? thread_count : 1), options);
+	} catch (...) {
+		memory.release(size);
+		throw;
+	}
+	memory.release(size);
+}
+
+} // namespace batch_
+
+batch::batch (unsigned int thread_count, size_t memory_budget) :
+	thread_count_(utils::thread_count(thread_count)),
+	memory_budget_(memory_budget) {
+}
+
+std::vector<batch::result>
+batch::run (const std::vector<job> &jobs, const callback &on_done) const {
+	std::vector<result> results(jobs.size(), result{ result::Failed, "", 0. });
+	batch_::memory_budget memory(memory_budget_);
+	std::mutex mutex;
+
+	utils::thread_pool pool(thread_count_);
+
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		pool.submit([&, i] {
+			const auto start = std::chrono::steady_clock::now();
+			result &res = results[i];
+
+			try {
+				batch_::transcode(jobs[i], thread_count_, memory);
+				res.status = result::Done;
+			} catch (const std::exception &err) {
+				res.message = err.what();
+			} catch (...) {
+				res.message = "unexpected error";
+			}
+			res.duration = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+
+			if (on_done) {
+				std::lock_guard<std::mutex> lock(mutex);
+				on_done(i, res);
+			}
+		});
+	}
+	pool.wait();
+
+	return results;
+}
@@ -0,0 +1,121 @@
+/// audio_batch.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_BATCH_H_
+#define AUDIO_BATCH_H_
+
+#include <audio/error>
+#include <audio/format>
+#include <audio/codecs/encoder_options>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+/// class com::nealrame::audio::batch
+/// =================================
+/// Transcodes files in parallel. Each job decodes a file with the codec
+/// found by its content, then encodes it with the codec of the extension
+/// of its output.
+///
+/// Jobs run on a work stealing `utils::thread_pool`. A job holds the
+/// memory of its decoded sequence, estimated by probing its input, while
+/// it runs. Jobs wait for memory to be released before they start when
+/// the memory of the running ones exceeds the budget of the batch.
+class batch {
+public:
+	/// struct com::nealrame::audio::batch::job
+	/// =======================================
+	struct job {
+		/// Path of the file to be decoded.
+		std::string input;
+
+		/// Path of the file to be encoded.
+		std::string output;
+
+		/// Settings of the coder.
+		codec::encoder_options options;
+	};
+
+	/// struct com::nealrame::audio::batch::result
+	/// ==========================================
+	struct result {
+		enum status {
+			Done,
+			Failed,
+		};
+
+		/// Outcome of the job.
+		enum status status;
+
+		/// Error message of a failed job.
+		std::string message;
+
+		/// Time spent running the job, in seconds.
+		double duration;
+	};
+
+	/// Called once a job is done with the index and the result of the
+	/// job. Calls are serialized.
+	using callback = std::function<void (size_t, const result &)>;
+
+public:
+	/// Default memory budget of a `batch`: 1 GiB.
+	static const size_t default_memory_budget = size_t(1) << 30;
+
+	/// Count of frames from which a job decodes its input and encodes its
+	/// sequence with all the threads of the batch, unless its options
+	/// already set a count of threads for the encoder. About 3 minutes at
+	/// 44.1 kHz.
+	static const format::size_type split_frame_count = format::size_type(1) << 23;
+
+public:
+	/// Constructs a `batch`.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads. A count of 0 stands for the count of
+	///   hardware threads.
+	/// - `memory_budget`
+	///   The maximum size in bytes of the sequences decoded at once. A
+	///   job bigger than the budget runs alone.
+	explicit batch (
+		unsigned int thread_count = 0,
+		size_t memory_budget = default_memory_budget);
+
+public:
+	/// Returns the count of threads.
+	unsigned int thread_count () const noexcept
+	{ return thread_count_; }
+
+	/// Returns the maximum size in bytes of the sequences decoded at once.
+	size_t memory_budget () const noexcept
+	{ return memory_budget_; }
+
+public:
+	/// Runs the given jobs and returns their results, in the same order.
+	/// Failed jobs do not stop the others.
+	///
+	/// *Parameters:*
+	/// - `jobs`
+	///   The jobs to be run.
+	/// - `on_done`
+	///   Called once each job is done. May be null.
+	std::vector<result> run (
+		const std::vector<job> &jobs,
+		const callback &on_done = nullptr) const;
+
+private:
+	unsigned int thread_count_;
+	size_t memory_budget_;
+};
+} // namespace audio
+} // namespace nealrame
+} // namespace com
+
+#endif /* AUDIO_BATCH_H_ */
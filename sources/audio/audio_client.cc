@@ -0,0 +1,188 @@
+/// audio_client.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "audio_client.h"
+
+#include "../utils/utils_shared_memory.h"
+#include "../utils/utils_unix_socket.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+
+namespace client_ {
+
+std::string absolute (const std::string &filepath) {
+	char path[PATH_MAX];
+	if (realpath(filepath.c_str(), path) == nullptr) {
+		// the server reports the missing file
+		return filepath;
+	}
+	return path;
+}
+
+std::unique_ptr<utils::shared_memory> share (const void *data, size_t size) {
+	std::unique_ptr<utils::shared_memory> memory(new utils::shared_memory(size));
+
+	if (! memory->is_open()) {
+		error::raise_literal(error::IOError, "failed to create shared memory");
+	}
+	if (size > 0) {
+		std::memcpy(memory->writable_data(), data, size);
+	}
+	if (! memory->seal()) {
+		error::raise_literal(error::IOError, "failed to seal shared memory");
+	}
+	return memory;
+}
+
+service::request make_request (
+		enum service::operation operation,
+		const std::string &input,
+		const std::string &extension = std::string(),
+		const codec::encoder_options &options = codec::encoder_options()) {
+	return service::request{ operation, input, extension, options };
+}
+
+codec::info info (const service::response &res) {
+	return codec::info{
+		res.codec,
+		format(res.channel_count, res.sample_rate),
+		res.frame_count,
+		res.bitrate
+	};
+}
+
+} // namespace client_
+
+client::client (const std::string &socket_path) :
+	fd_(utils::connect_unix(socket_path)),
+	buffer_(service::max_message_size) {
+	if (fd_ < 0) {
+		error::raise(error::IOError, "failed to connect to " + socket_path);
+	}
+}
+
+client::~client () {
+	if (fd_ >= 0) {
+		::close(fd_);
+	}
+}
+
+codec::info client::probe (const std::string &filepath) {
+	return client_::info(call_(
+		client_::make_request(service::Probe, client_::absolute(filepath)),
+		nullptr, nullptr));
+}
+
+codec::info client::probe (const void *data, size_t size) {
+	const auto input = client_::share(data, size);
+	return client_::info(call_(
+		client_::make_request(service::Probe, ""),
+		input.get(), nullptr));
+}
+
+shared_sequence client::decode (const std::string &filepath) {
+	std::shared_ptr<utils::shared_memory> output;
+	call_(client_::make_request(service::Decode, client_::absolute(filepath)),
+		nullptr, &output);
+	return shared_sequence(std::move(output));
+}
+
+shared_sequence client::decode (const void *data, size_t size) {
+	const auto input = client_::share(data, size);
+	std::shared_ptr<utils::shared_memory> output;
+	call_(client_::make_request(service::Decode, ""), input.get(), &output);
+	return shared_sequence(std::move(output));
+}
+
+std::shared_ptr<const utils::shared_memory> client::encode (
+		shared_sequence &seq,
+		const std::string &extension,
+		const codec::encoder_options &options) {
+	seq.seal();
+	std::shared_ptr<utils::shared_memory> output;
+	call_(client_::make_request(service::Encode, "", extension, options),
+		&seq.memory(), &output);
+	return output;
+}
+
+std::shared_ptr<const utils::shared_memory> client::transcode (
+		const std::string &filepath,
+		const std::string &extension,
+		const codec::encoder_options &options) {
+	std::shared_ptr<utils::shared_memory> output;
+	call_(client_::make_request(
+			service::Transcode, client_::absolute(filepath), extension, options),
+		nullptr, &output);
+	return output;
+}
+
+std::shared_ptr<const utils::shared_memory> client::transcode (
+		const void *data,
+		size_t size,
+		const std::string &extension,
+		const codec::encoder_options &options) {
+	const auto input = client_::share(data, size);
+	std::shared_ptr<utils::shared_memory> output;
+	call_(client_::make_request(service::Transcode, "", extension, options),
+		input.get(), &output);
+	return output;
+}
+
+service::response client::call_ (
+		const service::request &req,
+		const utils::shared_memory *input,
+		std::shared_ptr<utils::shared_memory> *output) {
+	const std::string message = service::pack(req);
+
+	if (message.size() > service::max_message_size) {
+		error::raise_literal(error::IOError, "request too long");
+	}
+	if (! utils::send_message(fd_, message.data(), message.size(),
+			input != nullptr ? input->descriptor() : -1)) {
+		error::raise_literal(error::IOError, "failed to send request");
+	}
+
+	int fd;
+	const ssize_t size =
+		utils::receive_message(fd_, buffer_.data(), buffer_.size(), fd);
+	if (size <= 0) {
+		error::raise_literal(error::IOError, "failed to receive response");
+	}
+
+	service::response res;
+	if (! service::unpack(buffer_.data(), size, res)) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		error::raise_literal(error::CodecFormatError, "malformed response");
+	}
+
+	if (res.status != 0) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		if (res.status > error::OperationCancelled) {
+			res.status = error::CodecUnexpectedError;
+		}
+		error::raise(static_cast<enum error::status>(res.status), res.message);
+	}
+
+	if (output != nullptr) {
+		*output = fd >= 0 ? utils::shared_memory::adopt(fd) : nullptr;
+		if (! *output) {
+			error::raise_literal(error::IOError, "no sealed result received");
+		}
+	} else if (fd >= 0) {
+		::close(fd);
+	}
+
+	return res;
+}
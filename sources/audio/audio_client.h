@@ -0,0 +1,106 @@
+/// audio_client.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_CLIENT_H_
+#define AUDIO_CLIENT_H_
+
+#include <audio/error>
+#include <audio/service>
+#include <audio/shared_sequence>
+#include <audio/codecs/encoder_options>
+#include <audio/codecs/info>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+class shared_memory;
+} /* namespace utils */
+namespace audio {
+/// class com::nealrame::audio::client
+/// ==================================
+/// Sends requests to a `server` and waits for their responses. A `client`
+/// runs one request at a time, threads should use a `client` each.
+///
+/// Files are read by the server: relative paths are made absolute before
+/// they are sent. Data in memory are copied once to shared memory, then
+/// sent without copy. Results are received without copy as well.
+///
+/// Errors of the requests are raised as the `error` the server caught.
+class client {
+public:
+	/// Connects to the server listening at the given path.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the server can not be reached.
+	explicit client (const std::string &socket_path);
+
+	client (const client &) = delete;
+	client & operator= (const client &) = delete;
+
+	~client ();
+
+public:
+	/// Probes the given file.
+	codec::info probe (const std::string &filepath);
+
+	/// Probes the given encoded stream.
+	codec::info probe (const void *data, size_t size);
+
+	/// Decodes the given file.
+	shared_sequence decode (const std::string &filepath);
+
+	/// Decodes the given encoded stream.
+	shared_sequence decode (const void *data, size_t size);
+
+	/// Encodes the given frames, which are sealed first.
+	///
+	/// *Parameters:*
+	/// - `seq`
+	///   The frames to be encoded.
+	/// - `extension`
+	///   Extension of the codec of the stream, with its leading dot.
+	/// - `options`
+	///   Settings of the coder.
+	///
+	/// *Returns:*
+	/// The sealed bytes of the stream.
+	std::shared_ptr<const utils::shared_memory> encode (
+			shared_sequence &seq,
+			const std::string &extension,
+			const codec::encoder_options &options = codec::encoder_options());
+
+	/// Decodes the given file, then encodes it as `encode` does.
+	std::shared_ptr<const utils::shared_memory> transcode (
+			const std::string &filepath,
+			const std::string &extension,
+			const codec::encoder_options &options = codec::encoder_options());
+
+	/// Decodes the given encoded stream, then encodes it as `encode`
+	/// does.
+	std::shared_ptr<const utils::shared_memory> transcode (
+			const void *data,
+			size_t size,
+			const std::string &extension,
+			const codec::encoder_options &options = codec::encoder_options());
+
+private:
+	service::response call_ (
+			const service::request &req,
+			const utils::shared_memory *input,
+			std::shared_ptr<utils::shared_memory> *output);
+
+private:
+	int fd_;
+	std::vector<char> buffer_;
+};
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_CLIENT_H_ */
@@ -5,69 +5,105 @@
 #include "audio_codec.h"
 #include "audio_sequence.h"
 
-#include <boost/algorithm/string.hpp>
-
-// Wave PCM codec
-#include "codecs/audio_wave_coder.h"
-#include "codecs/audio_wave_decoder.h"
-
-// MP3 codec
-#include "codecs/audio_mp3_coder.h"
-#include "codecs/audio_mp3_decoder.h"
-
-// Ogg Vorbis codec
-#include "codecs/audio_ogg_vorbis_coder.h"
-#include "codecs/audio_ogg_vorbis_decoder.h"
+#include "codecs/audio_registry.h"
 
 namespace com {
 namespace nealrame {
 namespace audio {
 
-std::shared_ptr<codec::coder> get_coder(const std::string &ext) {
-	std::string extension = boost::to_lower_copy(ext);
+namespace codec_ {
 
-	if (extension == ".wav") {
-		return std::make_shared<codec::WAVE_coder>();
+std::string extension(const std::string &filename) {
+	std::string::size_type dot = filename.find_last_of("./");
+	if (dot == std::string::npos || filename[dot] != '.') {
+		return std::string();
 	}
-	if (extension == ".mp3") {
-		return std::make_shared<codec::MP3_coder>();
+	return filename.substr(dot);
+}
+
+const codec::registry::entry & find_coder(const std::string &ext) {
+	const codec::registry::entry *entry =
+		codec::registry::instance().find_extension(ext);
+
+	if (entry == nullptr || ! entry->shared_coder) {
+		throw error(error::CoderNotFound);
 	}
-	if (extension == ".ogg") {
-		return std::make_shared<codec::OGGVorbis_coder>();
+
+	return *entry;
+}
+
+std::shared_ptr<codec::decoder> find_decoder(const codec::registry::entry *entry) {
+	if (entry == nullptr || ! entry->shared_decoder) {
+		throw error(error::DecoderNotFound);
 	}
 
-	throw error(error::CoderNotFound);
+	return entry->shared_decoder;
 }
 
-std::shared_ptr<codec::decoder> get_decoder(const std::string &ext) {
-	std::string extension = boost::to_lower_copy(ext);
+} // namespace codec_
 
-	if (extension == ".wav") {
-		return std::make_shared<codec::WAVE_decoder>();
-	}
-	if (extension == ".mp3") {
-		return std::make_shared<codec::MP3_decoder>();
-	}
-	if (extension == ".ogg") {
-		return std::make_shared<codec::OGGVorbis_decoder>();
+std::shared_ptr<codec::coder> get_coder(const std::string &ext) {
+	return codec_::find_coder(ext).shared_coder;
+}
+
+std::shared_ptr<codec::coder> get_coder(
+	const std::string &ext,
+	const codec::encoder_options &options) {
+	const codec::registry::entry &entry = codec_::find_coder(ext);
+
+	if (! entry.make_coder) {
+		return entry.shared_coder;
 	}
 
-	throw error(error::DecoderNotFound);
+	return entry.make_coder(options);
+}
+
+std::shared_ptr<codec::decoder> get_decoder(const std::string &ext) {
+	return codec_::find_decoder(codec::registry::instance().find_extension(ext));
 }
 
+std::shared_ptr<codec::decoder> get_decoder(std::istream &stream) {
+	return codec_::find_decoder(codec::registry::instance().find_content(stream));
+}
 
 audio::sequence load_buffer(const std::string &filename) {
-	std::string extension = filename.substr(filename.length() - 4);
-	std::shared_ptr<audio::codec::decoder> decoder =
-		audio::get_decoder(extension);
-	return decoder->decode(filename);
+	return codec_::find_decoder(codec::registry::instance().find_file(filename))
+		->decode(filename);
+}
+
+audio::sequence load_buffer(
+	const std::string &filename,
+	unsigned int thread_count) {
+	const codec::registry::entry *entry =
+		codec::registry::instance().find_file(filename);
+
+	if (entry == nullptr || ! entry->make_decoder || thread_count == 1) {
+		return codec_::find_decoder(entry)->decode(filename);
+	}
+
+	return entry->make_decoder(thread_count)->decode(filename);
+}
+
+audio::sequence load_buffer(
+	const std::string &filename,
+	const codec::cache &cache) {
+	return cache.load(filename);
+}
+
+codec::info probe(const std::string &filename) {
+	return codec_::find_decoder(codec::registry::instance().find_file(filename))
+		->probe(filename);
 }
 
 void store_buffer(const std::string &filename, const audio::sequence &seq) {
-	std::string extension = filename.substr(filename.length() - 4);
-	std::shared_ptr<audio::codec::coder> coder =
-		audio::get_coder(extension);
-	coder->encode(filename, seq);
+	get_coder(codec_::extension(filename))->encode(filename, seq);
+}
+
+void store_buffer(
+	const std::string &filename,
+	const audio::sequence &seq,
+	const codec::encoder_options &options) {
+	get_coder(codec_::extension(filename), options)->encode(filename, seq);
 }
 
 }
@@ -5,8 +5,10 @@
 #ifndef AUDIO_CODEC_H_
 #define AUDIO_CODEC_H_
 
+#include <audio/codecs/cache>
 #include <audio/codecs/coder>
 #include <audio/codecs/decoder>
+#include <audio/codecs/encoder_options>
 
 #include <string>
 #include <memory>
@@ -15,11 +17,49 @@ namespace com {
 namespace nealrame {
 namespace audio {
 
+/// Returns the shared coder of the files with the given extension.
+///
+/// *Exceptions:*
+/// - `error`
+///   With status `CoderNotFound` if no registered codec handles the
+///   extension.
 std::shared_ptr<codec::coder> get_coder(const std::string &ext);
+
+/// Returns a coder of the files with the given extension, with the given
+/// settings.
+std::shared_ptr<codec::coder> get_coder(
+	const std::string &ext,
+	const codec::encoder_options &options);
+
+/// Returns the shared decoder of the files with the given extension.
+///
+/// *Exceptions:*
+/// - `error`
+///   With status `DecoderNotFound` if no registered codec handles the
+///   extension.
 std::shared_ptr<codec::decoder> get_decoder(const std::string &ext);
 
+/// Returns the shared decoder of the given stream, found by its first
+/// bytes. The stream must be seekable, it is left at its position.
+std::shared_ptr<codec::decoder> get_decoder(std::istream &);
+
 sequence load_buffer(const std::string &filename);
+
+/// Same as `load_buffer(filename)`, but the decoded sequence is read from
+/// the given cache if it is there and stored to it otherwise.
+sequence load_buffer(const std::string &filename, const codec::cache &cache);
+
+/// Same as `load_buffer(filename)`, but the file is decoded with the given
+/// count of threads by the codecs which can split their streams. A count of
+/// 0 stands for the count of hardware threads.
+sequence load_buffer(const std::string &filename, unsigned int thread_count);
+
+codec::info probe(const std::string &filename);
 void store_buffer(const std::string &filename, const sequence &);
+void store_buffer(
+	const std::string &filename,
+	const sequence &,
+	const codec::encoder_options &options);
 
 } // namespace audio
 } // namespace nealrame
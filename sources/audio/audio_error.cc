@@ -2,17 +2,63 @@
 
 using namespace com::nealrame::audio;
 
-error::error (enum status s) :
-	error(s, std::string()) {
+namespace error_ {
+
+class category : public std::error_category {
+public:
+	virtual const char * name () const noexcept {
+		return "audio";
+	}
+
+	virtual std::string message (int status) const {
+		return description(static_cast<enum error::status>(status));
+	}
+
+	// Descriptions are string literals, so that errors without message
+	// are built without allocation.
+	static const char * description (enum error::status status) noexcept {
+		switch (status) {
+		case error::CodecFormatError:
+			return "malformed stream";
+		case error::CoderNotFound:
+			return "no coder found";
+		case error::CodecUnexpectedError:
+			return "unexpected codec error";
+		case error::DecoderNotFound:
+			return "no decoder found";
+		case error::FormatUnhandledChannelCountValueError:
+			return "unhandled channel count";
+		case error::FormatUnhandledSampleRateValueError:
+			return "unhandled sample rate";
+		case error::FormatUnhandledSampleQuantificationValueError:
+			return "unhandled sample quantification";
+		case error::FormatMismatchedError:
+			return "mismatched formats";
+		case error::IOError:
+			return "input/output error";
+		case error::OperationCancelled:
+			return "operation cancelled";
+		}
+		return "unknown error";
+	}
+};
+
+} // namespace error_
+
+error::error (enum status s) noexcept :
+	status_(s),
+	literal_(nullptr) {
 }
 
 error::error (enum status status, const std::string &msg) :
 	status_(status),
+	literal_(nullptr),
 	message_(msg) {
 }
 
 error::error (enum status status, std::string &&msg) :
 	status_(status),
+	literal_(nullptr),
 	message_(std::move(msg)) {
 }
 
@@ -21,25 +67,47 @@ error::error (const error &other) {
 }
 
 error::error (error &&other) {
-	(*this) = other;
+	(*this) = std::move(other);
 }
 
 enum error::status error::status () const noexcept {
 	return status_;
 }
 
+std::error_code error::code () const noexcept {
+	return make_error_code(status_);
+}
+
 const char * error::what () const noexcept {
-	return message_.data();
+	if (literal_ != nullptr) {
+		return literal_;
+	}
+	if (! message_.empty()) {
+		return message_.data();
+	}
+	return error_::category::description(status_);
 }
 
 error & error::operator= (const error &other) {
 	status_ = other.status_;
+	literal_ = other.literal_;
 	message_ = other.message_;
 	return *this;
 }
 
 error & error::operator= (error &&other) {
 	status_ = other.status_;
+	literal_ = other.literal_;
 	message_ = std::move(other.message_);
 	return *this;
 }
+
+const std::error_category & com::nealrame::audio::error_category () noexcept {
+	static const error_::category category;
+	return category;
+}
+
+std::error_code com::nealrame::audio::make_error_code (enum error::status status)
+	noexcept {
+	return std::error_code(static_cast<int>(status), error_category());
+}
@@ -5,8 +5,13 @@
 #ifndef AUDIO_ERROR_H_
 #define AUDIO_ERROR_H_
 
+#include <cstddef>
 #include <exception>
+#include <new>
 #include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 
 namespace com {
 namespace nealrame {
@@ -16,7 +21,7 @@ namespace audio {
 class error : public std::exception {
 public:
 	enum status {
-		CodecFormatError,
+		CodecFormatError = 1,
 		CoderNotFound,
 		CodecUnexpectedError,
 		DecoderNotFound,
@@ -25,26 +30,57 @@ public:
 		FormatUnhandledSampleQuantificationValueError,
 		FormatMismatchedError,
 		IOError,
+		OperationCancelled,
 	};
 public:
-	static void raise (enum status s)
-		throw(error) {
-		throw error(s, std::string());
+	[[noreturn]] static void raise (enum status s) {
+		throw error(s);
 	}
-	static void raise (enum status s, const char *msg)
-		throw(error) {
-		throw error(s, msg);
+	template <typename Message>
+	[[noreturn]] static void raise (enum status s, Message &&msg) {
+		throw error(s, std::forward<Message>(msg));
 	}
-	static void raise (enum status s, const std::string &msg)
-		throw(error) {
-		throw error(s, msg);
+	/// Same as `raise(s, msg)`, but the message is not copied: it must be
+	/// a string literal, so that the error is thrown without allocation.
+	template <size_t N>
+	[[noreturn]] static void raise_literal (enum status s, const char (&msg)[N]) {
+		throw error(s, msg, literal_tag_());
 	}
-	static void raise (enum status s, std::string &&msg)
-		throw(error) {
-		throw error(s, std::move(msg));
+	/// Calls the given function and returns the `std::error_code` of the
+	/// exception it throws, or an empty code if it returns. Exceptions
+	/// other than `error`, `std::system_error` and `std::bad_alloc` give
+	/// the `CodecUnexpectedError` status.
+	///
+	/// The exception is still thrown, and `f` unwound, before it is
+	/// turned into a code: only its caller sees no exception.
+	template <typename Function>
+	static std::error_code capture (Function &&f) noexcept {
+		try {
+			f();
+			return std::error_code();
+		} catch (const error &err) {
+			return err.code();
+		} catch (const std::system_error &err) {
+			return err.code();
+		} catch (const std::bad_alloc &) {
+			return std::make_error_code(std::errc::not_enough_memory);
+		} catch (...) {
+			return error(CodecUnexpectedError).code();
+		}
 	}
 public:
-	error (status);
+	error (status) noexcept;
+
+	/// Messages are copied, see `raise_literal` for string literals.
+	template <
+		typename String,
+		typename = typename std::enable_if<
+			std::is_convertible<String, const char *>::value
+		>::type>
+	error (enum status s, String &&msg) :
+		error(s, message_of_(msg)) {
+	}
+
 	error (status, const std::string &);
 	error (status, std::string &&);
 	error (const error &);
@@ -53,14 +89,46 @@ public:
 	error & operator= (const error &other);
 	error & operator= (error &&other);
 public:
+	/// Returns the message of this error, or the description of its
+	/// status if it has no message.
 	virtual const char * what () const noexcept;
 	enum status status () const noexcept;
+	/// Returns the `std::error_code` of the status of this error.
+	std::error_code code () const noexcept;
+private:
+	struct literal_tag_ {};
+
+	error (enum status s, const char *msg, literal_tag_) noexcept :
+		status_(s),
+		literal_(msg) {
+	}
+
+	static std::string message_of_ (const char *msg) {
+		return msg != nullptr ? std::string(msg) : std::string();
+	}
+
 private:
 	enum status status_;
+	const char *literal_;
 	std::string message_;
 };
+
+/// Returns the category of the `std::error_code` holding the statuses of
+/// `error`.
+const std::error_category & error_category () noexcept;
+
+/// Returns the `std::error_code` of the given status.
+std::error_code make_error_code (enum error::status) noexcept;
+
 } // namespace audio
 } // namespace nealrame
 } // namespace com
 
+namespace std {
+template <>
+struct is_error_code_enum<enum com::nealrame::audio::error::status>
+	: true_type {
+};
+} // namespace std
+
 #endif /* AUDIO_ERROR_H_ */
\ No newline at end of file
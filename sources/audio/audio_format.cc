@@ -2,8 +2,7 @@
 
 using namespace com::nealrame::audio;
 
-format::format (unsigned int channel_count, unsigned int frame_rate)
-	throw(error) {
+format::format (unsigned int channel_count, unsigned int frame_rate) {
 	if (channel_count < 1) {
 		error::raise(error::FormatUnhandledChannelCountValueError);
 	}
@@ -11,7 +10,7 @@ format::format (unsigned int channel_count, unsigned int frame_rate)
 	set_frame_rate(frame_rate);
 }
 
-format & format::set_frame_rate (unsigned int rate) throw(error) {
+format & format::set_frame_rate (unsigned int rate) {
 	switch (rate) {
 	case  8000:
 	case 16000:
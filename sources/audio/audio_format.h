@@ -28,8 +28,7 @@ public:
 	///   If channel count or frame rate are not valid throw an error
 	/// with status `FormatWrongSampleRateValueError` or
 	/// `FormatWrongChannelCountValueError`.
-	format (unsigned int channel_count, unsigned int sample_rate)
-		throw(error);
+	format (unsigned int channel_count, unsigned int sample_rate);
 public:
 	/// Returns `true` if this `format` and the other are equals.
 	bool operator== (const format &rhs) const noexcept;
@@ -52,7 +51,7 @@ public:
 	///
 	/// *Exeception:*
 	/// - `error` if frame rate is not valid
-	format & set_frame_rate (unsigned int frame_rate) throw(error);
+	format & set_frame_rate (unsigned int frame_rate);
 
 	/// Returns the duration for the given frame count.
 	///
@@ -154,7 +154,7 @@ void sequence::append(const frame &frame) {
 	}
 }
 
-void sequence::append(const sequence &rhs) throw(error) {
+void sequence::append(const sequence &rhs) {
 	for (auto sample: rhs.d_->frames) {
 		d_->frames.push_back(sample);
 	}
@@ -177,6 +177,17 @@ sequence::frame_iterator sequence::set_frame_count (format::size_type frame_coun
 	return it;
 }
 
+void sequence::reset(const class format &format)
+{
+	if (! d_) {
+		// moved from
+		d_.reset(new impl{format});
+		return;
+	}
+	d_->frames.clear();
+	d_->format = format;
+}
+
 /// Returns a `frame_iterator` on the first frame of this `sequence`.
 sequence::frame_iterator sequence::begin()
 { return frame_iterator(at(0)); }
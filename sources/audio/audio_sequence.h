@@ -254,7 +254,7 @@ public:
 	///   If the given `sequence` format is different than the format of
 	///   this `sequence` an `error` exeception with status 
 	///   `FormatMismatched` will be raised.
-	void append(const sequence &other) throw(error);
+	void append(const sequence &other);
 
 	/// Sets this audio `sequence`'s capacity so that it can contain enough
 	/// audio frames for the specified duration.
@@ -311,6 +311,18 @@ public:
 	///   The requested count of frames.
 	frame_iterator set_frame_count(format::size_type frame_count);
 
+	/// Removes all the audio frames of this `sequence` and sets its
+	/// format to the given one.
+	///
+	/// The memory of this `sequence` is kept, so that frames can be
+	/// added up to its former size without allocation. No audio frames
+	/// iterators or references remain valid.
+	///
+	/// *Parameters:*
+	/// - `format`
+	///   The new format of this `sequence`.
+	void reset(const class format &format);
+
 public:
 	/// Returns a `frame_iterator` on the first frame of this `sequence`.
 	frame_iterator begin();
@@ -0,0 +1,592 @@
+/// audio_server.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "audio_server.h"
+#include "audio_codec.h"
+#include "audio_sequence.h"
+#include "audio_shared_sequence.h"
+
+#include "codecs/audio_registry.h"
+
+#include "../utils/utils_shared_memory.h"
+#include "../utils/utils_thread_pool.h"
+#include "../utils/utils_unix_socket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+
+namespace server_ {
+
+// Time after which a client which does not read its responses is dropped.
+const int send_timeout = 5;
+
+// Time during which no client is accepted once descriptors are exhausted.
+const std::chrono::milliseconds accept_backoff(100);
+
+// Maximum count of coders kept for their settings.
+const size_t max_coder_count = 32;
+
+// A connected client. Its socket is closed once neither the server nor a
+// pending request holds it.
+struct connection {
+	explicit connection (int fd) :
+		fd(fd) {
+	}
+
+	~connection () {
+		::close(fd);
+	}
+
+	const int fd;
+};
+
+// The response to a request and the sealed area sent with it.
+struct result {
+	service::response response;
+	std::shared_ptr<const void> owner;
+	int fd;
+	size_t size;
+};
+
+// A request read from a client.
+struct task {
+	std::shared_ptr<connection> peer;
+	service::request request;
+	std::shared_ptr<utils::shared_memory> input;
+
+	// size in bytes of the input
+	size_t size;
+
+	// identifies identical requests and their cached result, empty if the
+	// result is not to be shared
+	std::string key;
+};
+
+// Least recently used results, up to a byte budget and a count of
+// entries, each of them holding a descriptor.
+class cache {
+public:
+	cache (size_t budget, size_t max_count) :
+		budget_(budget),
+		max_count_(max_count),
+		used_(0) {
+	}
+
+	std::shared_ptr<const result> find (const std::string &key) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = index_.find(key);
+		if (it == index_.end()) {
+			return nullptr;
+		}
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->second;
+	}
+
+	void insert (const std::string &key, std::shared_ptr<const result> res) {
+		const size_t size = key.size() + res->size;
+		if (size > budget_ || max_count_ == 0) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (index_.count(key) > 0) {
+			return;
+		}
+		entries_.emplace_front(key, std::move(res));
+		index_[key] = entries_.begin();
+		used_ += size;
+
+		while (used_ > budget_ || entries_.size() > max_count_) {
+			const entry &last = entries_.back();
+			used_ -= last.first.size() + last.second->size;
+			index_.erase(last.first);
+			entries_.pop_back();
+		}
+	}
+
+private:
+	using entry = std::pair<std::string, std::shared_ptr<const result>>;
+
+	const size_t budget_;
+	const size_t max_count_;
+	size_t used_;
+	std::list<entry> entries_;
+	std::unordered_map<std::string, std::list<entry>::iterator> index_;
+	std::mutex mutex_;
+};
+
+// Returns the count of results which may be cached without using more than
+// a quarter of the descriptors of the process.
+size_t cache_entry_count (size_t count) {
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+		count = std::min<size_t>(count, limit.rlim_cur/4);
+	}
+	return count;
+}
+
+void set_nonblocking (int fd) {
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+std::shared_ptr<codec::decoder> find_decoder (const utils::shared_memory &input) {
+	const codec::registry::entry *entry = codec::registry::instance().find_content(
+		input.data(), std::min(input.size(), codec::registry::sniff_size));
+
+	if (entry == nullptr || ! entry->shared_decoder) {
+		error::raise(error::DecoderNotFound);
+	}
+	return entry->shared_decoder;
+}
+
+const utils::shared_memory & input_of (const task &t) {
+	if (! t.input) {
+		error::raise_literal(error::IOError, "no sealed input received");
+	}
+	return *t.input;
+}
+
+sequence decode (const task &t) {
+	if (! t.request.input.empty()) {
+		return load_buffer(t.request.input);
+	}
+	const utils::shared_memory &input = input_of(t);
+	return find_decoder(input)->decode(input.data(), input.size());
+}
+
+void set_format (service::response &res, const format &format, format::size_type frame_count) {
+	res.channel_count = format.channel_count();
+	res.sample_rate = format.sample_rate();
+	res.frame_count = frame_count;
+}
+
+} // namespace server_
+
+struct server::impl {
+	impl (const std::string &socket_path, const settings &s) :
+		path(socket_path),
+		config(s),
+		listener(-1),
+		cache(s.cache_budget, server_::cache_entry_count(s.cache_entry_count)),
+		buffer(service::max_message_size),
+		pending(0),
+		stopping(false),
+		pool(s.thread_count) {
+		wake[0] = wake[1] = -1;
+	}
+
+	~impl () {
+		if (listener >= 0) {
+			::close(listener);
+			unlink(path.c_str());
+		}
+		if (wake[0] >= 0) {
+			::close(wake[0]);
+			::close(wake[1]);
+		}
+	}
+
+	void accept_ () {
+		for (;;) {
+			int fd = accept(listener, nullptr, nullptr);
+			if (fd < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EMFILE || errno == ENFILE
+						|| errno == ENOBUFS || errno == ENOMEM) {
+					// the listener stays readable, it is not polled until
+					// descriptors may have been released
+					accept_resume =
+						std::chrono::steady_clock::now() + server_::accept_backoff;
+				}
+				return;
+			}
+			fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+			// requests open files with the privileges of the server
+			if (! utils::peer_is_trusted(fd)) {
+				::close(fd);
+				continue;
+			}
+
+			struct timeval timeout;
+			timeout.tv_sec = server_::send_timeout;
+			timeout.tv_usec = 0;
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+			connections.push_back(std::make_shared<server_::connection>(fd));
+		}
+	}
+
+	// Returns false if the connection is to be dropped.
+	bool read_ (
+			const std::shared_ptr<server_::connection> &peer,
+			std::vector<server_::task> &tasks) {
+		int fd;
+		const ssize_t size =
+			utils::receive_message(peer->fd, buffer.data(), buffer.size(), fd);
+
+		if (size <= 0) {
+			return false;
+		}
+
+		server_::task t;
+		t.peer = peer;
+		t.size = 0;
+
+		if (fd >= 0) {
+			// refused areas are reported by the response
+			t.input = utils::shared_memory::adopt(fd);
+			t.size = t.input ? t.input->size() : 0;
+		}
+
+		if (! service::unpack(buffer.data(), size, t.request)) {
+			return false;
+		}
+
+		struct stat st;
+		if (! t.request.input.empty()
+				&& t.request.operation != service::Encode
+				&& stat(t.request.input.c_str(), &st) == 0) {
+			// the result of a file is shared until the file changes
+			t.size = st.st_size;
+			t.key = service::pack(t.request)
+				+ std::to_string(st.st_dev) + ":"
+				+ std::to_string(st.st_ino) + ":"
+				+ std::to_string(st.st_size) + ":"
+				+ std::to_string(st.st_mtime) + ":"
+				+ std::to_string(st.st_ctime);
+		}
+
+		tasks.push_back(std::move(t));
+		return true;
+	}
+
+	void dispatch_ (std::vector<server_::task> tasks) {
+		using group = std::vector<server_::task>;
+
+		// identical requests are run once
+		std::vector<group> groups;
+		std::map<std::string, size_t> identical;
+
+		for (server_::task &t : tasks) {
+			size_t index = groups.size();
+			if (! t.key.empty()) {
+				index = identical.emplace(t.key, index).first->second;
+			}
+			if (index == groups.size()) {
+				groups.emplace_back();
+			}
+			groups[index].push_back(std::move(t));
+		}
+
+		// small requests share a task, others have their own
+		auto batch = std::make_shared<std::vector<group>>();
+
+		for (group &g : groups) {
+			const server_::task &t = g.front();
+
+			if (t.request.operation == service::Probe
+					|| t.size < config.small_input_size) {
+				batch->push_back(std::move(g));
+				if (batch->size() >= config.batch_size) {
+					submit_(std::move(batch));
+					batch = std::make_shared<std::vector<group>>();
+				}
+			} else {
+				submit_(std::make_shared<std::vector<group>>(1, std::move(g)));
+			}
+		}
+
+		if (! batch->empty()) {
+			submit_(std::move(batch));
+		}
+	}
+
+	void submit_ (std::shared_ptr<std::vector<std::vector<server_::task>>> batch) {
+		pool.submit([this, batch] {
+			for (const std::vector<server_::task> &g : *batch) {
+				const std::shared_ptr<const server_::result> res = run_(g.front());
+				for (const server_::task &t : g) {
+					reply_(t, *res);
+				}
+				done_(g.size());
+			}
+		});
+	}
+
+	std::shared_ptr<const server_::result> run_ (const server_::task &t) {
+		if (! t.key.empty()) {
+			if (auto res = cache.find(t.key)) {
+				return res;
+			}
+		}
+
+		auto res = std::make_shared<server_::result>();
+		res->response = service::response{ 0, "", "", 0, 0, 0, 0 };
+		res->fd = -1;
+		res->size = 0;
+
+		try {
+			execute_(t, *res);
+		} catch (const error &err) {
+			res->response.status = err.status();
+			res->response.message = err.what();
+		} catch (const std::exception &err) {
+			res->response.status = error::CodecUnexpectedError;
+			res->response.message = err.what();
+		} catch (...) {
+			res->response.status = error::CodecUnexpectedError;
+			res->response.message = "unexpected error";
+		}
+
+		if (res->response.status == 0 && ! t.key.empty()) {
+			cache.insert(t.key, res);
+		}
+		return res;
+	}
+
+	void execute_ (const server_::task &t, server_::result &res) {
+		switch (t.request.operation) {
+		case service::Probe: {
+				codec::info info = t.request.input.empty()
+					? server_::find_decoder(server_::input_of(t))->probe(
+						t.input->data(), t.input->size())
+					: probe(t.request.input);
+				res.response.codec = info.codec;
+				res.response.bitrate = info.bitrate;
+				server_::set_format(res.response, info.format, info.frame_count);
+			}
+			break;
+
+		case service::Decode: {
+				// decoders can not write to shared memory, the
+				// decoded frames are copied there once
+				auto frames = std::make_shared<shared_sequence>(server_::decode(t));
+				frames->seal();
+				server_::set_format(res.response, frames->format(), frames->frame_count());
+				res.fd = frames->memory().descriptor();
+				res.size = frames->memory().size();
+				res.owner = std::move(frames);
+			}
+			break;
+
+		case service::Encode: {
+				const shared_sequence frames(t.input);
+				encode_(t.request, frames.copy(), res);
+			}
+			break;
+
+		case service::Transcode:
+			encode_(t.request, server_::decode(t), res);
+			break;
+		}
+	}
+
+	void encode_ (
+			const service::request &req,
+			const sequence &seq,
+			server_::result &res) {
+		std::ostringstream out;
+		coder_(req)->encode(out, seq);
+		const std::string bytes = out.str();
+
+		auto memory = std::make_shared<utils::shared_memory>(bytes.size());
+		if (! memory->is_open()) {
+			error::raise_literal(error::IOError, "failed to create shared memory");
+		}
+		if (! bytes.empty()) {
+			std::memcpy(memory->writable_data(), bytes.data(), bytes.size());
+		}
+		if (! memory->seal()) {
+			error::raise_literal(error::IOError, "failed to seal shared memory");
+		}
+
+		server_::set_format(res.response, seq.format(), seq.frame_count());
+		res.fd = memory->descriptor();
+		res.size = memory->size();
+		res.owner = std::move(memory);
+	}
+
+	// Coders are kept for each extension and settings, up to a count.
+	// Others are built for their request only.
+	std::shared_ptr<codec::coder> coder_ (const service::request &req) {
+		const std::string key = service::pack(service::request{
+			service::Encode, "", req.extension, req.options
+		});
+
+		std::lock_guard<std::mutex> lock(coders_mutex);
+		auto it = coders.find(key);
+		if (it != coders.end()) {
+			return it->second;
+		}
+
+		std::shared_ptr<codec::coder> coder = get_coder(req.extension, req.options);
+		if (coders.size() < server_::max_coder_count) {
+			coders.emplace(key, coder);
+		}
+		return coder;
+	}
+
+	void reply_ (const server_::task &t, const server_::result &res) {
+		const std::string message = service::pack(res.response);
+
+		if (! utils::send_message(t.peer->fd, message.data(), message.size(), res.fd)) {
+			// the server drops the connection on its hang up
+			shutdown(t.peer->fd, SHUT_RDWR);
+		}
+	}
+
+	void done_ (size_t count) {
+		if (pending.fetch_sub(count) >= config.max_pending) {
+			wake_();
+		}
+	}
+
+	void wake_ () noexcept {
+		const char byte = 0;
+		ssize_t status = write(wake[1], &byte, sizeof(byte));
+		(void)status;
+	}
+
+	const std::string path;
+	const settings config;
+	int listener;
+	int wake[2];
+	std::chrono::steady_clock::time_point accept_resume;
+	std::vector<std::shared_ptr<server_::connection>> connections;
+	server_::cache cache;
+	std::vector<char> buffer;
+	std::mutex coders_mutex;
+	std::map<std::string, std::shared_ptr<codec::coder>> coders;
+	std::atomic<size_t> pending;
+	std::atomic<bool> stopping;
+
+	// destroyed first, so that running tasks are done before the rest
+	utils::thread_pool pool;
+};
+
+server::server (const std::string &socket_path) :
+	server(socket_path, settings()) {
+}
+
+server::server (const std::string &socket_path, const settings &s) :
+	d_(new impl(socket_path, s)) {
+	// codecs are registered before requests look them up from the pool
+	codec::registry::instance();
+
+	if (pipe(d_->wake) != 0) {
+		d_->wake[0] = d_->wake[1] = -1;
+		error::raise_literal(error::IOError, "failed to create a pipe");
+	}
+	server_::set_nonblocking(d_->wake[0]);
+	server_::set_nonblocking(d_->wake[1]);
+
+	d_->listener = utils::listen_unix(socket_path, SOMAXCONN);
+	if (d_->listener < 0) {
+		error::raise(error::IOError, "failed to listen at " + socket_path);
+	}
+	server_::set_nonblocking(d_->listener);
+}
+
+server::~server () {
+}
+
+void server::run () {
+	std::vector<struct pollfd> fds;
+	std::vector<server_::task> tasks;
+
+	while (! d_->stopping) {
+		const size_t pending = d_->pending;
+		const size_t capacity =
+			pending < d_->config.max_pending ? d_->config.max_pending - pending : 0;
+		const short events = capacity > 0 ? POLLIN : 0;
+
+		// clients are not accepted while the server backs off
+		int timeout = -1;
+		short accept_events = events;
+		const auto now = std::chrono::steady_clock::now();
+		if (now < d_->accept_resume) {
+			accept_events = 0;
+			timeout = 1 + std::chrono::duration_cast<std::chrono::milliseconds>(
+				d_->accept_resume - now).count();
+		}
+
+		// without capacity, only hang ups are polled
+		fds.clear();
+		fds.push_back(pollfd{ d_->wake[0], POLLIN, 0 });
+		fds.push_back(pollfd{ d_->listener, accept_events, 0 });
+		for (const auto &peer : d_->connections) {
+			fds.push_back(pollfd{ peer->fd, events, 0 });
+		}
+
+		if (poll(fds.data(), fds.size(), timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			error::raise(error::IOError, std::string(std::strerror(errno)));
+		}
+
+		if (fds[0].revents != 0) {
+			char bytes[64];
+			while (read(d_->wake[0], bytes, sizeof(bytes)) > 0);
+		}
+
+		// a request is read from each ready client, the requests read at
+		// once make a batch
+		auto &connections = d_->connections;
+		size_t kept = 0;
+		for (size_t i = 0; i < connections.size(); ++i) {
+			const short revents = fds[i + 2].revents;
+			bool keep = (revents & (POLLHUP | POLLERR | POLLNVAL)) == 0;
+
+			if ((revents & POLLIN) != 0 && tasks.size() < capacity) {
+				keep = d_->read_(connections[i], tasks);
+			}
+			if (keep) {
+				connections[kept++] = std::move(connections[i]);
+			}
+		}
+		connections.resize(kept);
+
+		if ((fds[1].revents & POLLIN) != 0) {
+			d_->accept_();
+		}
+
+		if (! tasks.empty()) {
+			d_->pending += tasks.size();
+			d_->dispatch_(std::move(tasks));
+			tasks.clear();
+		}
+	}
+
+	d_->pool.wait();
+	d_->connections.clear();
+}
+
+void server::stop () noexcept {
+	d_->stopping = true;
+	d_->wake_();
+}
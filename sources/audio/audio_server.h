@@ -0,0 +1,95 @@
+/// audio_server.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_SERVER_H_
+#define AUDIO_SERVER_H_
+
+#include <audio/error>
+#include <audio/service>
+
+#include <utils/pimpl>
+
+#include <cstddef>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+/// class com::nealrame::audio::server
+/// ==================================
+/// Serves the requests of `client`s over a Unix socket, so that processes
+/// share the codecs and caches of a single long-running one. See
+/// `service` for the requests.
+///
+/// Requests read files with the privileges of the server: only processes
+/// of the same user, or of root, are served.
+///
+/// Requests received at once are run as a batch on a thread pool:
+/// identical requests of files are run once, and requests of small inputs
+/// are grouped on the same task. Codecs stay loaded, the threads of the
+/// pool keep their codec contexts, and the results of requests of files
+/// are cached until the files change.
+///
+/// No more requests are read while the count of pending ones reaches its
+/// limit. Clients then wait for their requests to be sent. No more clients
+/// are accepted for a while once the process runs out of descriptors.
+class server {
+public:
+	/// struct com::nealrame::audio::server::settings
+	/// =============================================
+	struct settings {
+		/// The count of threads. A count of 0 stands for the count of
+		/// hardware threads.
+		unsigned int thread_count = 0;
+
+		/// The maximum count of requests read and not yet answered.
+		size_t max_pending = 256;
+
+		/// The maximum count of small requests run by a task.
+		size_t batch_size = 16;
+
+		/// Size in bytes of the inputs below which a request is small.
+		size_t small_input_size = size_t(1) << 20;
+
+		/// The maximum size in bytes of the cached results.
+		size_t cache_budget = size_t(256) << 20;
+
+		/// The maximum count of cached results. Each of them keeps a
+		/// descriptor open, the count is also kept below a quarter of
+		/// the descriptors the process may open.
+		size_t cache_entry_count = 256;
+	};
+
+public:
+	/// Constructs a `server` listening at the given path, with default
+	/// settings.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the socket can not be created.
+	explicit server (const std::string &socket_path);
+
+	/// Same as above, with the given settings.
+	server (const std::string &socket_path, const settings &s);
+
+	server (const server &) = delete;
+	server & operator= (const server &) = delete;
+
+	/// Waits for the pending requests, then removes the socket.
+	~server ();
+
+public:
+	/// Serves requests until `stop` is called.
+	void run ();
+
+	/// Makes `run` return once the requests it read are answered. May be
+	/// called from any thread or from a signal handler.
+	void stop () noexcept;
+
+	PIMPL
+};
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_SERVER_H_ */
@@ -0,0 +1,174 @@
+/// audio_service.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "audio_service.h"
+
+#include "../utils/utils_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace com::nealrame::audio;
+
+namespace service_ {
+
+// Both ends run on the same machine: values are sent in its byte order.
+const uint32_t request_magic = 0x51524e41;  // "ANRQ"
+const uint32_t response_magic = 0x53524e41; // "ANRS"
+
+// Requests are not trusted: their settings are bounded so that a client
+// can neither choose the count of threads of the server nor make it keep
+// a coder for each quality.
+const uint32_t max_bitrate = 512;
+const float quality_steps = 100.f;
+
+class writer {
+public:
+	template <typename T>
+	void put (T value) {
+		data_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+	}
+
+	void put (const std::string &str) {
+		put(uint32_t(str.size()));
+		data_.append(str);
+	}
+
+	std::string & data () noexcept {
+		return data_;
+	}
+
+private:
+	std::string data_;
+};
+
+class reader {
+public:
+	reader (const void *data, size_t size) :
+		data_(static_cast<const char *>(data)),
+		size_(size) {
+	}
+
+	template <typename T>
+	bool get (T &value) {
+		if (size_ < sizeof(value)) {
+			return false;
+		}
+		std::memcpy(&value, data_, sizeof(value));
+		data_ += sizeof(value);
+		size_ -= sizeof(value);
+		return true;
+	}
+
+	bool get (std::string &str) {
+		uint32_t size;
+		if (! get(size) || size_ < size) {
+			return false;
+		}
+		str.assign(data_, size);
+		data_ += size;
+		size_ -= size;
+		return true;
+	}
+
+	bool done () const noexcept {
+		return size_ == 0;
+	}
+
+private:
+	const char *data_;
+	size_t size_;
+};
+
+} // namespace service_
+
+std::string
+service::pack (const request &req) {
+	service_::writer out;
+
+	out.put(service_::request_magic);
+	out.put(uint32_t(req.operation));
+	out.put(req.input);
+	out.put(req.extension);
+	out.put(uint32_t(req.options.bitrate_mode));
+	out.put(uint32_t(req.options.bitrate));
+	out.put(req.options.quality);
+	out.put(uint32_t(req.options.channel_mode));
+	out.put(uint32_t(req.options.fast));
+	out.put(uint32_t(req.options.thread_count));
+
+	return std::move(out.data());
+}
+
+std::string
+service::pack (const response &res) {
+	service_::writer out;
+
+	out.put(service_::response_magic);
+	out.put(res.status);
+	out.put(res.message);
+	out.put(res.codec);
+	out.put(res.channel_count);
+	out.put(res.sample_rate);
+	out.put(res.frame_count);
+	out.put(res.bitrate);
+
+	return std::move(out.data());
+}
+
+bool service::unpack (const void *data, size_t size, request &req) {
+	service_::reader in(data, size);
+	uint32_t magic, operation, bitrate_mode, bitrate, channel_mode, fast, thread_count;
+	float quality;
+
+	if (! (in.get(magic)
+			&& in.get(operation)
+			&& in.get(req.input)
+			&& in.get(req.extension)
+			&& in.get(bitrate_mode)
+			&& in.get(bitrate)
+			&& in.get(quality)
+			&& in.get(channel_mode)
+			&& in.get(fast)
+			&& in.get(thread_count)
+			&& in.done())
+			|| magic != service_::request_magic
+			|| operation < Probe || operation > Transcode
+			|| bitrate_mode > codec::encoder_options::VariableBitrate
+			|| channel_mode > codec::encoder_options::Stereo
+			|| ! std::isfinite(quality)) {
+		return false;
+	}
+
+	req.operation = static_cast<enum operation>(operation);
+	req.options.bitrate_mode =
+		static_cast<enum codec::encoder_options::bitrate_mode>(bitrate_mode);
+	req.options.bitrate = std::min(bitrate, service_::max_bitrate);
+	req.options.quality = std::round(
+		std::min(std::max(quality, 0.f), 1.f)*service_::quality_steps
+	)/service_::quality_steps;
+	req.options.channel_mode =
+		static_cast<enum codec::encoder_options::channel_mode>(channel_mode);
+	req.options.fast = fast != 0;
+	req.options.thread_count = std::min(thread_count, utils::thread_count(0));
+
+	return true;
+}
+
+bool service::unpack (const void *data, size_t size, response &res) {
+	service_::reader in(data, size);
+	uint32_t magic;
+
+	return in.get(magic)
+		&& magic == service_::response_magic
+		&& in.get(res.status)
+		&& in.get(res.message)
+		&& in.get(res.codec)
+		&& in.get(res.channel_count)
+		&& in.get(res.sample_rate)
+		&& in.get(res.frame_count)
+		&& in.get(res.bitrate)
+		&& in.done();
+}
@@ -0,0 +1,115 @@
+/// audio_service.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_SERVICE_H_
+#define AUDIO_SERVICE_H_
+
+#include <audio/format>
+#include <audio/codecs/encoder_options>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+/// namespace com::nealrame::audio::service
+/// =======================================
+/// Messages exchanged by a `client` and a `server` over a Unix socket of
+/// sequenced packets. A client sends a request and waits for its response.
+///
+/// Inputs and outputs are not copied in the messages: they are sealed
+/// `utils::shared_memory` areas whose descriptors are sent with them.
+/// Sequences are sent as `shared_sequence` areas, encoded streams as their
+/// bytes.
+namespace service {
+
+/// The operations of a request.
+enum operation : uint32_t {
+	/// Probes an encoded stream.
+	Probe = 1,
+
+	/// Decodes an encoded stream to a sequence.
+	Decode,
+
+	/// Encodes a sequence to a stream of the codec of `extension`.
+	Encode,
+
+	/// Decodes an encoded stream, then encodes it to a stream of the codec
+	/// of `extension`.
+	Transcode,
+};
+
+/// struct com::nealrame::audio::service::request
+/// =============================================
+struct request {
+	/// The operation to be done.
+	enum operation operation;
+
+	/// Path of the input file, to be read by the server. Empty if the
+	/// input is sent with the request.
+	std::string input;
+
+	/// Extension of the codec of the output, with its leading dot.
+	std::string extension;
+
+	/// Settings of the coder of the output.
+	codec::encoder_options options;
+};
+
+/// struct com::nealrame::audio::service::response
+/// ==============================================
+struct response {
+	/// Status of a failed request, see `error::status`. 0 on success.
+	uint32_t status;
+
+	/// Error message of a failed request.
+	std::string message;
+
+	/// Name of the codec of a probed stream.
+	std::string codec;
+
+	/// Count of channels of the input of a probe, or of the frames
+	/// decoded or encoded.
+	uint32_t channel_count;
+
+	/// Sample rate, as `channel_count`.
+	uint32_t sample_rate;
+
+	/// Count of frames, as `channel_count`.
+	uint64_t frame_count;
+
+	/// Average bitrate of a probed stream in bits per second.
+	uint32_t bitrate;
+};
+
+/// Maximum size of a message.
+const size_t max_message_size = 16384;
+
+/// Serializes the given request.
+std::string pack (const request &req);
+
+/// Serializes the given response.
+std::string pack (const response &res);
+
+/// Deserializes a request. Its settings are bounded: the bitrate to
+/// 512 kbit/s, the quality to hundredths in [0, 1] and the count of threads
+/// to the count of hardware threads.
+///
+/// *Returns:*
+/// `false` if the data are not a request.
+bool unpack (const void *data, size_t size, request &req);
+
+/// Deserializes a response.
+///
+/// *Returns:*
+/// `false` if the data are not a response.
+bool unpack (const void *data, size_t size, response &res);
+
+} /* namespace service */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_SERVICE_H_ */
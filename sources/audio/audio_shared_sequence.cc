@@ -0,0 +1,170 @@
+/// audio_shared_sequence.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "audio_shared_sequence.h"
+#include "audio_sequence.h"
+
+#include "../utils/utils_shared_memory.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+
+namespace shared_sequence_ {
+
+const char magic[8] = { 'N', 'R', 'A', 'U', 'D', 'I', 'O', '1' };
+
+// Header of a shared memory area, followed by the interleaved samples at
+// `data_offset` so that they stay aligned for vector loads.
+struct header {
+	char magic[8];
+	uint32_t channel_count;
+	uint32_t sample_rate;
+	uint64_t frame_count;
+};
+
+const size_t data_offset = 64;
+
+static_assert(sizeof(header) <= data_offset, "header overlaps samples");
+
+size_t frame_size (const format &format) {
+	return format.channel_count()*sizeof(float);
+}
+
+std::shared_ptr<utils::shared_memory> create (
+		const format &format,
+		format::size_type frame_count) {
+	auto memory = std::make_shared<utils::shared_memory>(
+		data_offset + frame_count*frame_size(format));
+
+	if (! memory->is_open()) {
+		error::raise_literal(error::IOError, "failed to create shared memory");
+	}
+
+	header h;
+	std::memcpy(h.magic, magic, sizeof(magic));
+	h.channel_count = format.channel_count();
+	h.sample_rate = format.sample_rate();
+	h.frame_count = frame_count;
+	std::memcpy(memory->writable_data(), &h, sizeof(h));
+
+	return memory;
+}
+
+// The area may come from an untrusted process, its header is checked
+// against its size before any frame is read. Sealed areas can not change
+// anymore, so their header is read in place.
+const header & header_of (const std::shared_ptr<utils::shared_memory> &memory) {
+	if (! memory || ! memory->is_sealed()) {
+		error::raise_literal(error::IOError, "shared sequence is not sealed");
+	}
+	if (memory->size() < data_offset) {
+		error::raise_literal(error::CodecFormatError, "malformed shared sequence");
+	}
+
+	const header &h = *static_cast<const header *>(memory->data());
+	if (std::memcmp(h.magic, magic, sizeof(magic)) != 0
+			|| h.channel_count == 0
+			|| h.frame_count > (memory->size() - data_offset)/(h.channel_count*sizeof(float))) {
+		error::raise_literal(error::CodecFormatError, "malformed shared sequence");
+	}
+	return h;
+}
+
+format format_of (const std::shared_ptr<utils::shared_memory> &memory) {
+	const header &h = header_of(memory);
+	return format(h.channel_count, h.sample_rate);
+}
+
+} // namespace shared_sequence_
+
+shared_sequence::shared_sequence (
+		std::shared_ptr<utils::shared_memory> memory,
+		const class format &format,
+		format::size_type frame_count) :
+	memory_(std::move(memory)),
+	format_(format),
+	frame_count_(frame_count) {
+}
+
+shared_sequence::shared_sequence (
+		const class format &format,
+		format::size_type frame_count) :
+	shared_sequence(
+		shared_sequence_::create(format, frame_count),
+		format,
+		frame_count) {
+}
+
+shared_sequence::shared_sequence (const sequence &seq) :
+	shared_sequence(seq.format(), seq.frame_count()) {
+	if (frame_count_ > 0) {
+		std::memcpy(writable_data(0), seq.data(0),
+			frame_count_*shared_sequence_::frame_size(format_));
+	}
+}
+
+shared_sequence::shared_sequence (std::shared_ptr<utils::shared_memory> memory) :
+	memory_(std::move(memory)),
+	format_(shared_sequence_::format_of(memory_)),
+	frame_count_(shared_sequence_::header_of(memory_).frame_count) {
+}
+
+shared_sequence
+shared_sequence::receive (int socket) {
+	std::shared_ptr<utils::shared_memory> memory =
+		utils::shared_memory::receive(socket);
+
+	if (! memory) {
+		error::raise_literal(error::IOError, "no sealed shared sequence received");
+	}
+	return shared_sequence(std::move(memory));
+}
+
+bool shared_sequence::is_sealed () const noexcept {
+	return memory_->is_sealed();
+}
+
+const float * shared_sequence::data (format::size_type index) const noexcept {
+	const char *base = static_cast<const char *>(memory_->data());
+	return reinterpret_cast<const float *>(base + shared_sequence_::data_offset)
+		+ index*format_.channel_count();
+}
+
+float * shared_sequence::writable_data (format::size_type index) noexcept {
+	char *base = static_cast<char *>(memory_->writable_data());
+	if (base == nullptr) {
+		return nullptr;
+	}
+	return reinterpret_cast<float *>(base + shared_sequence_::data_offset)
+		+ index*format_.channel_count();
+}
+
+sequence
+shared_sequence::copy () const {
+	sequence seq(format_);
+
+	if (frame_count_ > 0) {
+		seq.set_frame_count(frame_count_);
+		std::memcpy(seq.data(0), data(0),
+			frame_count_*shared_sequence_::frame_size(format_));
+	}
+
+	return seq;
+}
+
+void shared_sequence::seal () {
+	if (! memory_->seal()) {
+		error::raise_literal(error::IOError, "failed to seal shared sequence");
+	}
+}
+
+void shared_sequence::send (int socket) {
+	seal();
+	if (! memory_->send(socket)) {
+		error::raise_literal(error::IOError, "failed to send shared sequence");
+	}
+}
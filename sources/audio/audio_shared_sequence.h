@@ -0,0 +1,134 @@
+/// audio_shared_sequence.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_SHARED_SEQUENCE_H_
+#define AUDIO_SHARED_SEQUENCE_H_
+
+#include <audio/error>
+#include <audio/format>
+
+#include <memory>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+class shared_memory;
+} /* namespace utils */
+namespace audio {
+class sequence;
+/// class com::nealrame::audio::shared_sequence
+/// ===========================================
+/// Interleaved frames in memory shared between processes. A process
+/// creates and writes the frames, then sends them over a Unix socket to
+/// another process which maps them without copying them.
+///
+/// Sending seals the frames: from then on, neither the sender nor the
+/// receiver can modify them. A receiver refuses frames which are not
+/// sealed, so that a sender can not change them while they are read.
+///
+/// Copies of a `shared_sequence` share the same frames, which stay
+/// valid as long as one of them exists.
+class shared_sequence {
+public:
+	/// Constructs a writable `shared_sequence`. Frames are left
+	/// un-initialized.
+	///
+	/// *Parameters:*
+	/// - `format`
+	///   The format of the frames.
+	/// - `frame_count`
+	///   The count of frames.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the shared memory can not be created.
+	shared_sequence (const class format &format, format::size_type frame_count);
+
+	/// Constructs a writable `shared_sequence` holding a copy of the
+	/// frames of the given `sequence`.
+	///
+	/// Decoders write to the storage of a `sequence`, which can not be
+	/// shared: a decoded sequence is copied once to shared memory, and
+	/// both are held meanwhile. To avoid the copy, write the frames with
+	/// `writable_data` when their count is known beforehand.
+	explicit shared_sequence (const sequence &seq);
+
+	/// Constructs a `shared_sequence` of the frames of the given sealed
+	/// area, as received with `utils::receive_message`.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the area is null or not sealed, or
+	///   `CodecFormatError` if its frames are malformed.
+	explicit shared_sequence (std::shared_ptr<utils::shared_memory> memory);
+
+public:
+	/// Receives frames sent by `send` over the given Unix socket. The
+	/// frames are mapped read-only.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if no sealed frames were received, or
+	///   `CodecFormatError` if they are malformed.
+	static shared_sequence receive (int socket);
+
+public:
+	/// Returns the format of the frames.
+	const class format & format () const noexcept
+	{ return format_; }
+
+	/// Returns the count of frames.
+	format::size_type frame_count () const noexcept
+	{ return frame_count_; }
+
+	/// Returns `true` once the frames can not be modified anymore.
+	bool is_sealed () const noexcept;
+
+	/// Returns the area of the frames, whose descriptor may be sent with
+	/// `utils::send_message` once sealed.
+	const utils::shared_memory & memory () const noexcept
+	{ return *memory_; }
+
+	/// Returns the interleaved samples starting at the given frame.
+	const float * data (format::size_type index) const noexcept;
+
+	/// Returns the interleaved samples starting at the given frame to be
+	/// written, or null once the frames are sealed.
+	float * writable_data (format::size_type index) noexcept;
+
+	/// Copies the frames to a `sequence`.
+	sequence copy () const;
+
+public:
+	/// Seals the frames. Pointers previously returned by `data` or
+	/// `writable_data` are not valid anymore.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the frames can not be sealed.
+	void seal ();
+
+	/// Seals the frames if they are not, then sends them over the given
+	/// Unix socket. Only a descriptor is sent, frames are not copied.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the frames can not be sent.
+	void send (int socket);
+
+private:
+	shared_sequence (
+		std::shared_ptr<utils::shared_memory> memory,
+		const class format &format,
+		format::size_type frame_count);
+
+private:
+	std::shared_ptr<utils::shared_memory> memory_;
+	class format format_;
+	format::size_type frame_count_;
+};
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_SHARED_SEQUENCE_H_ */
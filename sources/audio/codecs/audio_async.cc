@@ -0,0 +1,26 @@
+/// audio_async.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_async.h"
+
+#include "../../utils/utils_thread_pool.h"
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+
+codec::cancellation::cancellation () :
+	cancelled_(std::make_shared<std::atomic<bool>>(false)) {
+}
+
+void codec::cancellation::raise_if_cancelled () const {
+	if (is_cancelled()) {
+		error::raise_literal(error::OperationCancelled, "operation cancelled");
+	}
+}
+
+void codec::execute (std::function<void ()> task) {
+	static utils::thread_pool pool(0);
+	pool.submit(std::move(task));
+}
@@ -0,0 +1,132 @@
+/// audio_async.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_ASYNC_H_
+#define AUDIO_ASYNC_H_
+
+#include <audio/error>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// class com::nealrame::audio::codec::cancellation
+/// ===============================================
+/// Cancels asynchronous operations. Copies of a `cancellation` share their
+/// state, cancelling one cancels all the operations given any of them.
+///
+/// Operations check their cancellation before they start, then decodes
+/// and encodes check it between the chunks they read or write. See
+/// `decoder::decode_async` and `coder::encode_async`.
+class cancellation {
+public:
+	/// Constructs a `cancellation` which is not cancelled.
+	cancellation ();
+
+public:
+	/// Cancels the operations not done yet.
+	void cancel () const noexcept
+	{ cancelled_->store(true); }
+
+	/// Returns `true` if `cancel` has been called.
+	bool is_cancelled () const noexcept
+	{ return cancelled_->load(); }
+
+	/// Raises an error if `cancel` has been called.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `OperationCancelled`.
+	void raise_if_cancelled () const;
+
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+/// Runs the given task on the threads shared by the asynchronous
+/// operations of the codecs. There are as many threads as hardware
+/// threads.
+///
+/// *Parameters:*
+/// - `task`
+///   The task to be run. It must not throw.
+void execute (std::function<void ()> task);
+
+namespace async_ {
+template <typename T>
+void fulfill (std::promise<T> &promise, const std::function<T ()> &function) {
+	promise.set_value(function());
+}
+
+inline void fulfill (
+		std::promise<void> &promise,
+		const std::function<void ()> &function) {
+	function();
+	promise.set_value();
+}
+
+template <typename T>
+void run (
+		std::promise<T> &promise,
+		const cancellation &cancel,
+		const std::function<T ()> &function) noexcept {
+	try {
+		cancel.raise_if_cancelled();
+		fulfill(promise, function);
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+	}
+}
+} /* namespace async_ */
+
+/// Calls the given function on the threads of `execute`, unless the
+/// operation is cancelled before it starts.
+///
+/// *Parameters:*
+/// - `cancel`
+///   Cancels the operation.
+/// - `function`
+///   The function to be called.
+///
+/// *Returns:*
+/// The future of the result of the function. It holds an `error` with
+/// status `OperationCancelled` if the operation has been cancelled.
+template <typename T>
+std::future<T> execute (
+		const cancellation &cancel,
+		std::function<T ()> function) {
+	auto promise = std::make_shared<std::promise<T>>();
+	std::future<T> future = promise->get_future();
+
+	execute([promise, cancel, function] {
+		async_::run(*promise, cancel, function);
+	});
+
+	return future;
+}
+
+/// Same as above, but gives the ready future of the result to `on_done`
+/// from the thread which called the function. `on_done` must not throw.
+template <typename T>
+void execute (
+		const cancellation &cancel,
+		std::function<T ()> function,
+		std::function<void (std::future<T>)> on_done) {
+	execute([cancel, function, on_done] {
+		std::promise<T> promise;
+		async_::run(promise, cancel, function);
+		on_done(promise.get_future());
+	});
+}
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_ASYNC_H_ */
@@ -0,0 +1,86 @@
+/// audio_backend.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_BACKEND_H_
+#define AUDIO_BACKEND_H_
+
+#include <audio/error>
+#include <utils/shared_library>
+
+#include <atomic>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// class com::nealrame::audio::codec::backend
+/// ==========================================
+/// Shared library implementing a codec (libmpg123, libmp3lame, ...). It is
+/// only loaded when a coder or a decoder needs it, so that processes which
+/// do not use a codec neither load nor require its library.
+class backend : public utils::shared_library {
+public:
+	template <typename F> class function;
+
+public:
+	using utils::shared_library::shared_library;
+
+public:
+	/// Loads the library.
+	///
+	/// *Parameters:*
+	/// - `status`
+	///   The status of the error raised if the library can not be loaded,
+	///   `CoderNotFound` or `DecoderNotFound`.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	void require (enum error::status status) const {
+		if (! load()) {
+			error::raise(status, "failed to load " + names());
+		}
+	}
+};
+
+/// class com::nealrame::audio::codec::backend::function
+/// ====================================================
+/// Function of a `backend`, resolved on its first call.
+template <typename R, typename... Args>
+class backend::function<R (*) (Args...)> {
+public:
+	function (const backend &library, const char *name) :
+		library_(library),
+		name_(name),
+		function_(nullptr) {
+	}
+
+	function (const function &) = delete;
+	function & operator= (const function &) = delete;
+
+	R operator() (Args... args) const {
+		R (*f) (Args...) = function_.load(std::memory_order_acquire);
+
+		if (f == nullptr) {
+			f = reinterpret_cast<R (*) (Args...)>(library_.symbol(name_));
+			if (f == nullptr) {
+				error::raise(error::CodecUnexpectedError,
+						std::string("missing codec function ") + name_);
+			}
+			function_.store(f, std::memory_order_release);
+		}
+
+		return f(args...);
+	}
+
+private:
+	const backend &library_;
+	const char *name_;
+	mutable std::atomic<R (*) (Args...)> function_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_BACKEND_H_ */
@@ -0,0 +1,396 @@
+/// audio_cache.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_cache.h"
+#include "audio_raw_coder.h"
+#include "audio_registry.h"
+
+#include "../audio_sequence.h"
+
+#include "../../utils/utils_mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+using com::nealrame::audio::codec::cache;
+
+namespace cache_ {
+
+const std::string entry_extension = ".f32";
+
+// Age in seconds from which temporary files and sidecars without frames are
+// considered left over and removed.
+const time_t stale_delay = 3600;
+
+// 64 bits hash of the content of the files, read 8 bytes at a time on four
+// independent lanes.
+uint64_t hash (const unsigned char *data, size_t size) noexcept {
+	const uint64_t prime1 = 0x9e3779b185ebca87ULL;
+	const uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+	const auto mix = [=](uint64_t acc, uint64_t value) {
+		acc += value*prime2;
+		acc = (acc << 31) | (acc >> 33);
+		return acc*prime1;
+	};
+	const auto word = [](const unsigned char *bytes) {
+		uint64_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	};
+
+	uint64_t lanes[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+	size_t i = 0;
+
+	for (; i + 32 <= size; i += 32) {
+		for (int lane = 0; lane < 4; ++lane) {
+			lanes[lane] = mix(lanes[lane], word(data + i + 8*lane));
+		}
+	}
+
+	uint64_t h = size;
+	for (int lane = 0; lane < 4; ++lane) {
+		h = mix(h, lanes[lane]);
+	}
+	for (; i + 8 <= size; i += 8) {
+		h = mix(h, word(data + i));
+	}
+	for (; i < size; ++i) {
+		h = mix(h, data[i]);
+	}
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	return h;
+}
+
+// Returns the nanoseconds of the modification time of a file.
+long mtime_nsec (const struct stat &st) noexcept {
+#if defined(__APPLE__)
+	return st.st_mtimespec.tv_nsec;
+#else
+	return st.st_mtim.tv_nsec;
+#endif
+}
+
+// Identity of a version of a file: writing to a file changes its
+// modification time.
+struct file_id {
+	dev_t device;
+	ino_t inode;
+	off_t size;
+	time_t mtime;
+	long nsec;
+
+	explicit file_id (const struct stat &st) :
+		device(st.st_dev),
+		inode(st.st_ino),
+		size(st.st_size),
+		mtime(st.st_mtime),
+		nsec(mtime_nsec(st)) {
+	}
+
+	bool operator< (const file_id &rhs) const noexcept {
+		return std::tie(device, inode, size, mtime, nsec)
+			< std::tie(rhs.device, rhs.inode, rhs.size, rhs.mtime, rhs.nsec);
+	}
+};
+
+// Hashes of the files already looked up by this process, so that hits do
+// not read the whole files again. Forgotten once they are too many.
+class hash_memo {
+public:
+	bool find (const file_id &id, uint64_t &h) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = hashes_.find(id);
+		if (it == hashes_.end()) {
+			return false;
+		}
+		h = it->second;
+		return true;
+	}
+
+	void insert (const file_id &id, uint64_t h) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (hashes_.size() >= max_size) {
+			hashes_.clear();
+		}
+		hashes_[id] = h;
+	}
+
+	static hash_memo & instance () {
+		static hash_memo memo;
+		return memo;
+	}
+
+private:
+	static const size_t max_size = 4096;
+
+	mutable std::mutex mutex_;
+	std::map<file_id, uint64_t> hashes_;
+};
+
+// Returns the hash of the content of the given file.
+uint64_t file_hash (const std::string &filepath, uint64_t &size) {
+	struct stat st;
+
+	if (stat(filepath.c_str(), &st) != 0) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	const file_id id(st);
+	uint64_t h;
+
+	size = st.st_size;
+	if (hash_memo::instance().find(id, h)) {
+		return h;
+	}
+
+	const utils::mapped_file file(filepath);
+
+	if (! file.is_open()) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	h = hash(static_cast<const unsigned char *>(file.data()), file.size());
+
+	// the file changed since it was looked at
+	if (file.size() != size) {
+		size = file.size();
+		return h;
+	}
+
+	hash_memo::instance().insert(id, h);
+	return h;
+}
+
+struct lookup {
+	const codec::registry::entry *codec;
+	std::string path;
+};
+
+// Finds the decoder of the given file and the path of its cache entry,
+// named after its content, its size and the version of its decoder.
+lookup find (const std::string &directory, const std::string &filepath) {
+	const codec::registry::entry *entry =
+		codec::registry::instance().find_file(filepath);
+
+	if (entry == nullptr || ! entry->shared_decoder) {
+		throw error(error::DecoderNotFound);
+	}
+
+	uint64_t size;
+	const uint64_t h = file_hash(filepath, size);
+
+	char key[34];
+	std::snprintf(key, sizeof(key), "%016llx-%llx",
+		static_cast<unsigned long long>(h),
+		static_cast<unsigned long long>(size));
+
+	return lookup{
+		entry,
+		directory + "/" + key + "-" + entry->name
+			+ "-" + std::to_string(entry->version) + entry_extension
+	};
+}
+
+// Marks the entry as recently used.
+void touch (const std::string &path) noexcept {
+	utimes(path.c_str(), nullptr);
+}
+
+// Writes the entry to temporary files then renames them, so that other
+// readers see either no entry or a complete one. The sidecar is renamed
+// first since readers look for the frames.
+bool store (const std::string &path, const sequence &seq) noexcept {
+	static std::atomic<unsigned int> counter(0);
+
+	const std::string tmp_path = path + ".tmp."
+		+ std::to_string(getpid()) + "." + std::to_string(counter++);
+
+	try {
+		codec::RAW_coder().encode(tmp_path, seq);
+	} catch (...) {
+		std::remove(tmp_path.c_str());
+		std::remove(codec::raw_format::sidecar_path(tmp_path).c_str());
+		return false;
+	}
+
+	if (std::rename(
+			codec::raw_format::sidecar_path(tmp_path).c_str(),
+			codec::raw_format::sidecar_path(path).c_str()) != 0
+		|| std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+		std::remove(tmp_path.c_str());
+		std::remove(codec::raw_format::sidecar_path(tmp_path).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool ends_with (const std::string &s, const std::string &suffix) noexcept {
+	return s.size() >= suffix.size()
+		&& s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace cache_
+
+cache::cache (const std::string &directory, uint64_t byte_budget) :
+	directory_(directory),
+	byte_budget_(byte_budget) {
+	if (mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+		error::raise(error::IOError, "failed to create " + directory_);
+	}
+}
+
+sequence
+cache::load (const std::string &filepath) const {
+	const cache_::lookup lookup = cache_::find(directory_, filepath);
+
+	try {
+		RAW_decoder::mapping mapping = RAW_decoder().map(lookup.path);
+		cache_::touch(lookup.path);
+		return mapping.copy();
+	} catch (const error &) {
+		// not cached, or evicted while being read
+	}
+
+	sequence seq = lookup.codec->shared_decoder->decode(filepath);
+
+	if (cache_::store(lookup.path, seq)) {
+		trim();
+	}
+
+	return seq;
+}
+
+codec::RAW_decoder::mapping
+cache::map (const std::string &filepath) const {
+	const cache_::lookup lookup = cache_::find(directory_, filepath);
+
+	try {
+		RAW_decoder::mapping mapping = RAW_decoder().map(lookup.path);
+		cache_::touch(lookup.path);
+		return mapping;
+	} catch (const error &) {
+		// not cached, or evicted while being read
+	}
+
+	if (! cache_::store(lookup.path,
+			lookup.codec->shared_decoder->decode(filepath))) {
+		error::raise(error::IOError, "failed to write " + lookup.path);
+	}
+
+	// mapped before trimming so that the entry can not be evicted first
+	RAW_decoder::mapping mapping = RAW_decoder().map(lookup.path);
+	trim();
+	return mapping;
+}
+
+void
+cache::trim () const noexcept {
+	struct entry {
+		std::string path;
+		uint64_t size;
+		time_t last_use;
+	};
+
+	// trimming is best effort, the cache is left as is when memory runs
+	// out
+	try {
+		std::unique_ptr<DIR, int (*)(DIR *)> dir(
+			opendir(directory_.c_str()), &closedir);
+
+		if (! dir) {
+			return;
+		}
+
+		const time_t now = time(nullptr);
+		std::vector<entry> entries;
+		std::vector<std::string> sidecars;
+		uint64_t total = 0;
+
+		while (struct dirent *dirent = readdir(dir.get())) {
+			const std::string name(dirent->d_name);
+			const std::string path = directory_ + "/" + name;
+			const bool is_temporary = name.find(".tmp.") != std::string::npos;
+			const bool is_sidecar =
+				cache_::ends_with(name, cache_::entry_extension + ".format");
+
+			if (! is_temporary && ! is_sidecar
+				&& ! cache_::ends_with(name, cache_::entry_extension)) {
+				continue;
+			}
+
+			struct stat st;
+			if (stat(path.c_str(), &st) != 0) {
+				continue;
+			}
+
+			// temporary files left by writers which died, those of
+			// running writers are recent
+			if (is_temporary) {
+				if (now - st.st_mtime > cache_::stale_delay) {
+					std::remove(path.c_str());
+				}
+			} else if (is_sidecar) {
+				if (now - st.st_mtime > cache_::stale_delay) {
+					sidecars.push_back(path);
+				}
+			} else {
+				entries.push_back(entry{ path, uint64_t(st.st_size), st.st_mtime });
+				total += st.st_size;
+			}
+		}
+		dir.reset();
+
+		// sidecars whose frames were removed by a trim which failed
+		// in between
+		for (const std::string &sidecar: sidecars) {
+			const std::string path =
+				sidecar.substr(0, sidecar.size() - std::strlen(".format"));
+			if (access(path.c_str(), F_OK) != 0 && errno == ENOENT) {
+				std::remove(sidecar.c_str());
+			}
+		}
+
+		if (total <= byte_budget_) {
+			return;
+		}
+
+		std::sort(entries.begin(), entries.end(),
+			[](const entry &lhs, const entry &rhs) {
+				return lhs.last_use < rhs.last_use;
+			});
+
+		// readers which already mapped an entry keep their frames,
+		// unlinking only removes the name
+		for (const entry &e: entries) {
+			if (total <= byte_budget_) {
+				break;
+			}
+			std::remove(e.path.c_str());
+			std::remove(codec::raw_format::sidecar_path(e.path).c_str());
+			total -= e.size;
+		}
+	} catch (...) {
+	}
+}
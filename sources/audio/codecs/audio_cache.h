@@ -0,0 +1,95 @@
+/// audio_cache.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_CACHE_H_
+#define AUDIO_CACHE_H_
+
+#include <audio/error>
+#include <audio/codecs/raw_decoder>
+
+#include <cstdint>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+class sequence;
+namespace codec {
+/// class com::nealrame::audio::codec::cache
+/// ========================================
+/// A directory of decoded sequences. Files are decoded once by the codec
+/// found by the `registry`, then their frames are read from the cache as
+/// long as neither their content nor the version of their decoder changes.
+/// Entries are named after the hash and the size of the content of the
+/// files. A process hashes a file again only when its inode, its size or
+/// its modification time changes.
+///
+/// Decoded sequences are stored as `Float32` raw PCM files and are mapped
+/// in memory on reads. Least recently used ones are removed when the
+/// cache grows beyond its byte budget.
+///
+/// Several threads or processes can share a cache directory: entries are
+/// written to temporary files then renamed.
+class cache {
+public:
+	/// Opens the cache in the given directory. The directory is created if
+	/// it does not exist.
+	///
+	/// *Parameters:*
+	/// - `directory`
+	///   Path of the cache directory.
+	/// - `byte_budget`
+	///   Maximum size in bytes of the cached sequences.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `IOError` if the directory can not be created.
+	cache (const std::string &directory, uint64_t byte_budget);
+
+public:
+	/// Returns the path of the cache directory.
+	const std::string & directory () const noexcept
+	{ return directory_; }
+
+	/// Returns the maximum size in bytes of the cached sequences.
+	uint64_t byte_budget () const noexcept
+	{ return byte_budget_; }
+
+public:
+	/// Returns the decoded frames of the given file, decoding it if they
+	/// are not in the cache.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   With status `DecoderNotFound` if no registered codec handles the
+	///   file, or any error of its decoder.
+	sequence load (const std::string &filepath) const;
+
+	/// Same as `load`, but returns the cached frames mapped in memory
+	/// instead of a copy of them.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	///   Same as `load`, or with status `IOError` if the decoded frames
+	///   can not be written to the cache.
+	RAW_decoder::mapping map (const std::string &filepath) const;
+
+	/// Removes the least recently used sequences until the size of the
+	/// cache fits in its byte budget. Temporary files and sidecars left
+	/// over by writers which died are removed as well, once they are an
+	/// hour old.
+	///
+	/// Trimming is best effort: errors, including memory exhaustion,
+	/// leave the cache as is.
+	void trim () const noexcept;
+
+private:
+	std::string directory_;
+	uint64_t byte_budget_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_CACHE_H_ */
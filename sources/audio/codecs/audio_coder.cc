@@ -4,19 +4,144 @@
 ///     Author: [NealRame](mailto:contact@nealrame.com)
 #include "audio_coder.h"
 
+#include <cstdio>
 #include <fstream>
+#include <streambuf>
+#include <vector>
 
 using namespace com::nealrame::audio;
 using com::nealrame::audio::codec::coder;
 
-void coder::encode (const std::string &filename, const sequence &seq)
-	const throw(error) {
-	std::ofstream out(filename.data(), std::ofstream::binary);
-	encode_(out, seq);
+namespace coder_ {
+
+// Cancellation of the asynchronous encode run by the current thread, if
+// any.
+thread_local const codec::cancellation *current_cancellation = nullptr;
+
+// Buffers the bytes written to another buffer and checks the given
+// cancellation each time it passes them on.
+class cancellable_buffer : public std::streambuf {
+public:
+	cancellable_buffer (std::streambuf &target, const codec::cancellation &cancel) :
+		target_(target),
+		cancel_(cancel),
+		buffer_(1 << 16) {
+		setp(buffer_.data(), buffer_.data() + buffer_.size());
+	}
+
+protected:
+	virtual int_type overflow (int_type c) {
+		if (flush_() != 0) {
+			return traits_type::eof();
+		}
+		if (! traits_type::eq_int_type(c, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	virtual int sync () {
+		return flush_() == 0 && target_.pubsync() == 0 ? 0 : -1;
+	}
+
+private:
+	int flush_ () {
+		cancel_.raise_if_cancelled();
+
+		const std::streamsize size = pptr() - pbase();
+		if (target_.sputn(pbase(), size) != size) {
+			return -1;
+		}
+		setp(buffer_.data(), buffer_.data() + buffer_.size());
+		return 0;
+	}
+
+private:
+	std::streambuf &target_;
+	const codec::cancellation &cancel_;
+	std::vector<char> buffer_;
+};
+
+// Encodes the given sequence to the given file, checking the given
+// cancellation each time encoded bytes are written. The partial file of a
+// cancelled encode is removed.
+void encode (
+		const coder &coder,
+		const std::string &filename,
+		const sequence &seq,
+		const codec::cancellation &cancel) {
+	current_cancellation = &cancel;
+	try {
+		coder.encode(filename, seq);
+	} catch (...) {
+		current_cancellation = nullptr;
+		if (cancel.is_cancelled()) {
+			std::remove(filename.c_str());
+		}
+		throw;
+	}
+	current_cancellation = nullptr;
+}
+
+} // namespace coder_
+
+void coder::encode (const std::string &filename, const sequence &seq) const {
+	encode_file_(filename, seq);
 }
 
-void coder::encode (std::ostream &stream, const sequence &seq) 
-	const throw(error) {
+void coder::encode (std::ostream &stream, const sequence &seq) const {
 	std::ostream out(stream.rdbuf());
 	return encode_(out, seq);
 }
+
+void coder::encode (
+		const std::string &filename,
+		const sequence &seq,
+		std::error_code &ec) const noexcept {
+	ec = error::capture([&] {
+		encode_file_(filename, seq);
+	});
+}
+
+void coder::encode_file_ (const std::string &filename, const sequence &seq)
+	const {
+	std::ofstream out(filename.data(), std::ofstream::binary);
+
+	if (! out) {
+		error::raise(error::IOError, "failed to open " + filename);
+	}
+
+	if (coder_::current_cancellation == nullptr) {
+		encode_(out, seq);
+		return;
+	}
+
+	// a cancellation raised while writing is rethrown by the stream,
+	// which then ignores the writes left
+	coder_::cancellable_buffer buffer(*out.rdbuf(), *coder_::current_cancellation);
+	std::ostream cancellable_out(&buffer);
+
+	cancellable_out.exceptions(std::ostream::badbit);
+	encode_(cancellable_out, seq);
+	cancellable_out.flush();
+}
+
+std::future<void> coder::encode_async (
+		const std::string &filename,
+		std::shared_ptr<const sequence> seq,
+		const cancellation &cancel) const {
+	return execute<void>(cancel, [this, filename, seq, cancel] {
+		coder_::encode(*this, filename, *seq, cancel);
+	});
+}
+
+void coder::encode_async (
+		const std::string &filename,
+		std::shared_ptr<const sequence> seq,
+		std::function<void (std::future<void>)> on_done,
+		const cancellation &cancel) const {
+	execute<void>(cancel, [this, filename, seq, cancel] {
+		coder_::encode(*this, filename, *seq, cancel);
+	}, std::move(on_done));
+}
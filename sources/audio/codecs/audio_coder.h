@@ -5,10 +5,14 @@
 #ifndef AUDIO_CODER_H_
 #define AUDIO_CODER_H_
 
+#include <functional>
+#include <future>
+#include <memory>
 #include <ostream>
 #include <string>
 
 #include <audio/error>
+#include <audio/codecs/async>
 
 namespace com {
 namespace nealrame {
@@ -19,17 +23,61 @@ class coder {
 public:
 	/// Encode the given sequence to the given filename.
 	/// See `sequence` documentation for more details about `sequence`.
-	virtual void encode (const std::string &, const sequence &) const
-		throw(error) final;
+	virtual void encode (const std::string &, const sequence &) const final;
 	
 	/// Encode the given sequence to the given output stream.
 	/// See `sequence` documentation for more details about `sequence`.
-	virtual void encode (std::ostream &, const sequence &) const
-		throw(error) final;
+	virtual void encode (std::ostream &, const sequence &) const final;
+
+	/// Same as above, for the given file, but failures are reported
+	/// through `ec` instead of an exception. `ec` is cleared on success,
+	/// see `error::capture`. Coders still throw on failure, the exception
+	/// is caught here.
+	void encode (
+			const std::string &filepath,
+			const sequence &seq,
+			std::error_code &ec) const noexcept;
+
+	/// Encodes the given sequence to the given file on the threads of
+	/// `codec::execute`. The coder must outlive the operation.
+	///
+	/// The cancellation is checked each time a chunk of encoded bytes is
+	/// written to the file, the file of a cancelled operation is removed.
+	/// Coders which encode segments concurrently write them once they
+	/// are all encoded.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be encoded.
+	/// - `seq`
+	///   The sequence to be encoded. It is shared with the caller until
+	///   the operation is done and must not be modified meanwhile.
+	/// - `cancel`
+	///   Cancels the operation.
+	///
+	/// *Returns:*
+	/// A future set once the file is written.
+	std::future<void> encode_async (
+			const std::string &filepath,
+			std::shared_ptr<const sequence> seq,
+			const cancellation &cancel = cancellation()) const;
+
+	/// Same as above, but gives the ready future to `on_done` from the
+	/// thread which encoded the sequence.
+	void encode_async (
+			const std::string &filepath,
+			std::shared_ptr<const sequence> seq,
+			std::function<void (std::future<void>)> on_done,
+			const cancellation &cancel = cancellation()) const;
 
 protected:
-	virtual void encode_ (std::ostream &, const sequence &) const 
-		throw(error) = 0;
+	virtual void encode_ (std::ostream &, const sequence &) const = 0;
+
+	/// Default implementation encodes the sequence through a file
+	/// stream. Codecs which write files by themselves should override
+	/// it.
+	virtual void encode_file_ (const std::string &filepath, const sequence &)
+		const;
 };
 } /* namespace codec */
 } /* namespace audio */
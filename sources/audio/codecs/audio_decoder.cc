@@ -3,19 +3,272 @@
 /// Created on: April 19, 2014
 ///     Author: [NealRame](mailto:contact@nealrame.com)
 
+#include <algorithm>
 #include <fstream>
 
 #include "audio_decoder.h"
 #include "../audio_sequence.h"
 
+#include "../../utils/utils_byte_source.h"
+
+using namespace com::nealrame;
 using namespace com::nealrame::audio;
 
-sequence codec::decoder::decode (const std::string &filename) const throw(error) {
+namespace decoder_ {
+
+// Reads the frames of an already decoded sequence.
+class sequence_reader : public codec::reader {
+public:
+	explicit sequence_reader (sequence &&seq) :
+		seq_(std::move(seq)),
+		offset_(0) {
+	}
+
+	virtual const class format & format () const noexcept {
+		return seq_.format();
+	}
+
+	virtual format::size_type read (sequence &seq, format::size_type frame_count) {
+		frame_count = std::min(frame_count, seq_.frame_count() - offset_);
+		if (frame_count > 0) {
+			seq.append(seq_.data(offset_), frame_count);
+			offset_ += frame_count;
+		}
+		return frame_count;
+	}
+
+	// Returns the decoded sequence, which must not have been read.
+	sequence release () {
+		return std::move(seq_);
+	}
+
+private:
+	sequence seq_;
+	format::size_type offset_;
+};
+
+// Count of frames decoded between two checks of the cancellation of an
+// asynchronous decode.
+const format::size_type async_chunk_frame_count = 1 << 16;
+
+// Decodes the given file a chunk at a time, checking the given
+// cancellation between chunks.
+sequence decode (
+		const codec::decoder &decoder,
+		const std::string &filename,
+		const codec::cancellation &cancel) {
+	std::unique_ptr<codec::reader> reader = decoder.open(filename);
+
+	// the decoder has no reader of its own, the file is already decoded
+	if (sequence_reader *r = dynamic_cast<sequence_reader *>(reader.get())) {
+		return r->release();
+	}
+
+	sequence seq(reader->format());
+
+	while (reader->read(seq, async_chunk_frame_count) == async_chunk_frame_count) {
+		cancel.raise_if_cancelled();
+	}
+
+	return seq;
+}
+
+} // namespace decoder_
+
+codec::reader::~reader () {
+}
+
+format::size_type codec::reader::read (
+		sequence &seq,
+		format::size_type frame_count,
+		std::error_code &ec) noexcept {
+	format::size_type count = 0;
+	ec = error::capture([&] {
+		count = read(seq, frame_count);
+	});
+	return count;
+}
+
+sequence codec::decoder::decode (const std::string &filename) const {
+	return decode_file_(filename);
+}
+
+sequence codec::decoder::decode (std::istream &stream) const {
+	std::istream in(stream.rdbuf());
+	return decode_(in);
+}
+
+sequence codec::decoder::decode (utils::byte_source &source) const {
+	return decode_source_(source);
+}
+
+sequence codec::decoder::decode (const void *data, size_t size) const {
+	utils::memory_source source(data, size);
+	return decode_source_(source);
+}
+
+void codec::decoder::decode_into (const std::string &filename, sequence &dst)
+	const {
+	decode_file_into_(filename, dst);
+}
+
+void codec::decoder::decode_into (std::istream &stream, sequence &dst) const {
+	utils::stream_source source(stream);
+	decode_source_into_(source, dst);
+}
+
+void codec::decoder::decode_into (utils::byte_source &source, sequence &dst)
+	const {
+	decode_source_into_(source, dst);
+}
+
+void codec::decoder::decode_into (const void *data, size_t size, sequence &dst)
+	const {
+	utils::memory_source source(data, size);
+	decode_source_into_(source, dst);
+}
+
+void codec::decoder::decode_into (
+		const std::string &filename,
+		sequence &dst,
+		std::error_code &ec) const noexcept {
+	ec = error::capture([&] {
+		decode_file_into_(filename, dst);
+	});
+}
+
+void codec::decoder::decode_into (
+		utils::byte_source &source,
+		sequence &dst,
+		std::error_code &ec) const noexcept {
+	ec = error::capture([&] {
+		decode_source_into_(source, dst);
+	});
+}
+
+void codec::decoder::decode_into (
+		const void *data,
+		size_t size,
+		sequence &dst,
+		std::error_code &ec) const noexcept {
+	utils::memory_source source(data, size);
+	decode_into(source, dst, ec);
+}
+
+sequence codec::decoder::decode (
+		const std::string &filename,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	return decode_file_range_(filename, first_frame, frame_count);
+}
+
+sequence codec::decoder::decode (
+		std::istream &stream,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	std::istream in(stream.rdbuf());
+	return decode_range_(in, first_frame, frame_count);
+}
+
+sequence codec::decoder::decode_file_ (const std::string &filename) const {
 	std::ifstream in(filename, std::fstream::in|std::fstream::binary);
 	return decode_(in);
 }
 
-sequence codec::decoder::decode (std::istream &stream) const throw(error) {
+sequence codec::decoder::decode_file_range_ (
+		const std::string &filename,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	std::ifstream in(filename, std::fstream::in|std::fstream::binary);
+	return decode_range_(in, first_frame, frame_count);
+}
+
+sequence codec::decoder::decode_range_ (
+		std::istream &in,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	sequence seq = decode_(in);
+	sequence res(seq.format());
+
+	if (first_frame < seq.frame_count()) {
+		frame_count = std::min(frame_count, seq.frame_count() - first_frame);
+		res.append(seq.data(first_frame), frame_count);
+	}
+
+	return res;
+}
+
+codec::info codec::decoder::probe (const std::string &filename) const {
+	return probe_file_(filename);
+}
+
+codec::info codec::decoder::probe (std::istream &stream) const {
 	std::istream in(stream.rdbuf());
+	return probe_(in);
+}
+
+std::unique_ptr<codec::reader> codec::decoder::open (const std::string &filename)
+	const {
+	return open_file_(filename);
+}
+
+std::unique_ptr<codec::reader> codec::decoder::open_file_ (
+		const std::string &filename) const {
+	return std::unique_ptr<reader>(
+		new decoder_::sequence_reader(decode_file_(filename)));
+}
+
+std::future<sequence> codec::decoder::decode_async (
+		const std::string &filename,
+		const cancellation &cancel) const {
+	return execute<sequence>(cancel, [this, filename, cancel] {
+		return decoder_::decode(*this, filename, cancel);
+	});
+}
+
+void codec::decoder::decode_async (
+		const std::string &filename,
+		std::function<void (std::future<sequence>)> on_done,
+		const cancellation &cancel) const {
+	execute<sequence>(cancel, [this, filename, cancel] {
+		return decoder_::decode(*this, filename, cancel);
+	}, std::move(on_done));
+}
+
+codec::info codec::decoder::probe (utils::byte_source &source) const {
+	return probe_source_(source);
+}
+
+codec::info codec::decoder::probe (const void *data, size_t size) const {
+	utils::memory_source source(data, size);
+	return probe_source_(source);
+}
+
+sequence codec::decoder::decode_source_ (utils::byte_source &source) const {
+	utils::source_streambuf buffer(source);
+	std::istream in(&buffer);
 	return decode_(in);
 }
+
+void codec::decoder::decode_file_into_ (
+		const std::string &filename,
+		sequence &dst) const {
+	dst = decode_file_(filename);
+}
+
+void codec::decoder::decode_source_into_ (
+		utils::byte_source &source,
+		sequence &dst) const {
+	dst = decode_source_(source);
+}
+
+codec::info codec::decoder::probe_source_ (utils::byte_source &source) const {
+	utils::source_streambuf buffer(source);
+	std::istream in(&buffer);
+	return probe_(in);
+}
+
+codec::info codec::decoder::probe_file_ (const std::string &filename) const {
+	std::ifstream in(filename, std::fstream::in|std::fstream::binary);
+	return probe_(in);
+}
@@ -5,13 +5,24 @@
 #ifndef AUDIO_DECODER_H_
 #define AUDIO_DECODER_H_
 
+#include <functional>
+#include <future>
 #include <istream>
+#include <memory>
 #include <string>
+#include <system_error>
 
 #include <audio/error>
+#include <audio/format>
+#include <audio/codecs/async>
+#include <audio/codecs/info>
+#include <audio/codecs/reader>
 
 namespace com {
 namespace nealrame {
+namespace utils {
+class byte_source;
+} /* namespace utils */
 namespace audio {
 class sequence;
 namespace codec {
@@ -25,7 +36,7 @@ public:
 	///
 	/// *Exceptions:*
 	/// - `com::nealrame::audio::error`
-	virtual sequence decode (const std::string &filepath) const throw(error) final;
+	virtual sequence decode (const std::string &filepath) const final;
 
 	/// Decodes the given stream.
 	///
@@ -35,10 +46,246 @@ public:
 	///
 	/// *Exceptions:*
 	/// - `com::nealrame::audio::error`
-	virtual sequence decode (std::istream &stream) const throw(error) final;
+	virtual sequence decode (std::istream &stream) const final;
+
+	/// Decodes the given byte source. The WAVE, MP3 and Ogg Vorbis
+	/// decoders read the spans of the source directly, others read it
+	/// through a `std::istream`.
+	///
+	/// *Parameters:*
+	/// - `source`
+	///   The bytes to be decoded, from their current offset.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual sequence decode (utils::byte_source &source) const final;
+
+	/// Decodes the given bytes in place, they are not copied.
+	///
+	/// *Parameters:*
+	/// - `data`
+	///   The bytes to be decoded.
+	/// - `size`
+	///   The count of bytes to be decoded.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual sequence decode (const void *data, size_t size) const final;
+
+	/// Decodes a range of frames of the given file.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be decoded.
+	/// - `first_frame`
+	///   Index of the first frame to be decoded.
+	/// - `frame_count`
+	///   The requested count of frames.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual sequence decode (
+			const std::string &filepath,
+			format::size_type first_frame,
+			format::size_type frame_count) const final;
+
+	/// Decodes a range of frames of the given stream.
+	///
+	/// The returned `sequence` may contain less than `frame_count` frames
+	/// if the end of the stream is reached.
+	///
+	/// *Parameters:*
+	/// - `stream`
+	///   The stream to be decoded.
+	/// - `first_frame`
+	///   Index of the first frame to be decoded.
+	/// - `frame_count`
+	///   The requested count of frames.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual sequence decode (
+			std::istream &stream,
+			format::size_type first_frame,
+			format::size_type frame_count) const final;
+
+	/// Decodes the given file into the given sequence, replacing its
+	/// format and frames. The memory of the sequence is reused, decoding
+	/// files of similar lengths into the same sequence does not allocate
+	/// frames once it is large enough. The WAVE, MP3, Ogg Vorbis, FLAC
+	/// and raw PCM decoders size the sequence once from the length given
+	/// by the headers, others move a newly decoded sequence to it.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be decoded.
+	/// - `dst`
+	///   The sequence receiving the decoded frames.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual void decode_into (const std::string &filepath, sequence &dst) const final;
+
+	/// Same as above, for the given stream.
+	virtual void decode_into (std::istream &stream, sequence &dst) const final;
+
+	/// Same as above, for the given byte source.
+	virtual void decode_into (utils::byte_source &source, sequence &dst) const final;
+
+	/// Same as above, for the given bytes which are decoded in place.
+	virtual void decode_into (const void *data, size_t size, sequence &dst)
+		const final;
+
+	/// Same as the above, but failures are reported through `ec` instead
+	/// of an exception. `ec` is cleared on success, see `error::capture`.
+	/// Once `dst` is large enough, decoding a stream successfully
+	/// allocates no frames and unwinds nothing. Failures are not cheaper:
+	/// codecs still throw, and may build their message, before the
+	/// exception is caught here. There is no such variant for streams nor
+	/// for `probe`.
+	void decode_into (
+			const std::string &filepath,
+			sequence &dst,
+			std::error_code &ec) const noexcept;
+
+	/// Same as above, for the given byte source.
+	void decode_into (
+			utils::byte_source &source,
+			sequence &dst,
+			std::error_code &ec) const noexcept;
+
+	/// Same as above, for the given bytes which are decoded in place.
+	void decode_into (
+			const void *data,
+			size_t size,
+			sequence &dst,
+			std::error_code &ec) const noexcept;
+
+	/// Reads the properties of the given file from its headers, without
+	/// decoding it.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be probed.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual info probe (const std::string &filepath) const final;
+
+	/// Reads the properties of the given stream from its headers, without
+	/// decoding it.
+	///
+	/// *Parameters:*
+	/// - `stream`
+	///   The stream to be probed.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual info probe (std::istream &stream) const final;
+
+	/// Reads the properties of the given byte source from its headers,
+	/// without decoding it.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual info probe (utils::byte_source &source) const final;
+
+	/// Reads the properties of the given bytes from their headers,
+	/// without decoding them.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual info probe (const void *data, size_t size) const final;
+
+	/// Opens the given file to be decoded a few frames at a time.
+	/// Wrapping the returned reader in a `prefetch_reader` decodes the
+	/// frames ahead of the reads on another thread.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be decoded.
+	///
+	/// *Exceptions:*
+	/// - `com::nealrame::audio::error`
+	virtual std::unique_ptr<reader> open (const std::string &filepath) const final;
+
+	/// Decodes the given file on the threads of `codec::execute`. The
+	/// decoder must outlive the operation.
+	///
+	/// The file is decoded a chunk at a time by the reader returned by
+	/// `open`, on a single thread, and the cancellation is checked
+	/// between chunks. Decoders without a reader of their own decode the
+	/// whole file before the first check.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be decoded.
+	/// - `cancel`
+	///   Cancels the operation.
+	///
+	/// *Returns:*
+	/// The future of the decoded sequence.
+	std::future<sequence> decode_async (
+			const std::string &filepath,
+			const cancellation &cancel = cancellation()) const;
+
+	/// Same as above, but gives the ready future of the decoded sequence
+	/// to `on_done` from the thread which decoded it.
+	void decode_async (
+			const std::string &filepath,
+			std::function<void (std::future<sequence>)> on_done,
+			const cancellation &cancel = cancellation()) const;
 
 protected:
-	virtual sequence decode_ (std::istream &) const throw(error) = 0;
+	virtual sequence decode_ (std::istream &) const = 0;
+	virtual info probe_ (std::istream &) const = 0;
+
+	/// Default implementation decodes the file through a file stream.
+	/// Codecs which are able to read files by themselves should override
+	/// it.
+	virtual sequence decode_file_ (const std::string &filepath) const;
+
+	/// Default implementation probes the file through a file stream.
+	virtual info probe_file_ (const std::string &filepath) const;
+
+	/// Default implementation decodes the source through a
+	/// `std::istream`. Codecs which are able to consume spans of bytes
+	/// should override it.
+	virtual sequence decode_source_ (utils::byte_source &source) const;
+
+	/// Default implementation moves the sequence decoded by
+	/// `decode_file_` to `dst`, its memory is not reused.
+	virtual void decode_file_into_ (const std::string &filepath, sequence &dst)
+		const;
+
+	/// Default implementation moves the sequence decoded by
+	/// `decode_source_` to `dst`, its memory is not reused.
+	virtual void decode_source_into_ (utils::byte_source &source, sequence &dst)
+		const;
+
+	/// Default implementation probes the source through a `std::istream`.
+	virtual info probe_source_ (utils::byte_source &source) const;
+
+	/// Default implementation decodes the whole file at once, its reads
+	/// only copy the decoded frames. Codecs which are able to decode
+	/// streams incrementally should override it.
+	virtual std::unique_ptr<reader> open_file_ (const std::string &filepath)
+		const;
+
+	/// Default implementation decodes a range of the file through a file
+	/// stream.
+	virtual sequence decode_file_range_ (
+			const std::string &filepath,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+
+	/// Default implementation decodes the whole stream and then extracts
+	/// the requested range. Codecs which are able to seek should override
+	/// it.
+	virtual sequence decode_range_ (
+			std::istream &,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
 };
 } /* namespace codec */
 } /* namespace audio */
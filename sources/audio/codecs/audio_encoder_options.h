@@ -0,0 +1,68 @@
+/// audio_encoder_options.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_ENCODER_OPTIONS_H_
+#define AUDIO_ENCODER_OPTIONS_H_
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// struct com::nealrame::audio::codec::encoder_options
+/// ===================================================
+/// Settings of the compressing coders. Default settings give high quality
+/// streams, as the coders did before the settings existed: 128 kbit/s
+/// CBR MP3 and highest quality VBR Ogg Vorbis.
+struct encoder_options {
+	enum bitrate_mode {
+		/// CBR for MP3, VBR for Ogg Vorbis.
+		DefaultBitrate,
+		ConstantBitrate,
+		AverageBitrate,
+		VariableBitrate,
+	};
+
+	enum channel_mode {
+		JointStereo,
+		Stereo,
+	};
+
+	/// Bitrate management of the stream.
+	enum bitrate_mode bitrate_mode = DefaultBitrate;
+
+	/// Target bitrate in kbit/s of CBR and ABR streams. 0 stands for
+	/// 128 kbit/s.
+	unsigned int bitrate = 0;
+
+	/// Quality of VBR streams, from 0 (lowest) to 1 (highest). Values out
+	/// of this range are clamped.
+	float quality = 1.f;
+
+	/// Channel mode of stereo MP3 streams. Ogg Vorbis picks its channel
+	/// coupling by itself.
+	enum channel_mode channel_mode = JointStereo;
+
+	/// The "fast" preset: LAME uses its cheapest psychoacoustic and
+	/// quantization algorithms, FLAC only its fixed predictors. Intended
+	/// for preview renditions. libvorbis has no such setting, Ogg Vorbis
+	/// ignores it.
+	bool fast = false;
+
+	/// The count of threads used to encode a sequence. A count of 0 stands
+	/// for the count of hardware threads. See `MP3_coder`,
+	/// `OGGVorbis_coder` and `FLAC_coder`. MP3 streams are encoded by a
+	/// single thread unless `parallel_mp3` is set.
+	unsigned int thread_count = 1;
+
+	/// Lets `MP3_coder` split long sequences between the threads given by
+	/// `thread_count`. Segments encoded concurrently can not use the bit
+	/// reservoir of LAME, which lowers the quality of the stream at a given
+	/// bitrate, mostly for CBR and ABR streams.
+	bool parallel_mp3 = false;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_ENCODER_OPTIONS_H_ */
@@ -0,0 +1,1559 @@
+/// audio_flac_codec.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_flac_coder.h"
+#include "audio_flac_decoder.h"
+
+#include "../audio_sequence.h"
+#include "../audio_format.h"
+#include "../audio_sample.h"
+
+#include "../../utils/utils_buffer.h"
+#include "../../utils/utils_byte_source.h"
+#include "../../utils/utils_parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+using com::nealrame::audio::codec::FLAC_coder;
+using com::nealrame::audio::codec::FLAC_decoder;
+using com::nealrame::audio::codec::encoder_options;
+
+//////////////////////////////////////////////////////////////////////////////
+// Common ////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace flac_ {
+
+const unsigned char stream_marker[4] = { 'f', 'L', 'a', 'C' };
+
+const unsigned int stream_info_size = 34;
+const unsigned int max_channel_count = 8;
+const unsigned int max_lpc_order = 32;
+
+enum channel_assignment {
+	Independent = 0,
+	LeftSide = 8,
+	RightSide = 9,
+	MidSide = 10,
+};
+
+struct stream_info {
+	unsigned int min_block_size;
+	unsigned int max_block_size;
+	unsigned int sample_rate;
+	unsigned int channel_count;
+	unsigned int bits_per_sample;
+	uint64_t sample_count;
+};
+
+struct frame_header {
+	unsigned int block_size;
+	unsigned int channel_assignment;
+	unsigned int bits_per_sample;
+	uint64_t first_sample;
+	size_t size;
+};
+
+// CRC-8 (polynomial x^8 + x^2 + x + 1) protects the frame headers, CRC-16
+// (polynomial x^16 + x^15 + x^2 + 1) the whole frames.
+struct crc_tables {
+	uint8_t crc8[256];
+	uint16_t crc16[256];
+
+	crc_tables () {
+		for (unsigned int i = 0; i < 256; ++i) {
+			unsigned int c8 = i, c16 = i << 8;
+			for (int bit = 0; bit < 8; ++bit) {
+				c8 = (c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1;
+				c16 = (c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1;
+			}
+			crc8[i] = c8 & 0xff;
+			crc16[i] = c16 & 0xffff;
+		}
+	}
+};
+
+const crc_tables & tables () {
+	static const crc_tables tables_;
+	return tables_;
+}
+
+uint8_t crc8 (const unsigned char *data, size_t size) {
+	const crc_tables &t = tables();
+	uint8_t crc = 0;
+	while (size-- > 0) {
+		crc = t.crc8[crc ^ *data++];
+	}
+	return crc;
+}
+
+uint16_t crc16 (const unsigned char *data, size_t size) {
+	const crc_tables &t = tables();
+	uint16_t crc = 0;
+	while (size-- > 0) {
+		crc = (crc << 8) ^ t.crc16[(crc >> 8) ^ *data++];
+	}
+	return crc;
+}
+
+// Returns the size of the ID3v2 tag starting the given data, or 0.
+size_t id3_size (const unsigned char *data, size_t size) noexcept {
+	if (size < 10 || memcmp(data, "ID3", 3) != 0) {
+		return 0;
+	}
+	return 10
+		+ ((data[6] & 0x7f) << 21)
+		+ ((data[7] & 0x7f) << 14)
+		+ ((data[8] & 0x7f) << 7)
+		+ (data[9] & 0x7f)
+		+ ((data[5] & 0x10) ? 10 : 0);
+}
+
+unsigned int read_be (const unsigned char *data, unsigned int size) {
+	unsigned int value = 0;
+	while (size-- > 0) {
+		value = (value << 8) | *data++;
+	}
+	return value;
+}
+
+// Parses the frame header starting the given data. Returns `false` if it
+// is not a valid frame header of the stream.
+bool parse_frame_header (
+		const unsigned char *data,
+		size_t size,
+		const stream_info &info,
+		frame_header &header) noexcept {
+	if (size < 6 || data[0] != 0xff || (data[1] & 0xfe) != 0xf8
+		|| (data[3] & 0x01) != 0) {
+		return false;
+	}
+
+	bool variable_block_size = data[1] & 0x01;
+	unsigned int block_size_code = data[2] >> 4;
+	unsigned int sample_rate_code = data[2] & 0x0f;
+	unsigned int sample_size_code = (data[3] >> 1) & 0x07;
+
+	header.channel_assignment = data[3] >> 4;
+
+	if (block_size_code == 0 || sample_rate_code == 0x0f
+		|| sample_size_code == 3
+		|| header.channel_assignment > MidSide
+		|| (header.channel_assignment >= LeftSide
+			? 2 : header.channel_assignment + 1) != info.channel_count) {
+		return false;
+	}
+
+	static const unsigned int sample_sizes[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+	header.bits_per_sample = sample_size_code == 0
+		? info.bits_per_sample
+		: sample_sizes[sample_size_code];
+
+	if (header.bits_per_sample != info.bits_per_sample) {
+		return false;
+	}
+
+	// UTF-8 like coded frame or sample number
+	size_t offset = 4;
+	unsigned int extra;
+	uint64_t number = data[offset++];
+
+	if (number < 0x80) {
+		extra = 0;
+	} else if ((number & 0xe0) == 0xc0) {
+		extra = 1, number &= 0x1f;
+	} else if ((number & 0xf0) == 0xe0) {
+		extra = 2, number &= 0x0f;
+	} else if ((number & 0xf8) == 0xf0) {
+		extra = 3, number &= 0x07;
+	} else if ((number & 0xfc) == 0xf8) {
+		extra = 4, number &= 0x03;
+	} else if ((number & 0xfe) == 0xfc) {
+		extra = 5, number &= 0x01;
+	} else if (number == 0xfe) {
+		extra = 6, number = 0;
+	} else {
+		return false;
+	}
+
+	if (size < offset + extra + 5) {
+		return false;
+	}
+
+	for (; extra > 0; --extra) {
+		if ((data[offset] & 0xc0) != 0x80) {
+			return false;
+		}
+		number = (number << 6) | (data[offset++] & 0x3f);
+	}
+
+	if (block_size_code == 1) {
+		header.block_size = 192;
+	} else if (block_size_code <= 5) {
+		header.block_size = 576 << (block_size_code - 2);
+	} else if (block_size_code == 6) {
+		header.block_size = read_be(data + offset, 1) + 1;
+		offset += 1;
+	} else if (block_size_code == 7) {
+		header.block_size = read_be(data + offset, 2) + 1;
+		offset += 2;
+	} else {
+		header.block_size = 256 << (block_size_code - 8);
+	}
+
+	// the frame sample rate is not needed, only its size matters
+	if (sample_rate_code == 0x0c) {
+		offset += 1;
+	} else if (sample_rate_code >= 0x0d) {
+		offset += 2;
+	}
+
+	if (header.block_size > 65535
+		|| (info.max_block_size > 0
+			&& header.block_size > info.max_block_size)
+		|| crc8(data, offset) != data[offset]) {
+		return false;
+	}
+
+	header.first_sample = variable_block_size
+		? number
+		: number*info.max_block_size;
+	header.size = offset + 1;
+
+	return true;
+}
+
+} /* namespace flac_ */
+
+//////////////////////////////////////////////////////////////////////////////
+// Decoder ///////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace flac_ {
+
+void raise_format_error () {
+	error::raise_literal(error::CodecFormatError, "invalid FLAC frame");
+}
+
+class bit_reader {
+public:
+	bit_reader (const unsigned char *data, size_t size) :
+		data_(data),
+		bit_count_(8*size),
+		position_(0) {
+	}
+
+	size_t tell () const noexcept
+	{ return position_/8; }
+
+	void align () noexcept
+	{ position_ = (position_ + 7) & ~size_t(7); }
+
+	void skip (size_t size) {
+		check_(8*size);
+		position_ += 8*size;
+	}
+
+	uint32_t read (unsigned int n) {
+		if (n == 0) {
+			return 0;
+		}
+		check_(n);
+		uint32_t value = window_() >> (64 - n);
+		position_ += n;
+		return value;
+	}
+
+	int32_t read_signed (unsigned int n) {
+		if (n == 0) {
+			return 0;
+		}
+		return static_cast<int32_t>(read(n) << (32 - n)) >> (32 - n);
+	}
+
+	uint32_t read_unary () {
+		uint32_t count = 0;
+
+		for (;;) {
+			size_t left = bit_count_ - position_;
+			if (left == 0) {
+				raise_format_error();
+			}
+
+			uint64_t window = window_();
+			unsigned int valid = std::min<size_t>(left, 57);
+			if (window != 0) {
+				unsigned int zeros = __builtin_clzll(window);
+				if (zeros < valid) {
+					position_ += zeros + 1;
+					return count + zeros;
+				}
+			}
+			count += valid;
+			position_ += valid;
+		}
+	}
+
+	int32_t read_rice (unsigned int parameter) {
+		uint32_t value = (read_unary() << parameter) | read(parameter);
+		return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+	}
+
+private:
+	void check_ (size_t n) const {
+		if (bit_count_ - position_ < n) {
+			raise_format_error();
+		}
+	}
+
+	// Returns the next 57 bits at least, the first one being the most
+	// significant bit. Bits past the end are 0.
+	uint64_t window_ () const noexcept {
+		size_t byte = position_/8;
+		size_t size = bit_count_/8;
+		uint64_t window = 0;
+
+		if (byte + 8 <= size) {
+			for (int i = 0; i < 8; ++i) {
+				window = (window << 8) | data_[byte + i];
+			}
+		} else {
+			for (size_t i = 0; i < 8; ++i) {
+				window = (window << 8) | (byte + i < size ? data_[byte + i] : 0);
+			}
+		}
+
+		return window << (position_ & 7);
+	}
+
+private:
+	const unsigned char *data_;
+	size_t bit_count_;
+	size_t position_;
+};
+
+// Decodes the frames of a stream into planar integer channels, then
+// converts them to interleaved float samples.
+class frame_decoder {
+public:
+	explicit frame_decoder (const stream_info &info) :
+		info_(info),
+		channels_(info.channel_count) {
+	}
+
+	// Decodes the frame starting the given data. Returns its size.
+	size_t read (
+			const unsigned char *data,
+			size_t size,
+			const frame_header &header) {
+		bit_reader in(data, size);
+
+		in.skip(header.size);
+		for (std::vector<int32_t> &channel: channels_) {
+			channel.resize(header.block_size);
+		}
+
+		for (unsigned int c = 0; c < info_.channel_count; ++c) {
+			bool side =
+				(header.channel_assignment == LeftSide && c == 1)
+				|| (header.channel_assignment == RightSide && c == 0)
+				|| (header.channel_assignment == MidSide && c == 1);
+
+			read_subframe_(in,
+				header.bits_per_sample + (side ? 1 : 0),
+				header.block_size,
+				channels_[c].data());
+		}
+
+		in.align();
+		size_t frame_size = in.tell();
+		uint16_t crc = in.read(16);
+
+		if (crc16(data, frame_size) != crc) {
+			error::raise_literal(error::CodecFormatError, "FLAC frame CRC mismatch");
+		}
+
+		decorrelate_(header);
+		return frame_size + 2;
+	}
+
+	// Writes the last decoded frame to the given interleaved samples.
+	void write (const frame_header &header, float *pcm) const noexcept {
+		const float scale = 1.f/static_cast<float>(1u << (header.bits_per_sample - 1));
+		const size_t channel_count = info_.channel_count;
+
+		for (size_t c = 0; c < channel_count; ++c) {
+			const int32_t *samples = channels_[c].data();
+			float *out = pcm + c;
+			for (size_t i = 0; i < header.block_size; ++i) {
+				out[i*channel_count] = samples[i]*scale;
+			}
+		}
+	}
+
+private:
+	static void read_residual_ (
+			bit_reader &in,
+			unsigned int block_size,
+			unsigned int order,
+			int32_t *residual) {
+		unsigned int method = in.read(2);
+
+		if (method > 1) {
+			raise_format_error();
+		}
+
+		unsigned int parameter_size = method == 0 ? 4 : 5;
+		unsigned int escape = method == 0 ? 0x0f : 0x1f;
+		unsigned int partition_order = in.read(4);
+		unsigned int partition_size = block_size >> partition_order;
+
+		if ((partition_size << partition_order) != block_size
+			|| partition_size < order) {
+			raise_format_error();
+		}
+
+		for (unsigned int p = 0; p < (1u << partition_order); ++p) {
+			unsigned int parameter = in.read(parameter_size);
+			unsigned int count = partition_size - (p == 0 ? order : 0);
+
+			if (parameter == escape) {
+				unsigned int bits = in.read(5);
+				for (unsigned int i = 0; i < count; ++i) {
+					*residual++ = in.read_signed(bits);
+				}
+			} else {
+				for (unsigned int i = 0; i < count; ++i) {
+					*residual++ = in.read_rice(parameter);
+				}
+			}
+		}
+	}
+
+	static void restore_fixed_ (
+			int32_t *x,
+			unsigned int block_size,
+			unsigned int order) noexcept {
+		switch (order) {
+		case 1:
+			for (unsigned int i = 1; i < block_size; ++i) {
+				x[i] += x[i - 1];
+			}
+			break;
+
+		case 2:
+			for (unsigned int i = 2; i < block_size; ++i) {
+				x[i] += 2*x[i - 1] - x[i - 2];
+			}
+			break;
+
+		case 3:
+			for (unsigned int i = 3; i < block_size; ++i) {
+				x[i] += 3*(x[i - 1] - x[i - 2]) + x[i - 3];
+			}
+			break;
+
+		case 4:
+			for (unsigned int i = 4; i < block_size; ++i) {
+				x[i] += 4*(x[i - 1] + x[i - 3]) - 6*x[i - 2] - x[i - 4];
+			}
+			break;
+		}
+	}
+
+	// The coefficients are stored from the oldest sample to the newest
+	// one, so that the inner product runs over contiguous memory.
+	template <typename Accumulator>
+	static void restore_lpc_ (
+			int32_t *x,
+			unsigned int block_size,
+			const int32_t *coefficients,
+			unsigned int order,
+			int shift) noexcept {
+		for (unsigned int i = order; i < block_size; ++i) {
+			const int32_t *history = x + i - order;
+			Accumulator sum = 0;
+			for (unsigned int j = 0; j < order; ++j) {
+				sum += static_cast<Accumulator>(coefficients[j])*history[j];
+			}
+			x[i] += static_cast<int32_t>(sum >> shift);
+		}
+	}
+
+	static void read_subframe_ (
+			bit_reader &in,
+			unsigned int bits_per_sample,
+			unsigned int block_size,
+			int32_t *x) {
+		if (in.read(1) != 0) {
+			raise_format_error();
+		}
+
+		unsigned int type = in.read(6);
+		unsigned int wasted_bits = 0;
+
+		if (in.read(1) != 0) {
+			wasted_bits = in.read_unary() + 1;
+			if (wasted_bits >= bits_per_sample) {
+				raise_format_error();
+			}
+			bits_per_sample -= wasted_bits;
+		}
+
+		if (type == 0) {
+			std::fill(x, x + block_size, in.read_signed(bits_per_sample));
+		} else if (type == 1) {
+			for (unsigned int i = 0; i < block_size; ++i) {
+				x[i] = in.read_signed(bits_per_sample);
+			}
+		} else if (type >= 8 && type <= 12) {
+			unsigned int order = type - 8;
+
+			if (order > block_size) {
+				raise_format_error();
+			}
+			for (unsigned int i = 0; i < order; ++i) {
+				x[i] = in.read_signed(bits_per_sample);
+			}
+			read_residual_(in, block_size, order, x + order);
+			restore_fixed_(x, block_size, order);
+		} else if (type >= 32) {
+			unsigned int order = type - 31;
+
+			if (order > block_size) {
+				raise_format_error();
+			}
+			for (unsigned int i = 0; i < order; ++i) {
+				x[i] = in.read_signed(bits_per_sample);
+			}
+
+			unsigned int precision = in.read(4) + 1;
+			int shift = in.read_signed(5);
+
+			if (precision == 16 || shift < 0) {
+				raise_format_error();
+			}
+
+			int32_t coefficients[max_lpc_order];
+			for (unsigned int j = 0; j < order; ++j) {
+				coefficients[order - 1 - j] = in.read_signed(precision);
+			}
+
+			read_residual_(in, block_size, order, x + order);
+
+			// 32 bits sums are enough for 16 bits streams and vectorize
+			// better
+			unsigned int order_bits = 0;
+			while ((1u << order_bits) < order) {
+				++order_bits;
+			}
+			if (bits_per_sample + precision + order_bits <= 32) {
+				restore_lpc_<int32_t>(x, block_size, coefficients, order, shift);
+			} else {
+				restore_lpc_<int64_t>(x, block_size, coefficients, order, shift);
+			}
+		} else {
+			raise_format_error();
+		}
+
+		if (wasted_bits > 0) {
+			for (unsigned int i = 0; i < block_size; ++i) {
+				x[i] <<= wasted_bits;
+			}
+		}
+	}
+
+	void decorrelate_ (const frame_header &header) noexcept {
+		if (header.channel_assignment < LeftSide) {
+			return;
+		}
+
+		int32_t *left = channels_[0].data();
+		int32_t *right = channels_[1].data();
+		unsigned int block_size = header.block_size;
+
+		switch (header.channel_assignment) {
+		case LeftSide:
+			for (unsigned int i = 0; i < block_size; ++i) {
+				right[i] = left[i] - right[i];
+			}
+			break;
+
+		case RightSide:
+			for (unsigned int i = 0; i < block_size; ++i) {
+				left[i] += right[i];
+			}
+			break;
+
+		case MidSide:
+			for (unsigned int i = 0; i < block_size; ++i) {
+				int32_t side = right[i];
+				int32_t mid = static_cast<int32_t>(
+					(static_cast<uint32_t>(left[i]) << 1) | (side & 1));
+				left[i] = (mid + side) >> 1;
+				right[i] = (mid - side) >> 1;
+			}
+			break;
+		}
+	}
+
+private:
+	const stream_info &info_;
+	std::vector<std::vector<int32_t>> channels_;
+};
+
+// Reads the metadata blocks of the given stream. The stream is left at
+// its first frame.
+stream_info read_metadata (std::istream &input) {
+	unsigned char head[10];
+
+	input.read(reinterpret_cast<char *>(head), 4);
+	if (input.gcount() == 4 && memcmp(head, "ID3", 3) == 0) {
+		input.read(reinterpret_cast<char *>(head) + 4, 6);
+
+		size_t tag_size = id3_size(head, input.gcount() + 4);
+		if (tag_size == 0) {
+			error::raise_literal(error::CodecFormatError, "truncated ID3 tag");
+		}
+		input.ignore(tag_size - 10);
+		input.read(reinterpret_cast<char *>(head), 4);
+	}
+
+	if (input.gcount() != 4 || memcmp(head, stream_marker, 4) != 0) {
+		error::raise_literal(error::CodecFormatError, "not a FLAC stream");
+	}
+
+	stream_info info;
+	bool has_stream_info = false;
+	bool last = false;
+
+	while (! last) {
+		input.read(reinterpret_cast<char *>(head), 4);
+		if (input.gcount() != 4) {
+			error::raise_literal(error::CodecFormatError, "truncated FLAC metadata");
+		}
+
+		last = head[0] & 0x80;
+		unsigned int type = head[0] & 0x7f;
+		unsigned int length = read_be(head + 1, 3);
+
+		if (type != 0) {
+			input.ignore(length);
+			continue;
+		}
+
+		unsigned char block[stream_info_size];
+		if (length < stream_info_size
+			|| ! input.read(reinterpret_cast<char *>(block), stream_info_size)) {
+			error::raise_literal(error::CodecFormatError, "invalid FLAC STREAMINFO");
+		}
+		input.ignore(length - stream_info_size);
+
+		info.min_block_size = read_be(block, 2);
+		info.max_block_size = read_be(block + 2, 2);
+		info.sample_rate = read_be(block + 10, 3) >> 4;
+		info.channel_count = ((block[12] >> 1) & 0x07) + 1;
+		info.bits_per_sample = (((block[12] & 0x01) << 4) | (block[13] >> 4)) + 1;
+		info.sample_count =
+			(static_cast<uint64_t>(block[13] & 0x0f) << 32)
+			| read_be(block + 14, 4);
+		has_stream_info = true;
+	}
+
+	if (! has_stream_info) {
+		error::raise_literal(error::CodecFormatError, "missing FLAC STREAMINFO");
+	}
+
+	if (info.bits_per_sample < 4 || info.bits_per_sample > 24) {
+		error::raise(error::FormatUnhandledSampleQuantificationValueError);
+	}
+
+	return info;
+}
+
+// Decodes the frames into the given sequence, whose format and frames are
+// replaced. Its capacity is set once from the length of the stream.
+void read_frames (
+		const stream_info &info,
+		const unsigned char *data,
+		size_t size,
+		sequence &seq) {
+	seq.reset(format(info.channel_count, info.sample_rate));
+	seq.reserve(info.sample_count);
+
+	frame_decoder decoder(info);
+	size_t offset = 0;
+
+	while (offset < size) {
+		frame_header header;
+
+		if (! parse_frame_header(data + offset, size - offset, info, header)) {
+			raise_format_error();
+		}
+
+		offset += decoder.read(data + offset, size - offset, header);
+
+		format::size_type frame_count = seq.frame_count();
+		seq.set_frame_count(frame_count + header.block_size);
+		decoder.write(header, seq.data(frame_count));
+	}
+}
+
+// Returns the offset of the first frame header at or after the given
+// offset, or `size` if there is none.
+size_t find_frame (
+		const stream_info &info,
+		const unsigned char *data,
+		size_t size,
+		size_t offset) noexcept {
+	frame_header header;
+
+	for (; offset + 1 < size; ++offset) {
+		if (data[offset] == 0xff && (data[offset + 1] & 0xfe) == 0xf8
+			&& parse_frame_header(data + offset, size - offset, info, header)) {
+			return offset;
+		}
+	}
+
+	return size;
+}
+
+// Same as `read_frames`, but segments of the stream are decoded by the
+// given count of threads straight into the given sequence.
+void read_frames_parallel (
+		const stream_info &info,
+		const unsigned char *data,
+		size_t size,
+		unsigned int thread_count,
+		sequence &seq) {
+	const size_t min_segment_size = 1 << 16;
+	size_t segment_count = std::min<size_t>(4*thread_count, size/min_segment_size);
+
+	// Frames carry their position, but streams of unknown length can not
+	// be preallocated.
+	if (segment_count < 2 || info.sample_count == 0 || info.max_block_size == 0) {
+		read_frames(info, data, size, seq);
+		return;
+	}
+
+	// Segments start at the first frame header following evenly spaced
+	// offsets. A sync code may also appear in the data of a frame, in
+	// which case the segments do not match the frames boundaries and the
+	// stream is decoded again by a single thread.
+	std::vector<size_t> bounds{ 0 };
+
+	for (size_t i = 1; i < segment_count; ++i) {
+		size_t offset = find_frame(info, data, size,
+			std::max(i*size/segment_count, bounds.back() + 1));
+		if (offset >= size) {
+			break;
+		}
+		bounds.push_back(offset);
+	}
+	bounds.push_back(size);
+
+	seq.reset(format(info.channel_count, info.sample_rate));
+	seq.set_frame_count(info.sample_count);
+	std::atomic<bool> mismatch(false);
+	std::atomic<uint64_t> sample_count(0);
+
+	utils::parallel_for(bounds.size() - 1, thread_count, [&](size_t i) {
+		frame_decoder decoder(info);
+		size_t offset = bounds[i];
+
+		try {
+			while (offset < bounds[i + 1] && ! mismatch) {
+				frame_header header;
+
+				if (! parse_frame_header(data + offset, size - offset, info, header)
+					|| header.first_sample + header.block_size > info.sample_count) {
+					break;
+				}
+
+				offset += decoder.read(data + offset, size - offset, header);
+				decoder.write(header, seq.data(header.first_sample));
+				sample_count += header.block_size;
+			}
+		} catch (const error &) {
+			mismatch = true;
+		}
+
+		if (offset != bounds[i + 1]) {
+			mismatch = true;
+		}
+	});
+
+	if (mismatch || sample_count != info.sample_count) {
+		read_frames(info, data, size, seq);
+	}
+}
+} /* namespace flac_ */
+
+FLAC_decoder::FLAC_decoder (unsigned int thread_count) :
+	thread_count_(thread_count) {
+}
+
+bool FLAC_decoder::sniff (const unsigned char *data, size_t size) noexcept {
+	size_t offset = flac_::id3_size(data, size);
+
+	return size >= offset + 4
+		&& memcmp(data + offset, flac_::stream_marker, 4) == 0;
+}
+
+sequence FLAC_decoder::decode_ (std::istream &input) const {
+	flac_::stream_info info = flac_::read_metadata(input);
+	utils::buffer data = utils::read(input);
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	sequence seq(format(info.channel_count, info.sample_rate));
+
+	if (thread_count > 1) {
+		flac_::read_frames_parallel(
+			info, data.data<unsigned char>(), data.size(), thread_count, seq);
+	} else {
+		flac_::read_frames(info, data.data<unsigned char>(), data.size(), seq);
+	}
+
+	return seq;
+}
+
+void FLAC_decoder::decode_file_into_ (const std::string &filepath, sequence &dst)
+	const {
+	utils::mapped_source source(filepath);
+
+	if (! source.is_open()) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	decode_source_into_(source, dst);
+}
+
+void FLAC_decoder::decode_source_into_ (utils::byte_source &source, sequence &dst)
+	const {
+	utils::source_streambuf buffer(source);
+	std::istream input(&buffer);
+
+	flac_::stream_info info = flac_::read_metadata(input);
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	// frames are decoded from memory, sources which are not in memory
+	// are copied first
+	utils::buffer copy;
+	const unsigned char *data;
+	size_t size;
+
+	if (source.data() != nullptr) {
+		size_t offset = input.tellg();
+		data = source.data() + offset;
+		size = source.size() - offset;
+		source.seek(source.size());
+	} else {
+		copy = utils::read(input);
+		data = copy.data<unsigned char>();
+		size = copy.size();
+	}
+
+	if (thread_count > 1) {
+		flac_::read_frames_parallel(info, data, size, thread_count, dst);
+	} else {
+		flac_::read_frames(info, data, size, dst);
+	}
+}
+
+codec::info FLAC_decoder::probe_ (std::istream &input) const {
+	flac_::stream_info info = flac_::read_metadata(input);
+	format fmt(info.channel_count, info.sample_rate);
+	unsigned int bitrate = 0;
+
+	std::streampos first_frame = input.tellg();
+	if (first_frame >= 0 && info.sample_count > 0
+		&& input.seekg(0, std::ios::end)) {
+		double size = static_cast<double>(input.tellg() - first_frame);
+		bitrate = 8*size/fmt.duration(info.sample_count);
+		input.seekg(first_frame);
+	}
+
+	return codec::info{
+		"flac",
+		fmt,
+		info.sample_count,
+		bitrate
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Coder /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace flac_ {
+
+const double pi = 3.14159265358979323846;
+
+const unsigned int block_size = 4096;
+const unsigned int bits_per_sample = 16;
+const unsigned int max_partition_order = 6;
+
+// Frames are encoded by batches, so that the encoded stream is not held
+// in memory.
+const size_t frames_per_thread = 16;
+
+class bit_writer {
+public:
+	bit_writer () :
+		cache_(0),
+		cache_size_(0) {
+	}
+
+	const std::vector<unsigned char> & data () const noexcept
+	{ return data_; }
+
+	std::vector<unsigned char> && release () noexcept
+	{ return std::move(data_); }
+
+	void write (uint32_t value, unsigned int n) {
+		if (n == 0) {
+			return;
+		}
+		if (n < 32) {
+			value &= (1u << n) - 1;
+		}
+		cache_ = (cache_ << n) | value;
+		cache_size_ += n;
+		while (cache_size_ >= 8) {
+			cache_size_ -= 8;
+			data_.push_back(static_cast<unsigned char>(cache_ >> cache_size_));
+		}
+	}
+
+	void write_signed (int32_t value, unsigned int n)
+	{ write(static_cast<uint32_t>(value), n); }
+
+	void write_unary (uint32_t zeros) {
+		for (; zeros >= 32; zeros -= 32) {
+			write(0, 32);
+		}
+		write(1, zeros + 1);
+	}
+
+	void write_rice (int32_t value, unsigned int parameter) {
+		uint32_t u = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+		write_unary(u >> parameter);
+		write(u, parameter);
+	}
+
+	void align () {
+		if (cache_size_ > 0) {
+			write(0, 8 - cache_size_);
+		}
+	}
+
+private:
+	std::vector<unsigned char> data_;
+	uint64_t cache_;
+	unsigned int cache_size_;
+};
+
+struct encoder_settings {
+	unsigned int max_lpc_order;
+	unsigned int lpc_precision;
+
+	explicit encoder_settings (const encoder_options &options) :
+		max_lpc_order(0),
+		lpc_precision(12) {
+		if (! options.fast) {
+			float quality = std::min(1.f, std::max(0.f, options.quality));
+			max_lpc_order = 4 + static_cast<unsigned int>(std::lround(8*quality));
+		}
+	}
+};
+
+// The residual of a predictor, as it will be written.
+struct residual {
+	std::vector<int32_t> values;
+	unsigned int partition_order;
+	unsigned int parameters[1 << max_partition_order];
+	bool wide_parameters;
+	size_t bit_count;
+
+	// Chooses the partitioning and the Rice parameters of the values
+	// and sets `bit_count`.
+	void plan (unsigned int block_size, unsigned int order) {
+		unsigned int finest = 0;
+		while (finest < max_partition_order
+			&& (block_size >> (finest + 1)) << (finest + 1) == block_size
+			&& (block_size >> (finest + 1)) > order) {
+			++finest;
+		}
+
+		// sums of the zigzag coded values of the finest partitions, the
+		// coarser ones are merged from them
+		uint64_t sums[1 << max_partition_order];
+		unsigned int partition_size = block_size >> finest;
+		const int32_t *value = values.data();
+
+		for (unsigned int p = 0; p < (1u << finest); ++p) {
+			unsigned int count = partition_size - (p == 0 ? order : 0);
+			uint64_t sum = 0;
+			for (unsigned int i = 0; i < count; ++i, ++value) {
+				sum += (static_cast<uint32_t>(*value) << 1) ^ static_cast<uint32_t>(*value >> 31);
+			}
+			sums[p] = sum;
+		}
+
+		bit_count = std::numeric_limits<size_t>::max();
+
+		for (unsigned int level = finest + 1; level-- > 0;) {
+			unsigned int partitions[1 << max_partition_order];
+			size_t bits = 6;
+			bool wide = false;
+
+			for (unsigned int p = 0; p < (1u << level); ++p) {
+				uint64_t count = (block_size >> level) - (p == 0 ? order : 0);
+				unsigned int best = 0;
+				uint64_t best_bits = std::numeric_limits<uint64_t>::max();
+
+				for (unsigned int k = 0; k <= 30; ++k) {
+					uint64_t k_bits = count*(k + 1) + (sums[p] >> k);
+					if (k_bits < best_bits) {
+						best = k, best_bits = k_bits;
+					}
+				}
+				partitions[p] = best;
+				wide = wide || best > 14;
+				bits += best_bits;
+			}
+
+			bits += (1u << level)*(wide ? 5 : 4);
+			if (bits < bit_count) {
+				bit_count = bits;
+				partition_order = level;
+				wide_parameters = wide;
+				std::copy(partitions, partitions + (1u << level), parameters);
+			}
+
+			// merge pairs of partitions for the next level
+			for (unsigned int p = 0; level > 0 && p < (1u << (level - 1)); ++p) {
+				sums[p] = sums[2*p] + sums[2*p + 1];
+			}
+		}
+	}
+
+	void write (bit_writer &out, unsigned int block_size, unsigned int order) const {
+		out.write(wide_parameters ? 1 : 0, 2);
+		out.write(partition_order, 4);
+
+		const int32_t *value = values.data();
+		for (unsigned int p = 0; p < (1u << partition_order); ++p) {
+			unsigned int count = (block_size >> partition_order) - (p == 0 ? order : 0);
+			out.write(parameters[p], wide_parameters ? 5 : 4);
+			for (unsigned int i = 0; i < count; ++i) {
+				out.write_rice(*value++, parameters[p]);
+			}
+		}
+	}
+};
+
+class subframe {
+public:
+	// Chooses the smallest coding of the given samples.
+	subframe (
+			const int32_t *samples,
+			unsigned int block_size,
+			unsigned int bits_per_sample,
+			const encoder_settings &settings) :
+		block_size_(block_size),
+		bits_per_sample_(bits_per_sample),
+		wasted_bits_(0),
+		type_(Verbatim),
+		order_(0) {
+		int32_t any = 0;
+		for (unsigned int i = 0; i < block_size; ++i) {
+			any |= samples[i];
+		}
+
+		samples_.assign(samples, samples + block_size);
+
+		if (std::all_of(samples, samples + block_size,
+				[&](int32_t s) { return s == samples[0]; })) {
+			type_ = Constant;
+			bit_count_ = 8 + bits_per_sample;
+			return;
+		}
+
+		// low bits which are 0 in all samples are not coded
+		while (((any >> wasted_bits_) & 1) == 0) {
+			++wasted_bits_;
+		}
+		if (wasted_bits_ > 0) {
+			for (int32_t &s: samples_) {
+				s >>= wasted_bits_;
+			}
+			bits_per_sample_ -= wasted_bits_;
+		}
+
+		bit_count_ = 8 + wasted_bits_ + block_size*bits_per_sample_;
+
+		try_fixed_();
+		if (settings.max_lpc_order > 0) {
+			try_lpc_(settings);
+		}
+	}
+
+	size_t bit_count () const noexcept
+	{ return bit_count_; }
+
+	void write (bit_writer &out) const {
+		switch (type_) {
+		case Constant:
+			out.write(0, 8);
+			out.write_signed(samples_[0], bits_per_sample_);
+			return;
+
+		case Verbatim:
+			write_header_(out, 1);
+			for (int32_t s: samples_) {
+				out.write_signed(s, bits_per_sample_);
+			}
+			return;
+
+		case Fixed:
+			write_header_(out, 8 + order_);
+			write_warmup_(out);
+			residual_.write(out, block_size_, order_);
+			return;
+
+		case LPC:
+			write_header_(out, 31 + order_);
+			write_warmup_(out);
+			out.write(precision_ - 1, 4);
+			out.write_signed(shift_, 5);
+			for (unsigned int j = 0; j < order_; ++j) {
+				out.write_signed(coefficients_[j], precision_);
+			}
+			residual_.write(out, block_size_, order_);
+			return;
+		}
+	}
+
+private:
+	enum type { Constant, Verbatim, Fixed, LPC };
+
+	void write_header_ (bit_writer &out, unsigned int type) const {
+		out.write(type << 1 | (wasted_bits_ > 0 ? 1 : 0), 8);
+		if (wasted_bits_ > 0) {
+			out.write_unary(wasted_bits_ - 1);
+		}
+	}
+
+	void write_warmup_ (bit_writer &out) const {
+		for (unsigned int i = 0; i < order_; ++i) {
+			out.write_signed(samples_[i], bits_per_sample_);
+		}
+	}
+
+	void try_fixed_ () {
+		const int32_t *x = samples_.data();
+		unsigned int max_order = std::min(4u, block_size_ - 1);
+		uint64_t errors[5] = { 0, 0, 0, 0, 0 };
+
+		for (unsigned int i = 4; i < block_size_; ++i) {
+			int64_t e0 = x[i];
+			int64_t e1 = e0 - x[i - 1];
+			int64_t e2 = e1 - (x[i - 1] - int64_t(x[i - 2]));
+			int64_t e3 = e2 - (x[i - 1] - 2*int64_t(x[i - 2]) + x[i - 3]);
+			int64_t e4 = e3 - (x[i - 1] - 3*int64_t(x[i - 2]) + 3*int64_t(x[i - 3]) - x[i - 4]);
+			errors[0] += std::abs(e0);
+			errors[1] += std::abs(e1);
+			errors[2] += std::abs(e2);
+			errors[3] += std::abs(e3);
+			errors[4] += std::abs(e4);
+		}
+
+		unsigned int order = 0;
+		for (unsigned int o = 1; o <= max_order; ++o) {
+			if (errors[o] < errors[order]) {
+				order = o;
+			}
+		}
+
+		residual r;
+		r.values.resize(block_size_ - order);
+		for (unsigned int i = order; i < block_size_; ++i) {
+			int64_t prediction = 0;
+			switch (order) {
+			case 1: prediction = x[i - 1]; break;
+			case 2: prediction = 2*int64_t(x[i - 1]) - x[i - 2]; break;
+			case 3: prediction = 3*(int64_t(x[i - 1]) - x[i - 2]) + x[i - 3]; break;
+			case 4: prediction = 4*(int64_t(x[i - 1]) + x[i - 3]) - 6*int64_t(x[i - 2]) - x[i - 4]; break;
+			}
+			r.values[i - order] = static_cast<int32_t>(x[i] - prediction);
+		}
+		r.plan(block_size_, order);
+
+		size_t bits = 8 + wasted_bits_ + order*bits_per_sample_ + r.bit_count;
+		if (bits < bit_count_) {
+			type_ = Fixed;
+			order_ = order;
+			residual_ = std::move(r);
+			bit_count_ = bits;
+		}
+	}
+
+	void try_lpc_ (const encoder_settings &settings) {
+		unsigned int max_order = std::min(settings.max_lpc_order, block_size_ - 1);
+		const int32_t *x = samples_.data();
+
+		// Tukey(0.5) windowed autocorrelation
+		std::vector<double> windowed(block_size_);
+		double taper = 0.25*(block_size_ - 1);
+
+		for (unsigned int i = 0; i < block_size_; ++i) {
+			double distance = std::min<double>(i, block_size_ - 1 - i);
+			double w = distance < taper
+				? 0.5*(1 - std::cos(pi*distance/taper))
+				: 1.;
+			windowed[i] = w*x[i];
+		}
+
+		double autocorrelation[max_lpc_order + 1];
+		for (unsigned int lag = 0; lag <= max_order; ++lag) {
+			double sum = 0;
+			for (unsigned int i = lag; i < block_size_; ++i) {
+				sum += windowed[i]*windowed[i - lag];
+			}
+			autocorrelation[lag] = sum;
+		}
+
+		if (autocorrelation[0] == 0) {
+			return;
+		}
+
+		// Levinson-Durbin recursion, the expected size of the residual
+		// of each order picks the one to be coded
+		double lpc[max_lpc_order][max_lpc_order];
+		double a[max_lpc_order] = { 0 };
+		double err = autocorrelation[0];
+		unsigned int best_order = 0;
+		double best_bits = std::numeric_limits<double>::max();
+
+		for (unsigned int o = 0; o < max_order; ++o) {
+			double k = -autocorrelation[o + 1];
+			for (unsigned int j = 0; j < o; ++j) {
+				k -= a[j]*autocorrelation[o - j];
+			}
+			k /= err;
+
+			double previous[max_lpc_order];
+			std::copy(a, a + o, previous);
+			a[o] = k;
+			for (unsigned int j = 0; j < o; ++j) {
+				a[j] += k*previous[o - 1 - j];
+			}
+			err *= 1 - k*k;
+
+			for (unsigned int j = 0; j <= o; ++j) {
+				lpc[o][j] = -a[j];
+			}
+
+			double bits_per_residual = err > 0
+				? std::max(0., 0.5*std::log2(0.5*err/block_size_))
+				: 0.;
+			double bits = bits_per_residual*(block_size_ - o - 1)
+				+ (o + 1)*(bits_per_sample_ + settings.lpc_precision);
+			if (bits < best_bits) {
+				best_order = o + 1;
+				best_bits = bits;
+			}
+
+			if (err <= 0) {
+				break;
+			}
+		}
+
+		if (best_order == 0) {
+			return;
+		}
+
+		// quantize the coefficients
+		const double *c = lpc[best_order - 1];
+		unsigned int precision = settings.lpc_precision;
+		double max_coefficient = 0;
+
+		for (unsigned int j = 0; j < best_order; ++j) {
+			max_coefficient = std::max(max_coefficient, std::fabs(c[j]));
+		}
+		if (max_coefficient <= 0) {
+			return;
+		}
+
+		int exponent;
+		std::frexp(max_coefficient, &exponent);
+		int shift = std::min<int>(15, precision - 1 - exponent);
+		if (shift < 0) {
+			return;
+		}
+
+		int32_t q[max_lpc_order];
+		int32_t q_max = (1 << (precision - 1)) - 1;
+		double carry = 0;
+
+		for (unsigned int j = 0; j < best_order; ++j) {
+			carry += c[j]*(1 << shift);
+			long value = std::lround(carry);
+			value = std::max<long>(-q_max - 1, std::min<long>(q_max, value));
+			q[j] = value;
+			carry -= value;
+		}
+
+		residual r;
+		r.values.resize(block_size_ - best_order);
+		for (unsigned int i = best_order; i < block_size_; ++i) {
+			int64_t sum = 0;
+			for (unsigned int j = 0; j < best_order; ++j) {
+				sum += int64_t(q[j])*x[i - 1 - j];
+			}
+			int64_t value = x[i] - (sum >> shift);
+			if (value > std::numeric_limits<int32_t>::max() / 2
+				|| value < std::numeric_limits<int32_t>::min() / 2) {
+				return;
+			}
+			r.values[i - best_order] = static_cast<int32_t>(value);
+		}
+		r.plan(block_size_, best_order);
+
+		size_t bits = 8 + wasted_bits_ + best_order*bits_per_sample_
+			+ 4 + 5 + best_order*precision + r.bit_count;
+		if (bits < bit_count_) {
+			type_ = LPC;
+			order_ = best_order;
+			precision_ = precision;
+			shift_ = shift;
+			std::copy(q, q + best_order, coefficients_);
+			residual_ = std::move(r);
+			bit_count_ = bits;
+		}
+	}
+
+private:
+	unsigned int block_size_;
+	unsigned int bits_per_sample_;
+	unsigned int wasted_bits_;
+	std::vector<int32_t> samples_;
+	enum type type_;
+	unsigned int order_;
+	unsigned int precision_;
+	int shift_;
+	int32_t coefficients_[max_lpc_order];
+	residual residual_;
+	size_t bit_count_;
+};
+
+unsigned int block_size_code (unsigned int size) {
+	switch (size) {
+	case   192: return  1;
+	case   576: return  2;
+	case  1152: return  3;
+	case  2304: return  4;
+	case  4608: return  5;
+	case   256: return  8;
+	case   512: return  9;
+	case  1024: return 10;
+	case  2048: return 11;
+	case  4096: return 12;
+	case  8192: return 13;
+	case 16384: return 14;
+	case 32768: return 15;
+	}
+	return size <= 256 ? 6 : 7;
+}
+
+unsigned int sample_rate_code (unsigned int rate) {
+	switch (rate) {
+	case  88200: return  1;
+	case 176400: return  2;
+	case 192000: return  3;
+	case   8000: return  4;
+	case  16000: return  5;
+	case  22050: return  6;
+	case  24000: return  7;
+	case  32000: return  8;
+	case  44100: return  9;
+	case  48000: return 10;
+	case  96000: return 11;
+	}
+	return 0;
+}
+
+void write_frame_number (bit_writer &out, uint32_t number) {
+	if (number < 0x80) {
+		out.write(number, 8);
+		return;
+	}
+
+	unsigned int extra = 1;
+	while (extra < 6 && number >= (1u << (5*extra + 6))) {
+		++extra;
+	}
+
+	out.write((0xff00 >> (extra + 1)) | (number >> (6*extra)), 8);
+	while (extra-- > 0) {
+		out.write(0x80 | ((number >> (6*extra)) & 0x3f), 8);
+	}
+}
+
+std::vector<unsigned char> write_frame (
+		const sequence &seq,
+		uint32_t frame_number,
+		const encoder_settings &settings) {
+	const unsigned int channel_count = seq.format().channel_count();
+	const format::size_type first = format::size_type(frame_number)*block_size;
+	const unsigned int size =
+		std::min<format::size_type>(block_size, seq.frame_count() - first);
+
+	std::vector<std::vector<int32_t>> channels(channel_count, std::vector<int32_t>(size));
+	const float *pcm = seq.data(first);
+
+	for (unsigned int i = 0; i < size; ++i) {
+		for (unsigned int c = 0; c < channel_count; ++c) {
+			channels[c][i] = sample_to_value<int16_t>(*pcm++);
+		}
+	}
+
+	std::vector<subframe> subframes;
+	unsigned int assignment = channel_count - 1;
+
+	for (unsigned int c = 0; c < channel_count; ++c) {
+		subframes.emplace_back(channels[c].data(), size, bits_per_sample, settings);
+	}
+
+	if (channel_count == 2) {
+		std::vector<int32_t> mid(size), side(size);
+		for (unsigned int i = 0; i < size; ++i) {
+			mid[i] = (channels[0][i] + channels[1][i]) >> 1;
+			side[i] = channels[0][i] - channels[1][i];
+		}
+
+		subframe m(mid.data(), size, bits_per_sample, settings);
+		subframe s(side.data(), size, bits_per_sample + 1, settings);
+
+		size_t independent = subframes[0].bit_count() + subframes[1].bit_count();
+		size_t left_side = subframes[0].bit_count() + s.bit_count();
+		size_t right_side = s.bit_count() + subframes[1].bit_count();
+		size_t mid_side = m.bit_count() + s.bit_count();
+		size_t best = std::min({ independent, left_side, right_side, mid_side });
+
+		if (best == mid_side) {
+			assignment = MidSide;
+			subframes[0] = std::move(m);
+			subframes[1] = std::move(s);
+		} else if (best == left_side) {
+			assignment = LeftSide;
+			subframes[1] = std::move(s);
+		} else if (best == right_side) {
+			assignment = RightSide;
+			subframes[0] = std::move(s);
+		}
+	}
+
+	bit_writer out;
+	unsigned int rate = seq.format().sample_rate();
+	unsigned int block_code = block_size_code(size);
+	unsigned int rate_code = sample_rate_code(rate);
+
+	out.write(0xfff8, 16);
+	out.write(block_code, 4);
+	out.write(rate_code, 4);
+	out.write(assignment, 4);
+	out.write(4, 3); // 16 bits per sample
+	out.write(0, 1);
+	write_frame_number(out, frame_number);
+	if (block_code == 6) {
+		out.write(size - 1, 8);
+	} else if (block_code == 7) {
+		out.write(size - 1, 16);
+	}
+	out.write(crc8(out.data().data(), out.data().size()), 8);
+
+	for (const subframe &s: subframes) {
+		s.write(out);
+	}
+
+	out.align();
+	out.write(crc16(out.data().data(), out.data().size()), 16);
+
+	return out.release();
+}
+
+void write_stream_info (std::ostream &output, const sequence &seq) {
+	const format &fmt = seq.format();
+	uint64_t sample_count = seq.frame_count();
+	bit_writer out;
+
+	out.write(0x80, 8); // last metadata block, STREAMINFO
+	out.write(stream_info_size, 24);
+	out.write(block_size, 16);
+	out.write(block_size, 16);
+	out.write(0, 24); // minimum and maximum frame sizes are unknown
+	out.write(0, 24);
+	out.write(fmt.sample_rate(), 20);
+	out.write(fmt.channel_count() - 1, 3);
+	out.write(bits_per_sample - 1, 5);
+	out.write(sample_count >> 32, 4);
+	out.write(sample_count & 0xffffffff, 32);
+	for (int i = 0; i < 4; ++i) {
+		out.write(0, 32); // MD5 signature is not computed
+	}
+
+	output.write(reinterpret_cast<const char *>(stream_marker), 4);
+	output.write(reinterpret_cast<const char *>(out.data().data()), out.data().size());
+}
+
+void write (
+		std::ostream &output,
+		const sequence &seq,
+		const encoder_options &options,
+		unsigned int thread_count) {
+	if (seq.format().channel_count() > max_channel_count) {
+		error::raise(error::FormatUnhandledChannelCountValueError);
+	}
+
+	encoder_settings settings(options);
+	size_t frame_count = (seq.frame_count() + block_size - 1)/block_size;
+	size_t batch_size = frames_per_thread*thread_count;
+	std::vector<std::vector<unsigned char>> frames(std::min(frame_count, batch_size));
+
+	write_stream_info(output, seq);
+
+	for (size_t batch = 0; batch < frame_count; batch += batch_size) {
+		size_t count = std::min(batch_size, frame_count - batch);
+
+		utils::parallel_for(count, thread_count, [&](size_t i) {
+			frames[i] = write_frame(seq, batch + i, settings);
+		});
+
+		for (size_t i = 0; i < count; ++i) {
+			output.write(reinterpret_cast<const char *>(frames[i].data()), frames[i].size());
+		}
+	}
+}
+} /* namespace flac_ */
+
+FLAC_coder::FLAC_coder (const encoder_options &options) :
+	options_(options) {
+}
+
+void FLAC_coder::encode_ (std::ostream &output, const sequence &seq) const {
+	flac_::write(output, seq, options_, utils::thread_count(options_.thread_count));
+}
@@ -0,0 +1,40 @@
+/// audio_flac_coder.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_FLAC_CODER_H_
+#define AUDIO_FLAC_CODER_H_
+
+#include <audio/codecs/coder>
+#include <audio/codecs/encoder_options>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+class sequence;
+namespace codec {
+class FLAC_coder : public coder {
+public:
+	/// Constructs a `FLAC_coder`. Samples are quantified on 16 bits, as
+	/// with `WAVE_coder`, and then losslessly compressed.
+	///
+	/// *Parameters:*
+	/// - `options`
+	///   The encoder settings. `quality` sets the highest order of the
+	///   linear predictors tried, from 4 to 12. `fast` restricts the
+	///   coder to the fixed predictors. With more than one thread, the
+	///   frames are encoded concurrently, the stream is the same as with
+	///   a single thread. Bitrate and channel settings are ignored.
+	explicit FLAC_coder (const encoder_options &options = encoder_options());
+
+protected:
+	virtual void encode_ (std::ostream &, const sequence &) const;
+
+private:
+	encoder_options options_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_FLAC_CODER_H_ */
@@ -0,0 +1,46 @@
+/// audio_flac_decoder.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_FLAC_DECODER_H_
+#define AUDIO_FLAC_DECODER_H_
+
+#include <audio/codecs/decoder>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+class sequence;
+namespace codec {
+class FLAC_decoder : public decoder {
+public:
+	/// Constructs a `FLAC_decoder`.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads used to decode a stream. With more than
+	///   one thread, long streams are split at frame boundaries into
+	///   segments decoded concurrently. The decoded `sequence` is the
+	///   same as with a single thread. A count of 0 stands for the count
+	///   of hardware threads.
+	explicit FLAC_decoder (unsigned int thread_count = 1);
+
+public:
+	/// Returns `true` if the given first bytes of a stream are the ones
+	/// of a FLAC stream.
+	static bool sniff (const unsigned char *data, size_t size) noexcept;
+
+protected:
+	virtual sequence decode_ (std::istream &) const;
+	virtual void decode_file_into_ (const std::string &, sequence &) const;
+	virtual void decode_source_into_ (utils::byte_source &, sequence &) const;
+	virtual info probe_ (std::istream &) const;
+
+private:
+	unsigned int thread_count_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_FLAC_DECODER_H_ */
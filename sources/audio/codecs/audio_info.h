@@ -0,0 +1,40 @@
+/// audio_info.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_INFO_H_
+#define AUDIO_INFO_H_
+
+#include <audio/format>
+
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// struct com::nealrame::audio::codec::info
+/// ========================================
+/// Properties of an encoded stream, as read from its headers.
+struct info {
+	/// Name of the codec of the stream.
+	std::string codec;
+
+	/// Audio format of the stream.
+	class format format;
+
+	/// Count of audio frames of the stream.
+	format::size_type frame_count;
+
+	/// Average bitrate of the stream in bits per second.
+	unsigned int bitrate;
+
+	/// Returns the duration of the stream.
+	double duration () const noexcept
+	{ return format.duration(frame_count); }
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_INFO_H_ */
@@ -2,6 +2,7 @@
 /// Created on: April 26, 2014
 ///     Author: [NealRame](mailto:contact@nealrame.com)
 
+#include "audio_backend.h"
 #include "audio_mp3_coder.h"
 #include "audio_mp3_decoder.h"
 
@@ -9,10 +10,19 @@
 #include "../audio_format.h"
 
 #include "../../utils/utils_buffer.h"
+#include "../../utils/utils_byte_source.h"
+#include "../../utils/utils_memory_stream.h"
+#include "../../utils/utils_parallel.h"
 
 #include <algorithm>
+#include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <functional>
+#include <sstream>
+#include <type_traits>
+#include <vector>
 
 extern "C" {
 #	include <mpg123.h>
@@ -22,6 +32,7 @@ extern "C" {
 using namespace com::nealrame;
 using namespace com::nealrame::audio;
 using com::nealrame::audio::codec::MP3_coder;
+using com::nealrame::audio::codec::encoder_options;
 using com::nealrame::audio::codec::MP3_decoder;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -30,13 +41,117 @@ using com::nealrame::audio::codec::MP3_decoder;
 
 namespace mp3_ {
 
+// mpg123 and LAME are loaded the first time they are used. The calls made
+// in this namespace go through the functions below, which hide the ones of
+// the libraries headers.
+const codec::backend libmpg123 {
+	"libmpg123.so.0", "libmpg123.0.dylib", "libmpg123.so", "libmpg123.dylib"
+};
+
+const codec::backend libmp3lame {
+	"libmp3lame.so.0", "libmp3lame.0.dylib", "libmp3lame.so", "libmp3lame.dylib"
+};
+
+#define BACKEND_STRINGIFY_(name) #name
+#define BACKEND_STRINGIFY(name) BACKEND_STRINGIFY_(name)
+#define BACKEND_FUNCTION(library, name) \
+	const codec::backend::function<decltype(&::name)> name( \
+		library, BACKEND_STRINGIFY(name))
+
+BACKEND_FUNCTION(libmpg123, mpg123_close);
+BACKEND_FUNCTION(libmpg123, mpg123_decode_frame);
+BACKEND_FUNCTION(libmpg123, mpg123_delete);
+BACKEND_FUNCTION(libmpg123, mpg123_exit);
+BACKEND_FUNCTION(libmpg123, mpg123_feed);
+BACKEND_FUNCTION(libmpg123, mpg123_feedseek);
+BACKEND_FUNCTION(libmpg123, mpg123_format);
+BACKEND_FUNCTION(libmpg123, mpg123_format_all);
+BACKEND_FUNCTION(libmpg123, mpg123_format_none);
+BACKEND_FUNCTION(libmpg123, mpg123_framebyframe_next);
+BACKEND_FUNCTION(libmpg123, mpg123_getformat);
+BACKEND_FUNCTION(libmpg123, mpg123_getparam);
+BACKEND_FUNCTION(libmpg123, mpg123_index);
+BACKEND_FUNCTION(libmpg123, mpg123_info);
+BACKEND_FUNCTION(libmpg123, mpg123_init);
+BACKEND_FUNCTION(libmpg123, mpg123_length);
+BACKEND_FUNCTION(libmpg123, mpg123_new);
+BACKEND_FUNCTION(libmpg123, mpg123_open);
+BACKEND_FUNCTION(libmpg123, mpg123_open_feed);
+BACKEND_FUNCTION(libmpg123, mpg123_outblock);
+BACKEND_FUNCTION(libmpg123, mpg123_param);
+BACKEND_FUNCTION(libmpg123, mpg123_plain_strerror);
+BACKEND_FUNCTION(libmpg123, mpg123_read);
+BACKEND_FUNCTION(libmpg123, mpg123_replace_buffer);
+BACKEND_FUNCTION(libmpg123, mpg123_scan);
+BACKEND_FUNCTION(libmpg123, mpg123_set_filesize);
+BACKEND_FUNCTION(libmpg123, mpg123_set_index);
+BACKEND_FUNCTION(libmpg123, mpg123_spf);
+BACKEND_FUNCTION(libmpg123, mpg123_strerror);
+BACKEND_FUNCTION(libmpg123, mpg123_tellframe);
+
+BACKEND_FUNCTION(libmp3lame, lame_close);
+BACKEND_FUNCTION(libmp3lame, lame_encode_buffer_interleaved_ieee_float);
+BACKEND_FUNCTION(libmp3lame, lame_encode_flush);
+BACKEND_FUNCTION(libmp3lame, lame_get_ATHtype);
+BACKEND_FUNCTION(libmp3lame, lame_get_VBR);
+BACKEND_FUNCTION(libmp3lame, lame_get_VBR_mean_bitrate_kbps);
+BACKEND_FUNCTION(libmp3lame, lame_get_VBR_min_bitrate_kbps);
+BACKEND_FUNCTION(libmp3lame, lame_get_VBR_q);
+BACKEND_FUNCTION(libmp3lame, lame_get_brate);
+BACKEND_FUNCTION(libmp3lame, lame_get_encoder_delay);
+BACKEND_FUNCTION(libmp3lame, lame_get_framesize);
+BACKEND_FUNCTION(libmp3lame, lame_get_lowpassfreq);
+BACKEND_FUNCTION(libmp3lame, lame_get_quality);
+BACKEND_FUNCTION(libmp3lame, lame_init);
+BACKEND_FUNCTION(libmp3lame, lame_init_params);
+BACKEND_FUNCTION(libmp3lame, lame_set_VBR);
+BACKEND_FUNCTION(libmp3lame, lame_set_VBR_mean_bitrate_kbps);
+BACKEND_FUNCTION(libmp3lame, lame_set_VBR_quality);
+BACKEND_FUNCTION(libmp3lame, lame_set_bWriteVbrTag);
+BACKEND_FUNCTION(libmp3lame, lame_set_brate);
+BACKEND_FUNCTION(libmp3lame, lame_set_debugf);
+BACKEND_FUNCTION(libmp3lame, lame_set_disable_reservoir);
+BACKEND_FUNCTION(libmp3lame, lame_set_errorf);
+BACKEND_FUNCTION(libmp3lame, lame_set_in_samplerate);
+BACKEND_FUNCTION(libmp3lame, lame_set_mode);
+BACKEND_FUNCTION(libmp3lame, lame_set_msgf);
+BACKEND_FUNCTION(libmp3lame, lame_set_num_channels);
+BACKEND_FUNCTION(libmp3lame, lame_set_quality);
+BACKEND_FUNCTION(libmp3lame, get_lame_short_version);
+
+#undef BACKEND_FUNCTION
+#undef BACKEND_STRINGIFY
+#undef BACKEND_STRINGIFY_
+
 class mpg123_lib {
+	// Released handles are kept by the thread which released them, up to
+	// this count.
+	static const size_t handle_pool_size_ = 8;
+
+	// Idle handles of a thread.
+	struct handle_pool {
+		std::vector<mpg123_handle *> handles;
+
+		~handle_pool () {
+			for (mpg123_handle *hdl: handles) {
+				mpg123_delete(hdl);
+			}
+		}
+	};
+
 	mpg123_lib () {
+		libmpg123.require(error::DecoderNotFound);
+
 		int error_code;
 		if ((error_code = mpg123_init()) != MPG123_OK) {
 			error::raise(error::CodecUnexpectedError,
 					mpg123_plain_strerror(error_code));
 		}
+
+		mpg123_handle *hdl = new_handle_();
+		double value;
+		mpg123_getparam(hdl, MPG123_PREFRAMES, &preframes_, &value);
+		mpg123_delete(hdl);
 	}
 
 public:
@@ -59,29 +174,45 @@ public:
 public:
 	typedef std::unique_ptr<void, std::function<void (void *)>> handle;
 
+	// Returns a handle ready to be fed. Handles are taken from the pool
+	// of the calling thread when possible, so that decoding many short
+	// streams does not set up a decoder each time.
 	handle get_handle () {
 		int error_code;
-		mpg123_handle * hdl;
-
-		if ((hdl = mpg123_new(nullptr, &error_code)) == nullptr) {
-			error::raise(error::CodecUnexpectedError,
-					mpg123_plain_strerror(error_code));
-		}
-
-		mpg123_param(hdl, MPG123_ADD_FLAGS, MPG123_FORCE_FLOAT, 0.);
+		mpg123_handle *hdl = acquire_handle_();
 
+		// closing then opening a handle drops its previous stream
 		if ((error_code = mpg123_open_feed(hdl)) != MPG123_OK) {
+			mpg123_delete(hdl);
 			error::raise(error::CodecUnexpectedError,
 					mpg123_plain_strerror(error_code));
 		}
 
 		return handle(hdl, [](void *h) {
+			release_handle_(reinterpret_cast<mpg123_handle *>(h));
+		});
+	}
+
+	// Returns a handle reading the given file by itself.
+	handle get_handle (const std::string &filepath) {
+		int error_code;
+		mpg123_handle *hdl = acquire_handle_();
+
+		// decoding frames in place replaces the handle own output
+		// buffer for good, such a handle can not be pooled
+		handle h(hdl, [](void *h) {
 			mpg123_close(reinterpret_cast<mpg123_handle *>(h));
 			mpg123_delete(reinterpret_cast<mpg123_handle *>(h));
 		});
+
+		if ((error_code = mpg123_open(hdl, filepath.c_str())) != MPG123_OK) {
+			error::raise(error::IOError, std::string(mpg123_strerror(hdl)));
+		}
+
+		return h;
 	}
 
-	void feed (handle &h, unsigned char *data, size_t size) {
+	void feed (handle &h, const unsigned char *data, size_t size) {
 		int error_code;
 		if ((error_code = mpg123_feed(
 			reinterpret_cast<mpg123_handle *>(h.get()), data, size)) < 0) {
@@ -140,13 +271,285 @@ public:
 
 		return done;
 	}
+
+	// Returns the size in bytes of the largest decoded MPEG frame.
+	size_t outblock (handle &h) {
+		return mpg123_outblock(reinterpret_cast<mpg123_handle *>(h.get()));
+	}
+
+	// Returns the exact count of frames of the stream of a handle
+	// reading a file, or 0 if it is unknown. mpg123 reads the Xing/Info
+	// header along with the format, the file is scanned only if `scan` is
+	// set, which is needed only when the stream has no such header.
+	format::size_type length (handle &h, bool scan) {
+		mpg123_handle *hdl = reinterpret_cast<mpg123_handle *>(h.get());
+
+		if (scan && mpg123_scan(hdl) != MPG123_OK) {
+			return 0;
+		}
+
+		return std::max<off_t>(mpg123_length(hdl), 0);
+	}
+
+	// Returns the count of frames of the stream of a handle fed with
+	// bytes, given by its Xing header or estimated from the given size in
+	// bytes of the stream, or 0 if it is unknown. The format of the stream
+	// must have been read.
+	format::size_type feed_length (handle &h, size_t size) {
+		mpg123_handle *hdl = reinterpret_cast<mpg123_handle *>(h.get());
+
+		if (size > 0) {
+			mpg123_set_filesize(hdl, size);
+		}
+
+		return std::max<off_t>(mpg123_length(hdl), 0);
+	}
+
+	// Decodes the next MPEG frame of a handle reading a file straight
+	// into the given buffer, which must hold at least `outblock` bytes.
+	// Returns `false` at the end of the stream.
+	bool decode_frame (handle &h, float *output, size_t size, size_t &bytes) {
+		mpg123_handle *hdl = reinterpret_cast<mpg123_handle *>(h.get());
+
+		unsigned char *data = reinterpret_cast<unsigned char *>(output);
+		unsigned char *audio;
+		off_t frame;
+		int error_code;
+
+		mpg123_replace_buffer(hdl, data, size);
+
+		do {
+			error_code = mpg123_decode_frame(hdl, &frame, &audio, &bytes);
+		} while (error_code == MPG123_NEW_FORMAT);
+
+		if (error_code == MPG123_DONE) {
+			return false;
+		}
+
+		if (error_code != MPG123_OK) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(error_code));
+		}
+
+		if (bytes > 0 && audio != data) {
+			memmove(data, audio, bytes);
+		}
+
+		return true;
+	}
+
+	// Parses the next MPEG frame without decoding it. Returns `false`
+	// if more data must be fed to the handle.
+	bool next_frame (handle &h) {
+		int error_code = mpg123_framebyframe_next(
+			reinterpret_cast<mpg123_handle *>(h.get())
+		);
+
+		if (error_code == MPG123_NEED_MORE) {
+			return false;
+		}
+
+		if (! (error_code == MPG123_OK
+			|| error_code == MPG123_NEW_FORMAT)) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(error_code));
+		}
+
+		return true;
+	}
+
+	MP3_decoder::frame_index get_index (handle &h, uint64_t mpeg_frame_count) {
+		mpg123_handle *hdl = reinterpret_cast<mpg123_handle *>(h.get());
+
+		off_t *offsets, step;
+		size_t fill;
+		int error_code;
+
+		if ((error_code = mpg123_index(hdl, &offsets, &step, &fill))
+			!= MPG123_OK) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(error_code));
+		}
+
+		// mpg123 knows the exact (gapless) length only if the stream
+		// has a Xing/Info header, otherwise each MPEG frame gives
+		// exactly one frame size worth of audio frames.
+		off_t length = mpg123_length(hdl);
+		if (length <= 0) {
+			length = mpeg_frame_count*mpg123_spf(hdl);
+		}
+
+		return MP3_decoder::frame_index(
+			std::vector<int64_t>(offsets, offsets + fill),
+			step, length
+		);
+	}
+
+	void set_index (handle &h, const MP3_decoder::frame_index &index) {
+		std::vector<off_t> offsets(
+			index.offsets().begin(), index.offsets().end()
+		);
+
+		int error_code;
+
+		if ((error_code = mpg123_set_index(
+			reinterpret_cast<mpg123_handle *>(h.get()),
+			offsets.data(), index.step(), offsets.size()))
+			!= MPG123_OK) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(error_code));
+		}
+	}
+
+	void set_preframes (handle &h, long count) {
+		mpg123_param(
+			reinterpret_cast<mpg123_handle *>(h.get()),
+			MPG123_PREFRAMES, count, 0.
+		);
+	}
+
+	// Returns the MPEG layer of the stream of a handle, 0 if it is
+	// unknown. The format of the stream must have been read.
+	int layer (handle &h) {
+		struct mpg123_frameinfo info;
+		if (mpg123_info(reinterpret_cast<mpg123_handle *>(h.get()), &info)
+				!= MPG123_OK) {
+			return 0;
+		}
+		return info.layer;
+	}
+
+	// Returns the MPEG frame holding the target of the last seek of a
+	// handle, as long as no frame has been decoded since.
+	off_t tellframe (handle &h) {
+		return mpg123_tellframe(reinterpret_cast<mpg123_handle *>(h.get()));
+	}
+
+	// Prepares the handle to decode from the given frame and returns the
+	// offset of the input byte to be fed next.
+	off_t feedseek (handle &h, format::size_type frame) {
+		off_t input_offset;
+		off_t res = mpg123_feedseek(
+			reinterpret_cast<mpg123_handle *>(h.get()),
+			frame, SEEK_SET, &input_offset
+		);
+
+		if (res < 0) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(res));
+		}
+
+		return input_offset;
+	}
+
+private:
+	mpg123_handle * acquire_handle_ () {
+		handle_pool &pool = handle_pool_();
+
+		if (pool.handles.empty()) {
+			return new_handle_();
+		}
+
+		mpg123_handle *hdl = pool.handles.back();
+		pool.handles.pop_back();
+
+		// restore the settings changed by a previous stream
+		mpg123_format_all(hdl);
+		mpg123_param(hdl, MPG123_PREFRAMES, preframes_, 0.);
+
+		return hdl;
+	}
+
+	static handle_pool & handle_pool_ () {
+		thread_local handle_pool pool;
+		return pool;
+	}
+
+	static mpg123_handle * new_handle_ () {
+		int error_code;
+		mpg123_handle *hdl;
+
+		if ((hdl = mpg123_new(nullptr, &error_code)) == nullptr) {
+			error::raise(error::CodecUnexpectedError,
+					mpg123_plain_strerror(error_code));
+		}
+
+		mpg123_param(hdl, MPG123_ADD_FLAGS, MPG123_FORCE_FLOAT, 0.);
+		// let the frame index grow as needed so that it covers the
+		// whole stream
+		mpg123_param(hdl, MPG123_INDEX_SIZE, -1, 0.);
+
+		return hdl;
+	}
+
+	static void release_handle_ (mpg123_handle *hdl) {
+		handle_pool &pool = handle_pool_();
+
+		mpg123_close(hdl);
+		if (pool.handles.size() < handle_pool_size_) {
+			pool.handles.push_back(hdl);
+		} else {
+			mpg123_delete(hdl);
+		}
+	}
+
+private:
+	long preframes_;
 };
 
+// Feeds the remaining of the input to the given handle, parsing but not
+// decoding the MPEG frames. Returns the count of parsed frames.
+uint64_t parse_frames (
+		mpg123_lib::handle &handle,
+		std::istream &input,
+		uint64_t *byte_count = nullptr,
+		size_t buffer_size = 8192) {
+	mpg123_lib &lib = mpg123_lib::instance();
+	utils::buffer buffer(buffer_size);
+	uint64_t mpeg_frame_count = 0;
+
+	while (input.good()) {
+		input.read(buffer.data<char>(), buffer.size());
+		if (input.gcount() > 0) {
+			lib.feed(handle, buffer.data<unsigned char>(), input.gcount());
+			if (byte_count != nullptr) {
+				*byte_count += input.gcount();
+			}
+		}
+		while (lib.next_frame(handle)) {
+			++mpeg_frame_count;
+		}
+	}
+
+	return mpeg_frame_count;
+}
+
+MP3_decoder::frame_index scan (std::istream &input) {
+	mpg123_lib &lib = mpg123_lib::instance();
+	mpg123_lib::handle handle = lib.get_handle();
+
+	std::streampos origin = input.tellg();
+	if (origin < 0) {
+		error::raise_literal(error::IOError, "input stream is not seekable");
+	}
+
+	uint64_t mpeg_frame_count = parse_frames(handle, input);
+	MP3_decoder::frame_index index = lib.get_index(handle, mpeg_frame_count);
+
+	input.clear();
+	input.seekg(origin);
+
+	return index;
+}
+
+// Decodes a byte source, fed to mpg123 by spans.
 class input_stream {
 	mpg123_lib::handle handle_;
 
-	utils::buffer input_buffer_;
-	std::istream &input_;
+	// set if the stream reads a `std::istream`
+	std::unique_ptr<utils::stream_source> stream_source_;
+	utils::byte_source &input_;
+	size_t read_size_;
 
 	utils::buffer output_buffer_;
 	format::size_type output_frame_count_;
@@ -154,6 +557,9 @@ class input_stream {
 
 	std::unique_ptr<format> format_;
 
+	size_t origin_;
+	bool drained_;
+
 private:
 	format::size_type available_frames_ () const {
 		return std::max<format::size_type>(
@@ -167,14 +573,14 @@ private:
 	}
 
 	void feed_ (mpg123_lib &lib) {
-		input_.read(input_buffer_.data<char>(), input_buffer_.size());
-		lib.feed(handle_, input_buffer_.data<unsigned char>(), input_.gcount());
+		utils::byte_source::span span = input_.read(read_size_);
+		lib.feed(handle_, span.data, span.size);
 	}
 
 	void read_format_ (mpg123_lib &lib) {
 		while (! (format_ = lib.get_format(handle_))) {
 			if (input_.eof()) {
-				error::raise(error::CodecUnexpectedError,
+				error::raise_literal(error::CodecUnexpectedError,
 						"end of input stream");
 			}
 			feed_(lib);
@@ -189,8 +595,13 @@ private:
 
 			size_t size = 0;
 
-			while (input_.good()
-				&& (size = lib.read(handle_, output_buffer_)) == 0) {
+			// at the end of the input, frames may still be buffered
+			// by mpg123
+			while ((size = lib.read(handle_, output_buffer_)) == 0) {
+				if (input_.eof()) {
+					drained_ = true;
+					break;
+				}
 				feed_(lib);
 			}
 
@@ -200,16 +611,29 @@ private:
 	}
 
 public:
-	input_stream (std::istream &stream, size_t input_buffer_size = 8192) :
+	input_stream (std::istream &stream, size_t read_size = 8192) :
 		handle_(mpg123_lib::instance().get_handle()),
-		input_buffer_(input_buffer_size),
-		input_(stream),
+		stream_source_(new utils::stream_source(stream, read_size)),
+		input_(*stream_source_),
+		read_size_(read_size),
 		output_frame_count_(0),
-		output_frame_index_(0) {
+		output_frame_index_(0),
+		origin_(input_.tell()),
+		drained_(false) {
+	}
+
+	input_stream (utils::byte_source &source, size_t read_size = 65536) :
+		handle_(mpg123_lib::instance().get_handle()),
+		input_(source),
+		read_size_(read_size),
+		output_frame_count_(0),
+		output_frame_index_(0),
+		origin_(input_.tell()),
+		drained_(false) {
 	}
 
 	bool eof () const {
-		return input_.eof() && available_frames_() == 0;
+		return drained_ && available_frames_() == 0;
 	}
 
 	format & get_format () {
@@ -221,7 +645,7 @@ public:
 
 	format::size_type read (sequence &seq, format::size_type frame_count) {
 		if (seq.format() != get_format()) {
-			error::raise(error::FormatMismatchedError, 
+			error::raise_literal(error::FormatMismatchedError, 
 					"format of provided sequence does not match");
 		}
 
@@ -243,23 +667,858 @@ public:
 		return frame_count - remaining_frame;
 	}
 
+	// Reads at most the given count of frames into the given interleaved
+	// buffer. Returns the count of frames actually read.
+	format::size_type read (float *pcm, format::size_type frame_count) {
+		mpg123_lib &lib = mpg123_lib::instance();
+
+		format::size_type remaining_frame = frame_count;
+
+		while (! eof() && remaining_frame > 0) {
+			read_(lib);
+
+			format::size_type count =
+				std::min(remaining_frame, available_frames_());
+			format::size_type sample_count =
+				count*format_->channel_count();
+
+			pcm = std::copy(frames_(), frames_() + sample_count, pcm);
+			remaining_frame -= count;
+			output_frame_index_ += count;
+		}
+
+		return frame_count - remaining_frame;
+	}
+
+	// Sets the count of MPEG frames decoded and dropped before the target
+	// of a seek.
+	void set_preframes (long count) {
+		mpg123_lib::instance().set_preframes(handle_, count);
+	}
+
+	// Returns the MPEG layer of this stream.
+	int layer () {
+		get_format();
+		return mpg123_lib::instance().layer(handle_);
+	}
+
+	// Moves this stream to the given frame as `seek` does, decoding at
+	// least `preframes` MPEG frames before the one holding it. The first
+	// decoded MPEG frame is a multiple of `period` frames from the start
+	// of the stream. Layer III streams only, mpg123 decodes at most 2
+	// preframes of other layers.
+	void seek_aligned (
+			format::size_type frame,
+			const MP3_decoder::frame_index &index,
+			long preframes,
+			long period) {
+		set_preframes(preframes);
+		seek(frame, index);
+
+		const off_t first = mpg123_lib::instance().tellframe(handle_) - preframes;
+		if (first > 0 && first % period != 0) {
+			set_preframes(preframes + first % period);
+			seek(frame, index);
+		}
+	}
+
+	// Moves this stream to the given frame. The underlying input stream
+	// must be seekable. If the given index is not empty, mpg123 uses it
+	// to find the bytes holding the frame instead of parsing the stream
+	// up to it.
+	void seek (format::size_type frame, const MP3_decoder::frame_index &index) {
+		mpg123_lib &lib = mpg123_lib::instance();
+
+		if (! input_.seekable()) {
+			error::raise_literal(error::IOError, "input stream is not seekable");
+		}
+
+		if (! format_) {
+			read_format_(lib);
+		}
+
+		if (! index.empty()) {
+			lib.set_index(handle_, index);
+		}
+
+		off_t offset = lib.feedseek(handle_, frame);
+
+		if (! input_.seek(origin_ + offset)) {
+			error::raise_literal(error::IOError, "failed to seek input stream");
+		}
+
+		output_frame_count_ = 0;
+		output_frame_index_ = 0;
+		drained_ = false;
+	}
+
+	// Reads all the frames of this stream into the given sequence, which
+	// must be empty and of the format of the stream. Its capacity is set
+	// once from the length of the stream, if known.
+	void read_all (sequence &seq) {
+		mpg123_lib &lib = mpg123_lib::instance();
+		const size_t size = input_.size();
+
+		get_format();
+		seq.reserve(lib.feed_length(handle_,
+			size != utils::byte_source::unknown_size ? size - origin_ : 0));
+
+		while (read(seq, 1024) > 0);
+	}
+
 	sequence read_all () {
 		sequence seq(get_format());
-		format::size_type n;
-		do {
-			n = read(seq, 1024);
-		} while (n > 0);
+		read_all(seq);
 		return seq;
 	}
 };
+
+sequence read_range (
+		std::istream &input,
+		const MP3_decoder::frame_index &index,
+		format::size_type first_frame,
+		format::size_type frame_count) {
+	input_stream mp3_istream(input);
+	mp3_istream.seek(first_frame, index);
+
+	sequence seq(mp3_istream.get_format());
+	mp3_istream.read(seq, frame_count);
+
+	return seq;
+}
+
+// Under this count of frames per segment, splitting a stream costs more
+// than decoding it serially.
+const format::size_type min_segment_frame_count = 1 << 20;
+
+// Count of MPEG frames decoded and dropped before the first frame of a
+// segment, enough to refill the bit reservoir, the IMDCT overlap and the
+// synthesis filter bank.
+const long segment_preframes = 8;
+
+// mpg123 restarts the ring of its synthesis filter bank at the same offset
+// on each seek, and moves it by 36 (MPEG 1) or 18 (MPEG 2) steps modulo 16
+// for each MPEG frame. A segment whose first decoded frame is a multiple of
+// this count of frames from the start of the stream sums the filter taps
+// in the same order as the serial decode does, so that its samples are
+// identical and not only close.
+const long segment_alignment = 16;
+
+// Decodes the given compressed bytes into the given sequence, whose format
+// and frames are replaced, splitting them in segments decoded concurrently
+// straight into the sequence.
+void read_all_parallel (
+		const unsigned char *data,
+		size_t size,
+		unsigned int thread_count,
+		sequence &seq) {
+	utils::memory_istream stream(data, size);
+	MP3_decoder::frame_index index = scan(stream);
+
+	size_t segment_count = std::min<format::size_type>(
+		thread_count, index.frame_count()/min_segment_frame_count
+	);
+
+	if (segment_count < 2) {
+		input_stream serial(stream);
+		seq.reset(serial.get_format());
+		serial.read_all(seq);
+		return;
+	}
+
+	input_stream head(stream);
+	const format fmt = head.get_format();
+
+	seq.reset(fmt);
+
+	// the segments of other layers can not be aligned
+	if (head.layer() != 3) {
+		utils::memory_istream serial_stream(data, size);
+		input_stream(serial_stream).read_all(seq);
+		return;
+	}
+
+	std::vector<format::size_type> bounds(segment_count + 1);
+	for (size_t i = 0; i <= segment_count; ++i) {
+		bounds[i] = index.frame_count()*i/segment_count;
+	}
+
+	// the last segment is decoded up to the end of the stream, which
+	// may differ from the length given by the index
+	seq.set_frame_count(index.frame_count());
+	sequence tail(fmt);
+
+	utils::parallel_for(segment_count, thread_count, [&](size_t i) {
+		utils::memory_istream segment_stream(data, size);
+		input_stream mp3_istream(segment_stream);
+
+		if (bounds[i] > 0) {
+			mp3_istream.seek_aligned(
+				bounds[i], index, segment_preframes, segment_alignment);
+		}
+
+		if (i + 1 < segment_count) {
+			format::size_type frame_count = bounds[i + 1] - bounds[i];
+			if (mp3_istream.read(seq.data(bounds[i]), frame_count) != frame_count) {
+				error::raise_literal(error::CodecUnexpectedError,
+						"unexpected end of MP3 segment");
+			}
+		} else {
+			while (mp3_istream.read(tail, 65536) > 0);
+		}
+	});
+
+	seq.set_frame_count(bounds[segment_count - 1]);
+	seq.append(tail);
+}
+
+// Same as above, but returns a new sequence.
+sequence read_all_parallel (
+		const unsigned char *data,
+		size_t size,
+		unsigned int thread_count) {
+	utils::memory_istream stream(data, size);
+	sequence seq(input_stream(stream).get_format());
+
+	read_all_parallel(data, size, thread_count, seq);
+
+	return seq;
+}
+
+// Same as above, but the given stream is first copied to memory, each
+// segment reading it from there.
+sequence read_all_parallel (std::istream &input, unsigned int thread_count) {
+	utils::buffer data = utils::read(input);
+	return read_all_parallel(
+			data.data<unsigned char>(), data.size(), thread_count);
+}
+
+// Decodes the given source into the given sequence, whose format and
+// frames are replaced, splitting it in segments decoded concurrently.
+// Sources which are not in memory are copied there first.
+void read_all_parallel (
+		utils::byte_source &source,
+		unsigned int thread_count,
+		sequence &seq) {
+	if (source.data() == nullptr) {
+		utils::source_streambuf buffer(source);
+		std::istream input(&buffer);
+		utils::buffer data = utils::read(input);
+		read_all_parallel(
+				data.data<unsigned char>(), data.size(), thread_count, seq);
+		return;
+	}
+
+	size_t offset = source.tell();
+	source.seek(source.size());
+	read_all_parallel(
+			source.data() + offset, source.size() - offset, thread_count, seq);
+}
+
+// Opens the given file to be read by mpg123 by itself and reads its
+// format.
+mpg123_lib::handle open_file (
+		const std::string &filepath,
+		std::unique_ptr<format> &fmt) {
+	mpg123_lib::handle handle = mpg123_lib::instance().get_handle(filepath);
+
+	fmt = mpg123_lib::instance().get_format(handle);
+
+	if (! fmt) {
+		error::raise_literal(error::CodecFormatError, "no MPEG audio frame found");
+	}
+
+	return handle;
+}
+
+// Returns `true` if the first frame of the given MPEG file has a Xing/Info
+// or VBRI header giving its exact count of frames.
+bool has_vbr_header (const std::string &filepath);
+
+// Decodes the given file, opened with the given handle, into the given
+// sequence, which must be empty and of the format of the stream. Each MPEG
+// frame is decoded straight into the sequence, which is sized once from the
+// exact length of the stream, given by its Xing/Info header if it has one or
+// else by scanning the file.
+void read_file (
+		const std::string &filepath,
+		mpg123_lib::handle &handle,
+		sequence &seq) {
+	mpg123_lib &lib = mpg123_lib::instance();
+
+	const size_t frame_bytes = seq.format().channel_count()*sizeof(float);
+	const format::size_type outblock_frame_count =
+		lib.outblock(handle)/frame_bytes + 1;
+
+	seq.set_frame_count(
+		lib.length(handle, ! has_vbr_header(filepath)) + outblock_frame_count);
+
+	format::size_type frame_index = 0;
+	size_t bytes;
+
+	while (lib.decode_frame(
+			handle,
+			seq.data(frame_index),
+			(seq.frame_count() - frame_index)*frame_bytes,
+			bytes)) {
+		frame_index += bytes/frame_bytes;
+
+		if (seq.frame_count() - frame_index < outblock_frame_count) {
+			seq.set_frame_count(std::max(
+				2*seq.frame_count(),
+				frame_index + outblock_frame_count
+			));
+		}
+	}
+
+	seq.set_frame_count(frame_index);
+}
+
+// Decodes a file as its frames are read.
+class file_reader : public codec::reader {
+	utils::file_source file_;
+	input_stream stream_;
+	class format format_;
+
+public:
+	explicit file_reader (const std::string &filepath) :
+		file_(filepath),
+		stream_(file_),
+		format_(stream_.get_format()) {
+	}
+
+	virtual const class format & format () const noexcept {
+		return format_;
+	}
+
+	virtual format::size_type read (sequence &seq, format::size_type frame_count) {
+		return stream_.read(seq, frame_count);
+	}
+};
 } /* namespace mp3_ */
 
-sequence MP3_decoder::decode_(std::istream &input) const
-	throw(error) {
+MP3_decoder::MP3_decoder (unsigned int thread_count) :
+	thread_count_(thread_count) {
+}
+
+sequence MP3_decoder::decode_(std::istream &input) const {
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	if (thread_count > 1) {
+		return mp3_::read_all_parallel(input, thread_count);
+	}
+
 	mp3_::input_stream mp3_istream(input);
 	return mp3_istream.read_all();
 }
 
+sequence MP3_decoder::decode_file_ (const std::string &filepath) const {
+	// segments are decoded from memory
+	if (utils::thread_count(thread_count_) > 1) {
+		return decoder::decode_file_(filepath);
+	}
+
+	std::unique_ptr<format> fmt;
+	mp3_::mpg123_lib::handle handle = mp3_::open_file(filepath, fmt);
+
+	sequence seq(*fmt);
+	mp3_::read_file(filepath, handle, seq);
+
+	return seq;
+}
+
+sequence MP3_decoder::decode_source_ (utils::byte_source &source) const {
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	// segments are decoded from memory, sources which are not in memory
+	// are copied first
+	if (thread_count > 1) {
+		if (source.data() == nullptr) {
+			return decoder::decode_source_(source);
+		}
+
+		size_t offset = source.tell();
+		source.seek(source.size());
+		return mp3_::read_all_parallel(
+				source.data() + offset, source.size() - offset, thread_count);
+	}
+
+	mp3_::input_stream mp3_istream(source);
+	return mp3_istream.read_all();
+}
+
+void MP3_decoder::decode_file_into_ (const std::string &filepath, sequence &dst)
+	const {
+	// segments are decoded from the mapped file
+	if (utils::thread_count(thread_count_) > 1) {
+		utils::mapped_source source(filepath);
+
+		if (! source.is_open()) {
+			error::raise(error::IOError, "failed to open " + filepath);
+		}
+
+		decode_source_into_(source, dst);
+		return;
+	}
+
+	std::unique_ptr<format> fmt;
+	mp3_::mpg123_lib::handle handle = mp3_::open_file(filepath, fmt);
+
+	dst.reset(*fmt);
+	mp3_::read_file(filepath, handle, dst);
+}
+
+void MP3_decoder::decode_source_into_ (utils::byte_source &source, sequence &dst)
+	const {
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	if (thread_count > 1) {
+		mp3_::read_all_parallel(source, thread_count, dst);
+		return;
+	}
+
+	mp3_::input_stream mp3_istream(source);
+
+	dst.reset(mp3_istream.get_format());
+	mp3_istream.read_all(dst);
+}
+
+std::unique_ptr<codec::reader> MP3_decoder::open_file_ (
+		const std::string &filepath) const {
+	return std::unique_ptr<reader>(new mp3_::file_reader(filepath));
+}
+
+sequence MP3_decoder::decode_range_ (
+		std::istream &input,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	// Without index, mpg123 parses (but does not decode) the stream up
+	// to the requested frame.
+	return mp3_::read_range(input, frame_index(), first_frame, frame_count);
+}
+
+MP3_decoder::frame_index MP3_decoder::scan (std::istream &input) const {
+	return mp3_::scan(input);
+}
+
+sequence MP3_decoder::decode (
+		std::istream &input,
+		frame_index &index,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	if (index.empty()) {
+		index = scan(input);
+	}
+	return mp3_::read_range(input, index, first_frame, frame_count);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Probe /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace mp3_ {
+
+// MPEG audio frame header.
+// See http://www.mp3-tech.org/programmer/frame_header.html
+struct frame_header {
+	enum version { MPEG_2_5 = 0, MPEG_2 = 2, MPEG_1 = 3 };
+
+	enum version version;
+	unsigned int layer;
+	unsigned int bitrate;
+	unsigned int sample_rate;
+	unsigned int channel_count;
+	unsigned int frame_size;
+	unsigned int length;
+
+	// Parses the 4 bytes header at the given address. Returns `false` if
+	// it is not a valid header.
+	bool parse (const unsigned char *data) {
+		static const unsigned int bitrates[2][3][16] = {
+			{ // MPEG 1
+				{ 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0 },
+				{ 0, 32, 48, 56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 384, 0 },
+				{ 0, 32, 40, 48,  56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 0 },
+			},
+			{ // MPEG 2 & 2.5
+				{ 0, 32, 48, 56,  64,  80,  96, 112, 128, 144, 160, 176, 192, 224, 256, 0 },
+				{ 0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160, 0 },
+				{ 0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160, 0 },
+			}
+		};
+		static const unsigned int sample_rates[4][3] = {
+			{ 11025, 12000,  8000 }, // MPEG 2.5
+			{     0,     0,     0 }, // reserved
+			{ 22050, 24000, 16000 }, // MPEG 2
+			{ 44100, 48000, 32000 }, // MPEG 1
+		};
+
+		if (data[0] != 0xff || (data[1] & 0xe0) != 0xe0) {
+			return false;
+		}
+
+		unsigned int version_bits = (data[1] >> 3) & 0x03;
+		unsigned int layer_bits = (data[1] >> 1) & 0x03;
+		unsigned int bitrate_index = data[2] >> 4;
+		unsigned int sample_rate_index = (data[2] >> 2) & 0x03;
+		unsigned int padding = (data[2] >> 1) & 0x01;
+
+		if (version_bits == 1 || layer_bits == 0
+			|| bitrate_index == 0 || bitrate_index == 15
+			|| sample_rate_index == 3) {
+			return false;
+		}
+
+		version = static_cast<enum version>(version_bits);
+		layer = 4 - layer_bits;
+		bitrate = 1000*bitrates[version == MPEG_1 ? 0 : 1][layer - 1][bitrate_index];
+		sample_rate = sample_rates[version_bits][sample_rate_index];
+		channel_count = (data[3] >> 6) == 3 ? 1 : 2;
+
+		switch (layer) {
+		case 1:
+			frame_size = 384;
+			length = 4*(12*bitrate/sample_rate + padding);
+			break;
+
+		case 2:
+			frame_size = 1152;
+			length = 144*bitrate/sample_rate + padding;
+			break;
+
+		default:
+			frame_size = version == MPEG_1 ? 1152 : 576;
+			length = (frame_size/8)*bitrate/sample_rate + padding;
+			break;
+		}
+
+		return true;
+	}
+
+	// Returns the offset of the Xing/Info header in a layer III frame.
+	unsigned int xing_offset () const {
+		if (version == MPEG_1) {
+			return 4 + (channel_count == 1 ? 17 : 32);
+		}
+		return 4 + (channel_count == 1 ? 9 : 17);
+	}
+};
+
+uint32_t read_be32 (const unsigned char *data) {
+	return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16)
+		| (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+// Reads the given count of bytes from the input and appends them to the
+// given buffer. Returns the count of bytes actually read.
+size_t read_more (std::istream &input, std::vector<unsigned char> &data, size_t count) {
+	size_t size = data.size();
+	data.resize(size + count);
+	input.read(reinterpret_cast<char *>(data.data() + size), count);
+	data.resize(size + input.gcount());
+	return input.gcount();
+}
+
+// Looks for the exact count of frames in the Xing/Info (and LAME) or VBRI
+// header of the given first frame. Returns `false` if there is none.
+bool read_vbr_header (
+		const frame_header &header,
+		const unsigned char *frame,
+		format::size_type &frame_count,
+		uint64_t &byte_count) {
+	const unsigned char *xing = frame + header.xing_offset();
+
+	if (memcmp(xing, "Xing", 4) == 0 || memcmp(xing, "Info", 4) == 0) {
+		uint32_t flags = read_be32(xing + 4);
+		const unsigned char *field = xing + 8;
+
+		if (! (flags & 0x01)) {
+			return false;
+		}
+
+		uint64_t mpeg_frame_count = read_be32(field);
+		field += 4;
+
+		if (flags & 0x02) {
+			byte_count = read_be32(field);
+			field += 4;
+		}
+		if (flags & 0x04) field += 100; // TOC
+		if (flags & 0x08) field +=   4; // quality
+
+		frame_count = mpeg_frame_count*header.frame_size;
+
+		// the LAME tag gives the encoder delay and padding that
+		// mpg123 removes from the decoded stream
+		if (memcmp(field, "LAME", 4) == 0 || memcmp(field, "Lav", 3) == 0) {
+			unsigned int delay = (field[21] << 4) | (field[22] >> 4);
+			unsigned int padding = ((field[22] & 0x0f) << 8) | field[23];
+			if (delay + padding < frame_count) {
+				frame_count -= delay + padding;
+			}
+		}
+
+		return true;
+	}
+
+	const unsigned char *vbri = frame + 4 + 32;
+
+	if (memcmp(vbri, "VBRI", 4) == 0) {
+		byte_count = read_be32(vbri + 10);
+		frame_count = read_be32(vbri + 14)*header.frame_size;
+		return true;
+	}
+
+	return false;
+}
+
+// Reads the head of the given stream, past its ID3v2 tag if any, into the
+// given buffer, which is zero padded so that VBR headers can be looked for
+// safely. Returns the offset in the buffer of the first MPEG frame, whose
+// header is set, and sets the count of bytes actually read.
+size_t read_head (
+		std::istream &input,
+		std::vector<unsigned char> &head,
+		frame_header &header,
+		size_t &head_length) {
+	// largest frame, plus the largest header and LAME tag
+	const size_t head_size = 2048;
+
+	uint64_t id3_size = 0;
+
+	// skip the ID3v2 tag if any
+	if (read_more(input, head, 10) == 10 && memcmp(head.data(), "ID3", 3) == 0) {
+		id3_size = 10
+			+ (uint64_t(head[6] & 0x7f) << 21)
+			+ (uint64_t(head[7] & 0x7f) << 14)
+			+ (uint64_t(head[8] & 0x7f) << 7)
+			+  uint64_t(head[9] & 0x7f)
+			+ ((head[5] & 0x10) ? 10 : 0);
+		input.ignore(id3_size - 10);
+		head.clear();
+	}
+
+	read_more(input, head, head_size);
+
+	// look for the first frame, the next one must follow it
+	frame_header next;
+	size_t offset = 0;
+
+	for (; offset + 4 <= head.size(); ++offset) {
+		if (header.parse(head.data() + offset)
+			&& (offset + header.length + 4 > head.size()
+				|| (next.parse(head.data() + offset + header.length)
+					&& next.sample_rate == header.sample_rate))) {
+			break;
+		}
+	}
+
+	if (offset + 4 > head.size()) {
+		error::raise_literal(error::CodecFormatError, "no MPEG audio frame found");
+	}
+
+	if (head.size() < offset + head_size) {
+		read_more(input, head, offset + head_size - head.size());
+	}
+
+	// pad with zeros so that headers can be looked for safely
+	head_length = head.size();
+	head.resize(std::max(head.size(), offset + head_size), 0);
+
+	return offset;
+}
+
+bool has_vbr_header (const std::string &filepath) {
+	std::ifstream input(filepath, std::ifstream::binary);
+	std::vector<unsigned char> head;
+	frame_header header;
+	size_t head_length;
+	format::size_type frame_count;
+	uint64_t byte_count;
+
+	try {
+		size_t offset = read_head(input, head, header, head_length);
+		return header.layer == 3
+			&& read_vbr_header(header, head.data() + offset, frame_count, byte_count);
+	} catch (const error &) {
+		return false;
+	}
+}
+
+codec::info probe (std::istream &input) {
+	std::vector<unsigned char> head;
+	frame_header header;
+	size_t head_length;
+	size_t offset = read_head(input, head, header, head_length);
+
+	format::size_type frame_count;
+	uint64_t byte_count = 0;
+
+	if (! (header.layer == 3
+		&& read_vbr_header(header, head.data() + offset, frame_count, byte_count))) {
+		// no VBR header, parse every frames
+		mpg123_lib &lib = mpg123_lib::instance();
+		mpg123_lib::handle handle = lib.get_handle();
+
+		lib.feed(handle, head.data() + offset, head_length - offset);
+		byte_count = head_length - offset;
+
+		uint64_t mpeg_frame_count = 0;
+		while (lib.next_frame(handle)) {
+			++mpeg_frame_count;
+		}
+		mpeg_frame_count += parse_frames(handle, input, &byte_count);
+
+		frame_count = mpeg_frame_count*header.frame_size;
+	}
+
+	unsigned int bitrate = header.bitrate;
+
+	if (byte_count > 0 && frame_count > 0) {
+		bitrate = 8*byte_count*header.sample_rate/frame_count;
+	}
+
+	return codec::info{
+		"mp3",
+		format(header.channel_count, header.sample_rate),
+		frame_count,
+		bitrate
+	};
+}
+} /* namespace mp3_ */
+
+bool MP3_decoder::sniff (const unsigned char *data, size_t size) noexcept {
+	if (size >= 3 && memcmp(data, "ID3", 3) == 0) {
+		return true;
+	}
+
+	// a frame followed by another one
+	mp3_::frame_header header, next;
+
+	return size >= 4
+		&& header.parse(data)
+		&& (size < header.length + 4
+			|| (next.parse(data + header.length)
+				&& next.sample_rate == header.sample_rate));
+}
+
+codec::info MP3_decoder::probe_ (std::istream &input) const {
+	return mp3_::probe(input);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Frame index ///////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace mp3_ {
+const char frame_index_magic[4] = { 'M', 'P', '3', 'I' };
+const uint32_t frame_index_version = 1;
+
+// Count of offsets read at once, the count given by an index is not
+// trusted before its offsets are actually read.
+const size_t frame_index_block_size = 4096;
+
+// Values are stored in little endian, whatever the host byte order.
+template <typename T>
+void write_value (std::ostream &out, T value) {
+	typename std::make_unsigned<T>::type bits = value;
+	char bytes[sizeof(T)];
+	for (size_t i = 0; i < sizeof(T); ++i, bits >>= 8) {
+		bytes[i] = static_cast<char>(bits & 0xff);
+	}
+	out.write(bytes, sizeof(T));
+}
+
+template <typename T>
+T from_little_endian (const unsigned char *bytes) {
+	typename std::make_unsigned<T>::type bits = 0;
+	for (size_t i = sizeof(T); i-- > 0;) {
+		bits = (bits << 8) | bytes[i];
+	}
+	return static_cast<T>(bits);
+}
+
+template <typename T>
+T read_value (std::istream &in) {
+	unsigned char bytes[sizeof(T)];
+	in.read(reinterpret_cast<char *>(bytes), sizeof(T));
+	if (in.gcount() != sizeof(T)) {
+		error::raise_literal(error::CodecFormatError, "truncated MP3 frame index");
+	}
+	return from_little_endian<T>(bytes);
+}
+} /* namespace mp3_ */
+
+MP3_decoder::frame_index::frame_index () :
+	step_(0),
+	frame_count_(0) {
+}
+
+MP3_decoder::frame_index::frame_index (
+		std::vector<int64_t> offsets,
+		int64_t step,
+		format::size_type frame_count) :
+	offsets_(std::move(offsets)),
+	step_(step),
+	frame_count_(frame_count) {
+}
+
+void MP3_decoder::frame_index::save (std::ostream &out) const {
+	out.write(mp3_::frame_index_magic, sizeof(mp3_::frame_index_magic));
+	mp3_::write_value<uint32_t>(out, mp3_::frame_index_version);
+	mp3_::write_value<int64_t>(out, step_);
+	mp3_::write_value<uint64_t>(out, frame_count_);
+	mp3_::write_value<uint64_t>(out, offsets_.size());
+	for (int64_t offset: offsets_) {
+		mp3_::write_value<int64_t>(out, offset);
+	}
+	if (! out) {
+		error::raise_literal(error::IOError, "failed to write MP3 frame index");
+	}
+}
+
+void MP3_decoder::frame_index::save (const std::string &filepath) const {
+	std::ofstream out(filepath, std::ofstream::binary);
+	save(out);
+}
+
+MP3_decoder::frame_index MP3_decoder::frame_index::load (std::istream &in) {
+	char magic[sizeof(mp3_::frame_index_magic)];
+
+	in.read(magic, sizeof(magic));
+	if (in.gcount() != sizeof(magic)
+		|| memcmp(magic, mp3_::frame_index_magic, sizeof(magic)) != 0
+		|| mp3_::read_value<uint32_t>(in) != mp3_::frame_index_version) {
+		error::raise_literal(error::CodecFormatError, "not a MP3 frame index");
+	}
+
+	int64_t step = mp3_::read_value<int64_t>(in);
+	uint64_t frame_count = mp3_::read_value<uint64_t>(in);
+	uint64_t count = mp3_::read_value<uint64_t>(in);
+
+	std::vector<int64_t> offsets;
+	std::vector<unsigned char> block;
+	while (offsets.size() < count) {
+		block.resize(sizeof(int64_t)*std::min<uint64_t>(
+			count - offsets.size(), mp3_::frame_index_block_size));
+		in.read(reinterpret_cast<char *>(block.data()), block.size());
+		if (in.gcount() != std::streamsize(block.size())) {
+			error::raise_literal(error::CodecFormatError, "truncated MP3 frame index");
+		}
+		for (size_t i = 0; i < block.size(); i += sizeof(int64_t)) {
+			offsets.push_back(mp3_::from_little_endian<int64_t>(&block[i]));
+		}
+	}
+
+	return frame_index(std::move(offsets), step, frame_count);
+}
+
+MP3_decoder::frame_index MP3_decoder::frame_index::load (
+		const std::string &filepath) {
+	std::ifstream in(filepath, std::ifstream::binary);
+	return load(in);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Decoder ///////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -270,25 +1529,21 @@ class output_stream {
 	std::ostream &output_;
 	lame_t lame_;
 	format format_;
+	bool flushed_;
 
 	const format::size_type input_frame_count_;
 	utils::buffer mp3_buffer_;
 
 	static void error_handler_ (const char *fmt, va_list ap) {
-		size_t msg_size = 128u;
-		std::unique_ptr<char, std::function<void(char *)>> 
-			msg(static_cast<char *>(malloc(msg_size)),
-				[](char *data){ delete(data); });
-		do {
-			size_t size = vsnprintf(msg.get(), msg_size, fmt, ap);
-			if (size > msg_size) {
-				msg_size = size;
-				msg.reset((char *)realloc(msg.release(), size));
-			} else {
-				error::raise(error::CodecUnexpectedError, 
-						msg.get());
-			}
-		} while (true);
+		va_list args;
+		va_copy(args, ap);
+		const int size = vsnprintf(nullptr, 0, fmt, args);
+		va_end(args);
+
+		std::vector<char> msg(size > 0 ? size + 1 : 1, '\0');
+		vsnprintf(msg.data(), msg.size(), fmt, ap);
+
+		error::raise(error::CodecUnexpectedError, std::string(msg.data()));
 	}
 
 #if defined(DEBUG)
@@ -305,12 +1560,22 @@ class output_stream {
 #endif
 
 public:
-	output_stream (std::ostream &output, const format &fmt) :
+	// A segment stream writes neither Xing nor LAME tag and does not use
+	// the bit reservoir, so that each of its frames can be cut out of
+	// its bitstream.
+	output_stream (
+			std::ostream &output,
+			const format &fmt,
+			const encoder_options &options,
+			bool segment = false) :
 		output_(output),
 		format_(fmt),
+		flushed_(false),
 		input_frame_count_(1024),
 		mp3_buffer_(5*input_frame_count_/4 + 7200)
 	{
+		libmp3lame.require(error::CoderNotFound);
+
 		if ((lame_ = lame_init()) == nullptr) {
 			error::raise(error::CodecUnexpectedError);
 		}
@@ -321,11 +1586,40 @@ public:
 
 		lame_set_num_channels(lame_, format_.channel_count());
 		lame_set_in_samplerate(lame_, format_.sample_rate());
-		lame_set_mode(lame_, JOINT_STEREO);
+		lame_set_mode(lame_,
+			options.channel_mode == encoder_options::Stereo
+				? STEREO
+				: JOINT_STEREO);
+
+		int bitrate = options.bitrate > 0 ? options.bitrate : 128;
+
+		switch (options.bitrate_mode) {
+		case encoder_options::DefaultBitrate:
+		case encoder_options::ConstantBitrate:
+			lame_set_VBR(lame_, vbr_off);
+			lame_set_brate(lame_, bitrate);
+			break;
+
+		case encoder_options::AverageBitrate:
+			lame_set_VBR(lame_, vbr_abr);
+			lame_set_VBR_mean_bitrate_kbps(lame_, bitrate);
+			break;
+
+		case encoder_options::VariableBitrate:
+			// LAME VBR quality goes from 0 (highest) to 9
+			lame_set_VBR(lame_, vbr_default);
+			lame_set_VBR_quality(lame_,
+				9.f*(1.f - std::min(1.f, std::max(0.f, options.quality))));
+			break;
+		}
 
-		// lame_set_bWriteVbrTag(lame_, 0);
-		// TODO: change the quality parameter ASAP
-		lame_set_quality(lame_, 2);
+		// algorithm quality goes from 0 (best, slowest) to 9
+		lame_set_quality(lame_, options.fast ? 7 : 2);
+
+		if (segment) {
+			lame_set_bWriteVbrTag(lame_, 0);
+			lame_set_disable_reservoir(lame_, 1);
+		}
 
 		if (lame_init_params(lame_) < 0) {
 			error::raise(error::CodecUnexpectedError);
@@ -339,14 +1633,21 @@ public:
 		}
 	}
 
+	lame_t lame () const {
+		return lame_;
+	}
+
 	void write (const sequence &seq) {
 
 		if (seq.format() != format_) {
-			error::raise(error::FormatMismatchedError,
+			error::raise_literal(error::FormatMismatchedError,
 					"format of provided sequence does not match");
 		}
 
-		format::size_type total_frame_count = seq.frame_count();
+		write(seq.data(0), seq.frame_count());
+	}
+
+	void write (const float *data, format::size_type total_frame_count) {
 		format::size_type frame_index = 0;
 
 		while (frame_index < total_frame_count) {
@@ -360,7 +1661,8 @@ public:
 
 			n = lame_encode_buffer_interleaved_ieee_float(
 				lame_,
-				seq.data(frame_index), frame_count,
+				data + frame_index*format_.channel_count(),
+				frame_count,
 				mp3_buffer_.data<unsigned char>(),
 				mp3_buffer_.size()
 			);
@@ -372,6 +1674,9 @@ public:
 	}
 
 	void flush () {
+		if (flushed_) return;
+		flushed_ = true;
+
 		int n;
 		n = lame_encode_flush(
 			lame_,
@@ -380,10 +1685,276 @@ public:
 		if (n > 0) output_.write(mp3_buffer_.data<char>(), n);
 	}
 };
+
+// Count of MPEG frames encoded before and after a segment and dropped, so
+// that the filter bank and the psychoacoustic model of the segment encoder
+// are settled on the segment bounds.
+const format::size_type segment_preroll = 4;
+const format::size_type segment_postroll = 4;
+
+void write_be32 (unsigned char *data, uint32_t value) {
+	data[0] = value >> 24;
+	data[1] = value >> 16;
+	data[2] = value >> 8;
+	data[3] = value;
+}
+
+// CRC-16 of the LAME tag.
+uint16_t crc16 (const unsigned char *data, size_t size, uint16_t crc = 0) {
+	for (size_t i = 0; i < size; ++i) {
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; ++bit) {
+			crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+struct frame {
+	const unsigned char *data;
+	frame_header header;
+};
+
+// Returns the frames of the given segment bitstream, which must start on a
+// frame header.
+std::vector<frame> split_frames (const std::string &bitstream) {
+	const unsigned char *data =
+		reinterpret_cast<const unsigned char *>(bitstream.data());
+	std::vector<frame> frames;
+
+	for (size_t offset = 0; offset + 4 <= bitstream.size();) {
+		frame f{data + offset, frame_header()};
+		if (! f.header.parse(f.data)
+			|| offset + f.header.length > bitstream.size()) {
+			error::raise_literal(error::CodecUnexpectedError,
+					"corrupted MP3 segment");
+		}
+		frames.push_back(f);
+		offset += f.header.length;
+	}
+
+	return frames;
+}
+
+// Builds a Xing/Info frame holding a LAME tag for the given frames.
+// See http://gabriel.mp3-tech.org/mp3infotag.html
+std::vector<unsigned char> info_frame (
+		lame_t lame,
+		const std::vector<frame> &frames,
+		format::size_type frame_count) {
+	const frame &first = frames.front();
+
+	// side info + Xing header + LAME tag
+	const unsigned int tag_length = first.header.xing_offset() + 120 + 36;
+
+	// the tag frame has the same format as the audio frames, without
+	// padding nor CRC, and the lowest bitrate fitting the tag
+	unsigned char header_data[4] = {
+		first.data[0],
+		static_cast<unsigned char>(first.data[1] | 0x01),
+		static_cast<unsigned char>(first.data[2] & 0x0d),
+		first.data[3]
+	};
+	frame_header header;
+
+	for (unsigned int index = 1;; ++index) {
+		header_data[2] = (header_data[2] & 0x0f) | (index << 4);
+		if (index == 15) {
+			error::raise(error::CodecUnexpectedError);
+		}
+		if (header.parse(header_data) && header.length >= tag_length) {
+			break;
+		}
+	}
+
+	uint64_t byte_count = header.length;
+	bool constant_bitrate = true;
+	for (const frame &f: frames) {
+		byte_count += f.header.length;
+		constant_bitrate = constant_bitrate
+			&& f.header.bitrate == first.header.bitrate;
+	}
+
+	const unsigned int delay = lame_get_encoder_delay(lame);
+	const uint64_t padding =
+		frames.size()*first.header.frame_size - delay - frame_count;
+
+	if (frames.size()*first.header.frame_size < delay + frame_count
+		|| padding > 0x0fff || byte_count > 0xffffffffu) {
+		error::raise_literal(error::CodecUnexpectedError,
+				"cannot write the MP3 LAME tag");
+	}
+
+	std::vector<unsigned char> data(header.length, 0);
+	std::copy(header_data, header_data + 4, data.begin());
+
+	unsigned char *xing = data.data() + header.xing_offset();
+
+	memcpy(xing, constant_bitrate ? "Info" : "Xing", 4);
+	write_be32(xing + 4, 0x0f);
+	write_be32(xing + 8, frames.size());
+	write_be32(xing + 12, byte_count);
+
+	// seek table, frame offsets in 1/256th of the stream
+	unsigned char *toc = xing + 16;
+	uint64_t offset = header.length;
+	for (size_t i = 0, j = 0; i < 100; ++i) {
+		for (; j < i*frames.size()/100; ++j) {
+			offset += frames[j].header.length;
+		}
+		toc[i] = std::min<uint64_t>(255, 256*offset/byte_count);
+	}
+
+	write_be32(xing + 116,
+		std::max(0, 100 - 10*lame_get_VBR_q(lame) - lame_get_quality(lame)));
+
+	unsigned char *tag = xing + 120;
+	std::string version = std::string("LAME") + get_lame_short_version();
+
+	version.resize(9, ' ');
+	std::copy(version.begin(), version.end(), tag);
+
+	switch (lame_get_VBR(lame)) {
+	case vbr_off:
+		tag[9] = 1;
+		tag[20] = std::min(255, lame_get_brate(lame));
+		break;
+
+	case vbr_abr:
+		tag[9] = 3;
+		tag[20] = std::min(255, lame_get_VBR_mean_bitrate_kbps(lame));
+		break;
+
+	default:
+		tag[9] = 4;
+		tag[20] = std::min(255, lame_get_VBR_min_bitrate_kbps(lame));
+		break;
+	}
+
+	tag[10] = std::min(255, lame_get_lowpassfreq(lame)/100);
+	tag[19] = lame_get_ATHtype(lame) & 0x0f;
+	tag[21] = delay >> 4;
+	tag[22] = ((delay & 0x0f) << 4) | (padding >> 8);
+	tag[23] = padding;
+
+	unsigned int sample_rate = first.header.sample_rate;
+	tag[24] = (sample_rate <= 32000 ? 0 : sample_rate == 44100 ? 1 : sample_rate == 48000 ? 2 : 3) << 6;
+
+	write_be32(tag + 28, byte_count);
+
+	uint16_t music_crc = 0;
+	for (const frame &f: frames) {
+		music_crc = crc16(f.data, f.header.length, music_crc);
+	}
+	tag[32] = music_crc >> 8;
+	tag[33] = music_crc;
+
+	uint16_t tag_crc = crc16(data.data(), tag + 34 - data.data());
+	tag[34] = tag_crc >> 8;
+	tag[35] = tag_crc;
+
+	return data;
+}
+
+// Encodes the given sequence splitting it in segments encoded concurrently
+// and joins their frames into one gapless stream.
+void write_parallel (
+		std::ostream &output,
+		const sequence &seq,
+		const encoder_options &options,
+		unsigned int thread_count) {
+	const format::size_type sample_count = seq.frame_count();
+
+	size_t segment_count = std::min<format::size_type>(
+		thread_count, sample_count/min_segment_frame_count
+	);
+
+	if (segment_count < 2) {
+		output_stream(output, seq.format(), options).write(seq);
+		return;
+	}
+
+	// encoders are set up serially, LAME initialization is not thread
+	// safe
+	std::vector<std::ostringstream> bitstreams(segment_count);
+	std::vector<std::unique_ptr<output_stream>> streams;
+
+	for (auto &bitstream: bitstreams) {
+		streams.emplace_back(
+			new output_stream(bitstream, seq.format(), options, true)
+		);
+	}
+
+	// segment bounds, in MPEG frames
+	const format::size_type frame_size = lame_get_framesize(streams[0]->lame());
+	const format::size_type delay = lame_get_encoder_delay(streams[0]->lame());
+	const format::size_type mpeg_frame_count =
+		(sample_count + delay)/frame_size;
+
+	std::vector<format::size_type> bounds(segment_count + 1);
+	for (size_t i = 0; i <= segment_count; ++i) {
+		bounds[i] = mpeg_frame_count*i/segment_count;
+	}
+
+	// segments start on a frame bound, so the frames of every segment
+	// encoder are aligned on the frames of a serial encoder
+	utils::parallel_for(segment_count, thread_count, [&](size_t i) {
+		format::size_type preroll = i > 0 ? segment_preroll : 0;
+		format::size_type first = (bounds[i] - preroll)*frame_size;
+		format::size_type last = i + 1 < segment_count
+			? std::min(sample_count, (bounds[i + 1] + segment_postroll)*frame_size)
+			: sample_count;
+
+		streams[i]->write(seq.data(first), last - first);
+		streams[i]->flush();
+	});
+
+	// keep the frames of each segment bounds, bitstreams must outlive
+	// their frames
+	std::vector<std::string> data(segment_count);
+	std::vector<frame> frames;
+
+	for (size_t i = 0; i < segment_count; ++i) {
+		data[i] = bitstreams[i].str();
+
+		std::vector<frame> segment_frames = split_frames(data[i]);
+		format::size_type first = i > 0 ? segment_preroll : 0;
+		format::size_type last = i + 1 < segment_count
+			? first + bounds[i + 1] - bounds[i]
+			: segment_frames.size();
+
+		if (segment_frames.size() < last || first >= last) {
+			error::raise_literal(error::CodecUnexpectedError,
+					"unexpected end of MP3 segment");
+		}
+
+		frames.insert(frames.end(),
+			segment_frames.begin() + first, segment_frames.begin() + last);
+	}
+
+	std::vector<unsigned char> tag =
+		info_frame(streams[0]->lame(), frames, sample_count);
+
+	output.write(reinterpret_cast<const char *>(tag.data()), tag.size());
+	for (const frame &f: frames) {
+		output.write(reinterpret_cast<const char *>(f.data), f.header.length);
+	}
+}
 } /* namespace mp3_ */
 
-void MP3_coder::encode_ (std::ostream &output, const sequence &seq) const 
-	throw(error) {
-	mp3_::output_stream mp3_ostream(output, seq.format());
+MP3_coder::MP3_coder (const encoder_options &options) :
+	options_(options) {
+}
+
+void MP3_coder::encode_ (std::ostream &output, const sequence &seq) const {
+	unsigned int thread_count = utils::thread_count(options_.thread_count);
+
+	// segments give up the bit reservoir, only when asked to
+	if (thread_count > 1 && options_.parallel_mp3) {
+		mp3_::write_parallel(output, seq, options_, thread_count);
+		return;
+	}
+
+	mp3_::output_stream mp3_ostream(output, seq.format(), options_);
 	mp3_ostream.write(seq);
 }
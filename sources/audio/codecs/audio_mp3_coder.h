@@ -5,6 +5,7 @@
 #define AUDIO_MP3_CODER_H_
 
 #include <audio/codecs/coder>
+#include <audio/codecs/encoder_options>
 
 namespace com {
 namespace nealrame {
@@ -12,9 +13,22 @@ namespace audio {
 class sequence;
 namespace codec {
 class MP3_coder : public coder {
+public:
+	/// Constructs a `MP3_coder`.
+	///
+	/// *Parameters:*
+	/// - `options`
+	///   The encoder settings. With more than one thread and
+	///   `parallel_mp3` set, long sequences are split into segments
+	///   encoded concurrently without bit reservoir, then joined into one
+	///   gapless stream starting with a Xing/LAME header.
+	explicit MP3_coder (const encoder_options &options = encoder_options());
+
 protected:
-	virtual void encode_ (std::ostream &, const sequence &) const
-		throw(error);
+	virtual void encode_ (std::ostream &, const sequence &) const;
+
+private:
+	encoder_options options_;
 };
 } /* namespace codec */
 } /* namespace audio */
@@ -6,17 +6,153 @@
 
 #include "audio_decoder.h"
 
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
 namespace com {
 namespace nealrame {
 namespace audio {
 class sequence;
 namespace codec {
 class MP3_decoder: public decoder {
+public:
+	/// class com::nealrame::audio::codec::MP3_decoder::frame_index
+	/// ===========================================================
+	/// Byte offsets of the MPEG frames of a stream, as built by mpg123
+	/// while parsing it. An index lets the decoder jump straight to the
+	/// bytes holding a given frame instead of decoding from the start.
+	///
+	/// An index can be saved to and loaded from a sidecar file so that
+	/// the scan only happens once per stream. Sidecar files are little
+	/// endian, they can be shared between hosts.
+	class frame_index {
+	public:
+		/// Constructs an empty `frame_index`.
+		frame_index ();
+
+		/// Constructs a `frame_index` from the given offsets.
+		///
+		/// *Parameters:*
+		/// - `offsets`
+		///   Byte offsets of every `step`-th MPEG frame.
+		/// - `step`
+		///   The count of MPEG frames between two offsets.
+		/// - `frame_count`
+		///   The count of audio frames of the indexed stream.
+		frame_index (
+			std::vector<int64_t> offsets,
+			int64_t step,
+			format::size_type frame_count);
+
+	public:
+		/// Returns `true` if this `frame_index` contains no offset.
+		bool empty () const noexcept
+		{ return offsets_.empty(); }
+
+		/// Returns the byte offsets of this `frame_index`.
+		const std::vector<int64_t> & offsets () const noexcept
+		{ return offsets_; }
+
+		/// Returns the count of MPEG frames between two offsets.
+		int64_t step () const noexcept
+		{ return step_; }
+
+		/// Returns the count of audio frames of the indexed stream.
+		format::size_type frame_count () const noexcept
+		{ return frame_count_; }
+
+	public:
+		/// Writes this `frame_index` to the given stream.
+		void save (std::ostream &) const;
+
+		/// Writes this `frame_index` to the given file.
+		void save (const std::string &filepath) const;
+
+		/// Reads a `frame_index` from the given stream.
+		///
+		/// *Exceptions:*
+		/// - `error`
+		///   With status `CodecFormatError` if the stream does not
+		///   contain a valid index.
+		static frame_index load (std::istream &);
+
+		/// Reads a `frame_index` from the given file.
+		static frame_index load (const std::string &filepath);
+
+	private:
+		std::vector<int64_t> offsets_;
+		int64_t step_;
+		format::size_type frame_count_;
+	};
+
+public:
+	/// Constructs a `MP3_decoder`.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads used to decode a stream. With more than
+	///   one thread, long Layer III streams are split at frame boundaries
+	///   into segments decoded concurrently. The decoded `sequence` is the
+	///   same as with a single thread. Streams which are not in memory
+	///   are first read whole in memory. A count of 0 stands for the count
+	///   of hardware threads.
+	explicit MP3_decoder (unsigned int thread_count = 1);
+
+public:
+	/// Returns `true` if the given first bytes of a stream are the ones
+	/// of a MPEG audio stream.
+	static bool sniff (const unsigned char *data, size_t size) noexcept;
+
+public:
+	using decoder::decode;
+
+	/// Parses the whole given stream without decoding it and returns
+	/// its `frame_index`. The stream is rewound to its initial position.
+	///
+	/// *Parameters:*
+	/// - `stream`
+	///   A seekable stream.
+	frame_index scan (std::istream &stream) const;
+
+	/// Decodes a range of frames of the given stream using the given
+	/// `frame_index`. If the index is empty, it is built first by
+	/// scanning the stream.
+	///
+	/// *Parameters:*
+	/// - `stream`
+	///   A seekable stream.
+	/// - `index`
+	///   The `frame_index` of the stream.
+	/// - `first_frame`
+	///   Index of the first frame to be decoded.
+	/// - `frame_count`
+	///   The requested count of frames.
+	sequence decode (
+			std::istream &stream,
+			frame_index &index,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+
 protected:
-	virtual sequence decode_ (std::istream &) const throw(error);
+	virtual sequence decode_ (std::istream &) const;
+	virtual sequence decode_file_ (const std::string &) const;
+	virtual sequence decode_source_ (utils::byte_source &) const;
+	virtual void decode_file_into_ (const std::string &, sequence &) const;
+	virtual void decode_source_into_ (utils::byte_source &, sequence &) const;
+	virtual std::unique_ptr<reader> open_file_ (const std::string &) const;
+	virtual info probe_ (std::istream &) const;
+	virtual sequence decode_range_ (
+			std::istream &,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+
+private:
+	unsigned int thread_count_;
 };
 } /* namespace codec */
 } /* namespace audio */
 } /* namespace nealrame */
 } /* namespace com */
-#endif /* AUDIO_MP3_DECODER_H_ */
\ No newline at end of file
+#endif /* AUDIO_MP3_DECODER_H_ */
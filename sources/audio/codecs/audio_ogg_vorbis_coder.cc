@@ -2,14 +2,27 @@
 /// Created on: April 26, 2014
 ///     Author: [NealRame](mailto:contact@nealrame.com)
 
+#include "audio_backend.h"
 #include "audio_ogg_vorbis_coder.h"
 #include "audio_ogg_vorbis_decoder.h"
 
 #include <audio/sequence>
 #include <audio/format>
 
+#include <utils/buffer>
+#include <utils/byte_source>
+#include <utils/parallel>
+
 #include <algorithm>
+#include <array>
 #include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+#include <vector>
 
 extern "C" {
 #       include <ogg/ogg.h>
@@ -17,9 +30,11 @@ extern "C" {
 #	include <vorbis/vorbisenc.h>
 }
 
+using namespace com::nealrame;
 using namespace com::nealrame::audio;
 using com::nealrame::audio::codec::OGGVorbis_coder;
 using com::nealrame::audio::codec::OGGVorbis_decoder;
+using com::nealrame::audio::codec::encoder_options;
 
 //////////////////////////////////////////////////////////////////////////////
 // Decoder ///////////////////////////////////////////////////////////////////
@@ -27,25 +42,199 @@ using com::nealrame::audio::codec::OGGVorbis_decoder;
 
 namespace ogg_vorbis_ {
 
+// libogg, libvorbis and libvorbisenc are loaded the first time they are
+// used. The calls made in this namespace go through the functions below,
+// which hide the ones of the libraries headers.
+const codec::backend libogg {
+	"libogg.so.0", "libogg.0.dylib", "libogg.so", "libogg.dylib"
+};
+
+const codec::backend libvorbis {
+	"libvorbis.so.0", "libvorbis.0.dylib", "libvorbis.so", "libvorbis.dylib"
+};
+
+const codec::backend libvorbisenc {
+	"libvorbisenc.so.2", "libvorbisenc.2.dylib", "libvorbisenc.so", "libvorbisenc.dylib"
+};
+
+#define BACKEND_STRINGIFY_(name) #name
+#define BACKEND_STRINGIFY(name) BACKEND_STRINGIFY_(name)
+#define BACKEND_FUNCTION(library, name) \
+	const codec::backend::function<decltype(&::name)> name( \
+		library, BACKEND_STRINGIFY(name))
+
+BACKEND_FUNCTION(libogg, ogg_page_bos);
+BACKEND_FUNCTION(libogg, ogg_page_eos);
+BACKEND_FUNCTION(libogg, ogg_page_granulepos);
+BACKEND_FUNCTION(libogg, ogg_page_serialno);
+BACKEND_FUNCTION(libogg, ogg_stream_clear);
+BACKEND_FUNCTION(libogg, ogg_stream_flush);
+BACKEND_FUNCTION(libogg, ogg_stream_init);
+BACKEND_FUNCTION(libogg, ogg_stream_packetin);
+BACKEND_FUNCTION(libogg, ogg_stream_packetout);
+BACKEND_FUNCTION(libogg, ogg_stream_pagein);
+BACKEND_FUNCTION(libogg, ogg_stream_pageout);
+BACKEND_FUNCTION(libogg, ogg_stream_reset_serialno);
+BACKEND_FUNCTION(libogg, ogg_sync_buffer);
+BACKEND_FUNCTION(libogg, ogg_sync_check);
+BACKEND_FUNCTION(libogg, ogg_sync_clear);
+BACKEND_FUNCTION(libogg, ogg_sync_init);
+BACKEND_FUNCTION(libogg, ogg_sync_pageseek);
+BACKEND_FUNCTION(libogg, ogg_sync_reset);
+BACKEND_FUNCTION(libogg, ogg_sync_wrote);
+
+BACKEND_FUNCTION(libvorbis, vorbis_analysis);
+BACKEND_FUNCTION(libvorbis, vorbis_analysis_blockout);
+BACKEND_FUNCTION(libvorbis, vorbis_analysis_buffer);
+BACKEND_FUNCTION(libvorbis, vorbis_analysis_headerout);
+BACKEND_FUNCTION(libvorbis, vorbis_analysis_init);
+BACKEND_FUNCTION(libvorbis, vorbis_analysis_wrote);
+BACKEND_FUNCTION(libvorbis, vorbis_block_clear);
+BACKEND_FUNCTION(libvorbis, vorbis_block_init);
+BACKEND_FUNCTION(libvorbis, vorbis_comment_add_tag);
+BACKEND_FUNCTION(libvorbis, vorbis_comment_clear);
+BACKEND_FUNCTION(libvorbis, vorbis_comment_init);
+BACKEND_FUNCTION(libvorbis, vorbis_dsp_clear);
+BACKEND_FUNCTION(libvorbis, vorbis_info_clear);
+BACKEND_FUNCTION(libvorbis, vorbis_info_init);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_blockin);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_headerin);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_init);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_pcmout);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_read);
+BACKEND_FUNCTION(libvorbis, vorbis_synthesis_restart);
+
+BACKEND_FUNCTION(libvorbisenc, vorbis_encode_init);
+BACKEND_FUNCTION(libvorbisenc, vorbis_encode_init_vbr);
+
+#undef BACKEND_FUNCTION
+#undef BACKEND_STRINGIFY
+#undef BACKEND_STRINGIFY_
+
+// Updates the given CRC of Ogg pages, of polynomial 0x04c11db7 computed
+// most significant bit first.
+uint32_t update_crc (uint32_t crc, const unsigned char *data, size_t size) noexcept {
+	static const std::array<uint32_t, 256> table = [] {
+		std::array<uint32_t, 256> table;
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t r = i << 24;
+			for (int bit = 0; bit < 8; ++bit) {
+				r = (r & 0x80000000u) ? (r << 1) ^ 0x04c11db7u : r << 1;
+			}
+			table[i] = r;
+		}
+		return table;
+	}();
+
+	for (size_t i = 0; i < size; ++i) {
+		crc = (crc << 8) ^ table[(crc >> 24) ^ data[i]];
+	}
+
+	return crc;
+}
+
+// Finds the page at the begining of the given bytes as
+// `ogg_sync_pageseek` does, but the page points to the bytes instead of a
+// copy of them. Returns the size of the page, minus the count of bytes to
+// be skipped to the next possible page, or 0 if the bytes end before the
+// page does.
+long find_page (const unsigned char *data, size_t size, ogg_page &page) noexcept {
+	const size_t header_min_size = 27;
+
+	if (size < header_min_size) {
+		return 0;
+	}
+
+	if (std::memcmp(data, "OggS", 4) == 0) {
+		const size_t header_size = header_min_size + data[26];
+		size_t body_size = 0;
+
+		if (size < header_size) {
+			return 0;
+		}
+		for (size_t i = header_min_size; i < header_size; ++i) {
+			body_size += data[i];
+		}
+		if (size < header_size + body_size) {
+			return 0;
+		}
+
+		// the checksum is computed with its own field set to 0
+		const unsigned char zeros[4] = { 0, 0, 0, 0 };
+		uint32_t crc = update_crc(0, data, 22);
+		crc = update_crc(crc, zeros, 4);
+		crc = update_crc(crc, data + 26, header_size + body_size - 26);
+
+		if (crc == (data[22] | data[23] << 8 | data[24] << 16
+				| uint32_t(data[25]) << 24)) {
+			// libogg only reads the pages it is given
+			page.header = const_cast<unsigned char *>(data);
+			page.header_len = header_size;
+			page.body = const_cast<unsigned char *>(data + header_size);
+			page.body_len = body_size;
+			return header_size + body_size;
+		}
+	}
+
+	const void *next = std::memchr(data + 1, 'O', size - 1);
+	return next != nullptr
+		? -static_cast<long>(static_cast<const unsigned char *>(next) - data)
+		: -static_cast<long>(size);
+}
+
 class ogg_input_stream {
+public:
+	// A link of a chained stream.
+	struct link {
+		// offset of the first page of the link
+		std::streamoff offset;
+		// granule position of the last page of the link
+		ogg_int64_t length;
+	};
+
 public:
 	ogg_input_stream (std::istream &input, std::streamsize read_count = 8192) :
+		stream_source_(new utils::stream_source(input, read_count)),
+		input_(*stream_source_),
+		read_count_(read_count),
+		eof_(false),
+		origin_(input_.tell()),
+		offset_(0),
+		page_offset_(0) {
+		open_();
+	}
+
+	ogg_input_stream (utils::byte_source &input, std::streamsize read_count = 65536) :
 		input_(input),
 		read_count_(read_count),
-		eof_(false) {
+		eof_(false),
+		origin_(input_.tell()),
+		offset_(0),
+		page_offset_(0) {
+		open_();
+	}
+
+	virtual ~ogg_input_stream () {
+		ogg_sync_clear(&sync_);
+		ogg_stream_clear(&state_);
+	}
 
+private:
+	void open_ () {
+		libogg.require(error::DecoderNotFound);
 		ogg_sync_init(&sync_);
 
 		try {
 			ogg_page page;
 			
-			if (! read_page_(page)) {
+			if (! read_page(page)) {
 				error::raise(error::CodecUnexpectedError);
 			}
 
-			int stream_serial = ogg_page_serialno(&page);
+			serial_ = ogg_page_serialno(&page);
 
-			if (ogg_stream_init(&state_, stream_serial) < 0) {
+			if (ogg_stream_init(&state_, serial_) < 0) {
 				error::raise(error::CodecUnexpectedError);
 			}
 			
@@ -58,85 +247,283 @@ public:
 		}
 	}
 
-	virtual ~ogg_input_stream () {
-		ogg_sync_clear(&sync_);
-		ogg_stream_clear(&state_);
-	}
-	
+public:
 	bool read_packet (ogg_packet &packet) {
 		if (ogg_sync_check(&sync_) != 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Failed to read Ogg packet");
 		}
 
-		// if the packet is not complete, read more page
-		if (ogg_stream_packetout(&state_, &packet) != 1) {
+		// while the packet is not complete, read more page
+		while (ogg_stream_packetout(&state_, &packet) != 1) {
 			ogg_page page;
 
-			if (! read_page_(page)) {
+			if (! read_page(page)) {
 				return false;
 			}
 
-			if (ogg_stream_pagein(&state_, &page) < 0) {
-				error::raise(error::CodecUnexpectedError,
-						"Failed to read Ogg packet");
+			if (! owns(page)) {
+				if (! (state_.e_o_s && ogg_page_bos(&page))) {
+					// page of another multiplexed stream
+					continue;
+				}
+				// first page of the next link of a chained
+				// stream
+				ogg_stream_reset_serialno(&state_, ogg_page_serialno(&page));
 			}
-			
-			return read_packet(packet);
+
+			page_in(page);
 		}
-		
+
 		return true;
 	}
 
-	bool eof () const {
-		return eof_;
+	// Gets the next packet out of the pages already submitted to the
+	// logical stream. Returns `false` if there is no complete packet.
+	bool packet_out (ogg_packet &packet) {
+		int status;
+		// skip holes in the data
+		while ((status = ogg_stream_packetout(&state_, &packet)) < 0);
+		return status == 1;
 	}
 
-private:
-	bool read_page_ (ogg_page &page) {
-		char *buffer;
-		int status;
-		
+	// Submits the given page to the logical stream.
+	void page_in (ogg_page &page) {
+		if (ogg_stream_pagein(&state_, &page) < 0) {
+			error::raise_literal(error::CodecUnexpectedError,
+					"Failed to read Ogg packet");
+		}
+	}
+
+	// Reads the next page of the physical stream. Returns `false` if the
+	// end of the stream has been reached.
+	bool read_page (ogg_page &page) {
+		if (input_.data() != nullptr) {
+			return read_page_in_place_(page);
+		}
+
+		long n;
+
 		// while the page is not complete, read more data from stream
 		// to fill in the page
-		while ((status = ogg_sync_pageout(&sync_, &page)) == 0) {
-			
+		while ((n = ogg_sync_pageseek(&sync_, &page)) <= 0) {
+			if (n < 0) {
+				// skipped bytes while looking for a page
+				offset_ -= n;
+				continue;
+			}
+
 			if (input_.eof()) {
 				eof_ = true;
 				return false;
 			}
-			
-			buffer = ogg_sync_buffer(&sync_, read_count_);
-			input_.read(buffer, read_count_);
-			
-			std::streamsize bytes = input_.gcount();
-			
+
+			char *buffer = ogg_sync_buffer(&sync_, read_count_);
+			size_t bytes = input_.read(buffer, read_count_);
+
 			if (ogg_sync_wrote(&sync_, bytes) < 0) {
-				error::raise(error::CodecUnexpectedError,
+				error::raise_literal(error::CodecUnexpectedError,
 						"Failed to read Ogg page");
 			}
 		}
-		
+
+		page_offset_ = offset_;
+		offset_ += n;
+
 		return true;
 	}
-	
+
+	// Returns `true` if the given page belongs to the logical stream.
+	bool owns (ogg_page &page) const {
+		return ogg_page_serialno(&page) == state_.serialno;
+	}
+
+	bool eof () const {
+		return eof_;
+	}
+
+public:
+	// Returns the offset of the last page read, relative to the begining
+	// of the physical stream.
+	std::streamoff page_offset () const {
+		return page_offset_;
+	}
+
+	// Returns the offset of the next page to be read, relative to the
+	// begining of the physical stream.
+	std::streamoff offset () const {
+		return offset_;
+	}
+
+	// Returns the size in bytes of the physical stream.
+	std::streamoff size () {
+		check_seekable_();
+
+		return input_.size() - origin_;
+	}
+
+	// Moves the physical stream to the given offset. Buffered data and
+	// pending packets are dropped and the logical stream is back to the
+	// first link.
+	void seek (std::streamoff offset) {
+		check_seekable_();
+
+		if (! input_.seek(origin_ + offset)) {
+			error::raise_literal(error::IOError, "failed to seek input stream");
+		}
+
+		ogg_sync_reset(&sync_);
+		ogg_stream_reset_serialno(&state_, serial_);
+
+		eof_ = false;
+		offset_ = offset;
+		page_offset_ = offset;
+	}
+
+	// Returns `true` if the physical stream can be moved.
+	bool seekable () const {
+		return input_.seekable();
+	}
+
+	// Returns the granule position of the last page of the logical
+	// stream, or the sum of the lengths of its links if it is chained.
+	// On seekable streams, only the tail of an unchained stream is read.
+	ogg_int64_t last_granule () {
+		if (! seekable()) {
+			return length_(read_links_());
+		}
+
+		ogg_int64_t granule = -1;
+		int serial = serial_;
+		ogg_page page;
+
+		std::streamoff end = size(), window = 65536;
+
+		do {
+			std::streamoff begin = std::max<std::streamoff>(0, end - window);
+
+			seek(begin);
+			while (read_page(page) && page_offset_ < end) {
+				if (ogg_page_granulepos(&page) >= 0) {
+					granule = ogg_page_granulepos(&page);
+					serial = ogg_page_serialno(&page);
+				}
+			}
+
+			end = begin;
+			window *= 2;
+		} while (granule < 0 && end > 0);
+
+		// the last page belongs to another link or stream
+		if (serial != serial_) {
+			return length_(links());
+		}
+
+		return std::max<ogg_int64_t>(granule, 0);
+	}
+
+	// Reads every page of the physical stream and returns its links. An
+	// unchained stream has a single link.
+	std::vector<link> links () {
+		seek(0);
+		return read_links_();
+	}
+
+private:
+	// Reads the remaining pages of the physical stream and returns the
+	// links they hold.
+	std::vector<link> read_links_ () {
+		std::vector<link> links{{page_offset_, 0}};
+		int serial = serial_;
+		bool ended = false;
+		ogg_page page;
+
+		while (read_page(page)) {
+			if (ogg_page_serialno(&page) == serial) {
+				links.back().length = std::max(
+					links.back().length, ogg_page_granulepos(&page)
+				);
+				ended = ogg_page_eos(&page);
+			} else if (ended && ogg_page_bos(&page)) {
+				links.push_back(link{page_offset_, 0});
+				serial = ogg_page_serialno(&page);
+				ended = false;
+			}
+		}
+
+		return links;
+	}
+
+	// Reads the next page of a source in memory, the page points to the
+	// bytes of the source.
+	bool read_page_in_place_ (ogg_page &page) {
+		const size_t size = input_.size();
+		size_t offset = input_.tell();
+		long n;
+
+		while ((n = find_page(input_.data() + offset, size - offset, page)) < 0) {
+			// skipped bytes while looking for a page
+			offset -= n;
+			offset_ -= n;
+		}
+
+		if (n == 0) {
+			input_.seek(size);
+			eof_ = true;
+			return false;
+		}
+
+		input_.seek(offset + n);
+		page_offset_ = offset_;
+		offset_ += n;
+
+		return true;
+	}
+
+	static ogg_int64_t length_ (const std::vector<link> &links) {
+		ogg_int64_t length = 0;
+		for (const link &l: links) {
+			length += l.length;
+		}
+		return length;
+	}
+
+	void check_seekable_ () const {
+		if (! seekable()) {
+			error::raise_literal(error::IOError, "input stream is not seekable");
+		}
+	}
+
 private:
-	std::istream &input_;
+	// set if the stream reads a `std::istream`
+	std::unique_ptr<utils::stream_source> stream_source_;
+	utils::byte_source &input_;
 	std::streamsize read_count_;
 	ogg_sync_state sync_;
 	ogg_stream_state state_;
+	int serial_;
 	bool eof_;
+	size_t origin_;
+	std::streamoff offset_;
+	std::streamoff page_offset_;
 };
 
 class vorbis_input_stream {
+	// Under this size, the range searched for a page is scanned instead
+	// of being bisected.
+	static const std::streamoff bisection_threshold_ = 16384;
+
 public:
 	vorbis_input_stream (std::istream &input) :
-		ogg_stream_(input) {
-
-		vorbis_info_init(&state_);
-		vorbis_comment_init(&comment_);
+		ogg_stream_(input),
+		skip_(0) {
+		open_();
+	}
 
-		read_header_();
+	vorbis_input_stream (utils::byte_source &input) :
+		ogg_stream_(input),
+		skip_(0) {
+		open_();
 	}
 
 	virtual ~vorbis_input_stream () {
@@ -146,6 +533,17 @@ public:
 		vorbis_comment_clear(&comment_);
 	}
 
+private:
+	void open_ () {
+		libvorbis.require(error::DecoderNotFound);
+
+		vorbis_info_init(&state_);
+		vorbis_comment_init(&comment_);
+
+		read_header_();
+	}
+
+public:
 	// Returns the audio `format` of this vorbis input stream.
 	format get_format() {
 		return format(state_.channels, state_.rate);
@@ -155,24 +553,27 @@ public:
 	// stream and append them to the given `buffer`.
 	void read (sequence &seq, format::size_type frame_count) {
 		if (get_format() != seq.format()) {
-			error::raise(error::CodecFormatError,
+			error::raise_literal(error::CodecFormatError,
 					"Vorbis stream format differs from buffer format");
 		}
-		do {
-			float **pcm;
-			int count = vorbis_synthesis_pcmout(&dsp_, &pcm);
-
-			if (count > 0) {
-				count = std::min<format::size_type>(count, frame_count);
-
-				vorbis_synthesis_read(&dsp_, count);
-				seq.append(pcm, count);
+		read_(frame_count, [&seq](float **pcm, format::size_type count) {
+			seq.append(pcm, count);
+		});
+	}
 
-				frame_count -= count;
-			} else {
-				read_ogg_packet_();
+	// Reads at most the specified count of frames from this input vorbis
+	// stream into the given interleaved buffer. Returns the count of
+	// frames actually read.
+	format::size_type read (float *data, format::size_type frame_count) {
+		const unsigned int channel_count = state_.channels;
+
+		return read_(frame_count, [&](float **pcm, format::size_type count) {
+			for (format::size_type i = 0; i < count; ++i) {
+				for (unsigned int channel = 0; channel < channel_count; ++channel) {
+					*data++ = pcm[channel][i];
+				}
 			}
-		} while (! (frame_count == 0 || eof()));
+		});
 	}
 
 	// Reads all data from this vorbis input stream to the given buffer.
@@ -182,6 +583,23 @@ public:
 		}
 	}
 
+	// Returns the granule position of the last page of this stream, or 0
+	// if the stream is not seekable. It must be called before any frame
+	// is read, the stream is moved back to its first audio page.
+	format::size_type length () {
+		if (! ogg_stream_.seekable()) {
+			return 0;
+		}
+
+		ogg_int64_t granule = ogg_stream_.last_granule();
+
+		ogg_stream_.seek(data_offset_);
+		vorbis_synthesis_restart(&dsp_);
+		skip_ = 0;
+
+		return granule;
+	}
+
 	// Returns true iff there is no pcm data to be read and ogg stream has
 	// reach the end of stream.
 	bool eof () {
@@ -189,46 +607,271 @@ public:
 			&& ogg_stream_.eof(); 
 	}
 
+	// Moves this stream to the given frame. The underlying input stream
+	// must be seekable.
+	//
+	// The page preceding the frame is found by bisection on the page
+	// granule positions, narrowed by the pages already known by the given
+	// index. The packets ending in that page are decoded and dropped so
+	// that the first block read after the seek gets its window overlap.
+	// The first packet of a page may start on a previous one and the
+	// first packet decoded gives no frame: as vorbisfile does, previous
+	// pages are decoded as well until two packets at least are.
+	void seek (format::size_type frame, OGGVorbis_decoder::page_index &index) {
+		std::streamoff offset, start;
+		ogg_int64_t granule, start_granule;
+
+		find_page_(frame, index, offset, granule);
+
+		start = offset;
+		start_granule = granule;
+
+		while (start > data_offset_) {
+			if (prime_(start, offset) >= 2) {
+				// the pcm returned so far ends at the page
+				// granule position
+				vorbis_synthesis_read(&dsp_,
+						vorbis_synthesis_pcmout(&dsp_, nullptr));
+				skip_ = frame - granule;
+				return;
+			}
+			find_page_(start_granule, index, start, start_granule);
+		}
+
+		ogg_stream_.seek(data_offset_);
+		vorbis_synthesis_restart(&dsp_);
+		skip_ = frame;
+	}
+
+	// Reads every page of this stream and records the granule positions
+	// of its audio pages in the given index. Returns the granule position
+	// of the last page. The stream is moved back to its first audio page.
+	format::size_type scan (OGGVorbis_decoder::page_index &index) {
+		ogg_int64_t granule = 0;
+		ogg_page page;
+
+		ogg_stream_.seek(data_offset_);
+		while (next_granule_page_(page, -1, index)) {
+			granule = std::max(granule, ogg_page_granulepos(&page));
+		}
+
+		ogg_stream_.seek(data_offset_);
+		vorbis_synthesis_restart(&dsp_);
+		skip_ = 0;
+
+		return granule;
+	}
+
 private:
+	template <typename Output>
+	format::size_type read_ (format::size_type frame_count, Output output) {
+		format::size_type remaining_frame_count = frame_count;
+		do {
+			float **pcm;
+			int count = vorbis_synthesis_pcmout(&dsp_, &pcm);
+
+			if (count > 0 && skip_ > 0) {
+				// drop the frames preceding a seek target
+				count = std::min<format::size_type>(count, skip_);
+
+				vorbis_synthesis_read(&dsp_, count);
+				skip_ -= count;
+			} else if (count > 0) {
+				count = std::min<format::size_type>(count, remaining_frame_count);
+
+				output(pcm, count);
+				vorbis_synthesis_read(&dsp_, count);
+
+				remaining_frame_count -= count;
+			} else {
+				read_ogg_packet_();
+			}
+		} while (! (remaining_frame_count == 0 || eof()));
+
+		return frame_count - remaining_frame_count;
+	}
+
+	// Finds the last page of this logical stream with a granule position
+	// lower than the given one. If there is none, the first audio page is
+	// returned with a null granule position.
+	void find_page_ (
+			ogg_int64_t target,
+			OGGVorbis_decoder::page_index &index,
+			std::streamoff &offset,
+			ogg_int64_t &granule) {
+		std::streamoff lo = data_offset_, hi = ogg_stream_.size();
+
+		offset = data_offset_;
+		granule = 0;
+
+		const std::map<int64_t, int64_t> &pages = index.pages();
+		auto it = pages.lower_bound(target);
+
+		if (it != pages.end()) {
+			hi = it->second;
+		}
+		if (it != pages.begin()) {
+			--it;
+			lo = offset = it->second;
+			granule = it->first;
+		}
+
+		ogg_page page;
+
+		while (hi - lo > bisection_threshold_) {
+			std::streamoff mid = lo + (hi - lo)/2;
+
+			ogg_stream_.seek(mid);
+
+			if (next_granule_page_(page, hi, index)
+				&& ogg_page_granulepos(&page) < target) {
+				lo = offset = ogg_stream_.page_offset();
+				granule = ogg_page_granulepos(&page);
+			} else {
+				hi = mid;
+			}
+		}
+
+		ogg_stream_.seek(lo);
+
+		while (next_granule_page_(page, -1, index)
+			&& ogg_page_granulepos(&page) < target) {
+			offset = ogg_stream_.page_offset();
+			granule = ogg_page_granulepos(&page);
+		}
+	}
+
+	// Reads pages up to the next page of this logical stream with a
+	// granule position and records it in the given index. Returns `false`
+	// if there is no such page starting before `limit` (no limit if
+	// negative).
+	bool next_granule_page_ (
+			ogg_page &page,
+			std::streamoff limit,
+			OGGVorbis_decoder::page_index &index) {
+		while (ogg_stream_.read_page(page)) {
+			if (limit >= 0 && ogg_stream_.page_offset() >= limit) {
+				return false;
+			}
+			if (ogg_stream_.owns(page) && ogg_page_granulepos(&page) >= 0) {
+				index.insert(
+					ogg_page_granulepos(&page),
+					ogg_stream_.page_offset()
+				);
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void read_header_ () {
 		ogg_packet packet;
+
+		ogg_stream_.read_packet(packet);
+		read_header_(packet);
+
+		// the setup header ends a page, audio data starts on the next
+		data_offset_ = ogg_stream_.offset();
+	}
+
+	// Reads the headers starting with the given packet and sets up the
+	// synthesis.
+	void read_header_ (ogg_packet &packet) {
 		int status;
 
 		for (int i = 0; i < 3; ++i) {
-			ogg_stream_.read_packet(packet);
+			if (i > 0) {
+				ogg_stream_.read_packet(packet);
+			}
 			if ((status = vorbis_synthesis_headerin(&state_, &comment_, &packet)) < 0) {
-				error::raise(error::CodecUnexpectedError, 
+				error::raise_literal(error::CodecUnexpectedError, 
 						"Failed to read vorbis header");
 			}
 		}
 
 		if (vorbis_synthesis_init(&dsp_, &state_) != 0) {
-			error::raise(error::CodecUnexpectedError, 
+			error::raise_literal(error::CodecUnexpectedError, 
 					"Vorbis internal error");
 		}
 
 		if (vorbis_block_init(&dsp_, &block_) != 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 	}
 
+	// Sets up the synthesis of the next link of a chained stream, given
+	// its first header packet. Links must share the same format.
+	void next_link_ (ogg_packet &packet) {
+		format fmt = get_format();
+
+		vorbis_block_clear(&block_);
+		vorbis_dsp_clear(&dsp_);
+		vorbis_info_clear(&state_);
+		vorbis_comment_clear(&comment_);
+
+		vorbis_info_init(&state_);
+		vorbis_comment_init(&comment_);
+
+		read_header_(packet);
+
+		if (get_format() != fmt) {
+			error::raise_literal(error::CodecFormatError,
+					"chained Vorbis streams of different formats");
+		}
+	}
+
 	void read_ogg_packet_ () {
 		ogg_packet packet;
 
-		if (! ogg_stream_.read_packet(packet)) {
-			return ;
+		if (ogg_stream_.read_packet(packet)) {
+			if (packet.b_o_s) {
+				next_link_(packet);
+			} else {
+				synthesize_(packet);
+			}
+		}
+	}
+
+	// Moves this stream to the page at `start`, then decodes the packets
+	// ending in the pages up to the one at `end`. Returns the count of
+	// packets decoded.
+	size_t prime_ (std::streamoff start, std::streamoff end) {
+		ogg_page page;
+		ogg_packet packet;
+		size_t count = 0;
+
+		ogg_stream_.seek(start);
+		vorbis_synthesis_restart(&dsp_);
+
+		while (ogg_stream_.read_page(page)
+				&& ogg_stream_.page_offset() <= end) {
+			if (! ogg_stream_.owns(page)) {
+				continue;
+			}
+			ogg_stream_.page_in(page);
+			while (ogg_stream_.packet_out(packet)) {
+				synthesize_(packet);
+				++count;
+			}
+			if (ogg_stream_.page_offset() == end) {
+				break;
+			}
 		}
 
+		return count;
+	}
+
+	void synthesize_ (ogg_packet &packet) {
 		int status;
 
 		if ((status = vorbis_synthesis (&block_, &packet)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis decode error");
 		}
 
 		if ((status = vorbis_synthesis_blockin(&dsp_, &block_)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis decode error");
 		}
 	}
@@ -239,19 +882,322 @@ private:
 	vorbis_comment comment_;
 	vorbis_dsp_state dsp_;
 	vorbis_block block_;
+	std::streamoff data_offset_;
+	format::size_type skip_;
+};
+
+// Reads the format of the stream from the Vorbis identification header
+// and its length from the granule position of its last page.
+codec::info probe (std::istream &input) {
+	ogg_input_stream ogg_stream(input);
+	libvorbis.require(error::DecoderNotFound);
+
+	ogg_packet packet;
+
+	vorbis_info info;
+	vorbis_comment comment;
+
+	vorbis_info_init(&info);
+	vorbis_comment_init(&comment);
+
+	bool valid = ogg_stream.read_packet(packet)
+		&& vorbis_synthesis_headerin(&info, &comment, &packet) == 0;
+
+	unsigned int channel_count = info.channels;
+	unsigned int sample_rate = info.rate;
+	long bitrate = info.bitrate_nominal;
+
+	vorbis_comment_clear(&comment);
+	vorbis_info_clear(&info);
+
+	if (! valid) {
+		error::raise_literal(error::CodecFormatError, "not a Vorbis stream");
+	}
+
+	format::size_type frame_count = ogg_stream.last_granule();
+
+	if (bitrate <= 0 && ogg_stream.seekable() && frame_count > 0) {
+		bitrate = 8*ogg_stream.size()*sample_rate/frame_count;
+	}
+
+	return codec::info{
+		"vorbis",
+		format(channel_count, sample_rate),
+		frame_count,
+		static_cast<unsigned int>(std::max<long>(bitrate, 0))
+	};
+}
+
+// Under this count of frames per range, splitting a stream costs more than
+// decoding it serially.
+const format::size_type min_range_frame_count = 1 << 20;
+
+// Decodes the links of the given chained stream concurrently.
+sequence read_links_parallel (
+		const unsigned char *data,
+		size_t size,
+		const std::vector<ogg_input_stream::link> &links,
+		unsigned int thread_count) {
+	utils::memory_source source(data, size);
+	std::vector<sequence> sequences(
+		links.size(), sequence(vorbis_input_stream(source).get_format())
+	);
+
+	utils::parallel_for(links.size(), thread_count, [&](size_t i) {
+		std::streamoff end = i + 1 < links.size()
+			? links[i + 1].offset
+			: size;
+		utils::memory_source link_source(
+			data + links[i].offset, end - links[i].offset
+		);
+		vorbis_input_stream(link_source).read(sequences[i]);
+	});
+
+	sequence seq(sequences.front().format());
+	for (const sequence &link_seq: sequences) {
+		seq.append(link_seq);
+	}
+
+	return seq;
+}
+
+// Decodes the given bytes splitting their pages in ranges decoded
+// concurrently, each through its own decoder.
+sequence read_all_parallel (
+		const unsigned char *data,
+		size_t size,
+		unsigned int thread_count) {
+	// links of a chained stream are independent, they are decoded
+	// concurrently
+	std::vector<ogg_input_stream::link> links;
+	{
+		utils::memory_source source(data, size);
+		links = ogg_input_stream(source).links();
+	}
+
+	if (links.size() > 1) {
+		return read_links_parallel(data, size, links, thread_count);
+	}
+
+	utils::memory_source source(data, size);
+	vorbis_input_stream ov_decoder(source);
+
+	OGGVorbis_decoder::page_index index;
+	format::size_type frame_count = ov_decoder.scan(index);
+
+	sequence seq(ov_decoder.get_format());
+
+	size_t range_count = std::min<format::size_type>(
+		thread_count, frame_count/min_range_frame_count
+	);
+
+	if (range_count < 2) {
+		ov_decoder.read(seq);
+		return seq;
+	}
+
+	std::vector<format::size_type> bounds(range_count + 1);
+	for (size_t i = 0; i <= range_count; ++i) {
+		bounds[i] = frame_count*i/range_count;
+	}
+
+	// the last range is decoded up to the end of the stream, which may
+	// differ from the granule position of its last page
+	seq.set_frame_count(frame_count);
+	sequence tail(seq.format());
+
+	utils::parallel_for(range_count, thread_count, [&](size_t i) {
+		utils::memory_source range_source(data, size);
+		vorbis_input_stream range_decoder(range_source);
+
+		// seeking primes the decoder with the packets of the page
+		// preceding the range for the window overlap, the index is
+		// updated while seeking so each range gets its own copy
+		if (bounds[i] > 0) {
+			OGGVorbis_decoder::page_index range_index(index);
+			range_decoder.seek(bounds[i], range_index);
+		}
+
+		if (i + 1 < range_count) {
+			format::size_type count = bounds[i + 1] - bounds[i];
+			if (range_decoder.read(seq.data(bounds[i]), count) != count) {
+				error::raise_literal(error::CodecUnexpectedError,
+						"unexpected end of Vorbis stream");
+			}
+		} else {
+			range_decoder.read(tail);
+		}
+	});
+
+	seq.set_frame_count(bounds[range_count - 1]);
+	seq.append(tail);
+
+	return seq;
+}
+
+// Decodes the given stream splitting its pages in ranges decoded
+// concurrently.
+sequence read_all_parallel (std::istream &input, unsigned int thread_count) {
+	// ranges are decoded from an in-memory copy of the stream
+	utils::buffer data = utils::read(input);
+	return read_all_parallel(
+			data.data<unsigned char>(), data.size(), thread_count);
+}
+
+// Decodes a file as its frames are read.
+class file_reader : public codec::reader {
+	utils::file_source file_;
+	vorbis_input_stream stream_;
+	class format format_;
+
+public:
+	explicit file_reader (const std::string &filepath) :
+		file_(filepath),
+		stream_(file_),
+		format_(stream_.get_format()) {
+	}
+
+	virtual const class format & format () const noexcept {
+		return format_;
+	}
+
+	virtual format::size_type read (sequence &seq, format::size_type frame_count) {
+		format::size_type offset = seq.frame_count();
+		stream_.read(seq, frame_count);
+		return seq.frame_count() - offset;
+	}
 };
 
 }; // namespace ogg_vorbis_
 
-sequence OGGVorbis_decoder::decode_ (std::istream &input) const throw(error) {
+OGGVorbis_decoder::OGGVorbis_decoder (unsigned int thread_count) :
+	thread_count_(thread_count) {
+}
+
+sequence OGGVorbis_decoder::decode_ (std::istream &input) const {
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	if (thread_count > 1) {
+		return ogg_vorbis_::read_all_parallel(input, thread_count);
+	}
+
 	ogg_vorbis_::vorbis_input_stream ov_decoder(input);
 
 	sequence seq(ov_decoder.get_format());
+	seq.reserve(ov_decoder.length());
+	ov_decoder.read(seq);
+
+	return seq;
+}
+
+std::unique_ptr<codec::reader> OGGVorbis_decoder::open_file_ (
+		const std::string &filepath) const {
+	return std::unique_ptr<reader>(new ogg_vorbis_::file_reader(filepath));
+}
+
+sequence OGGVorbis_decoder::decode_source_ (utils::byte_source &source) const {
+	unsigned int thread_count = utils::thread_count(thread_count_);
+
+	// ranges are decoded from memory, sources which are not in memory are
+	// copied first
+	if (thread_count > 1) {
+		if (source.data() == nullptr) {
+			return decoder::decode_source_(source);
+		}
+
+		size_t offset = source.tell();
+		source.seek(source.size());
+		return ogg_vorbis_::read_all_parallel(
+				source.data() + offset, source.size() - offset, thread_count);
+	}
+
+	ogg_vorbis_::vorbis_input_stream ov_decoder(source);
+
+	sequence seq(ov_decoder.get_format());
+	seq.reserve(ov_decoder.length());
 	ov_decoder.read(seq);
 
 	return seq;
 }
 
+void OGGVorbis_decoder::decode_file_into_ (
+		const std::string &filepath,
+		sequence &dst) const {
+	// links are decoded from memory
+	if (utils::thread_count(thread_count_) > 1) {
+		decoder::decode_file_into_(filepath, dst);
+		return;
+	}
+
+	utils::mapped_source source(filepath);
+
+	if (! source.is_open()) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	decode_source_into_(source, dst);
+}
+
+void OGGVorbis_decoder::decode_source_into_ (
+		utils::byte_source &source,
+		sequence &dst) const {
+	if (utils::thread_count(thread_count_) > 1) {
+		decoder::decode_source_into_(source, dst);
+		return;
+	}
+
+	ogg_vorbis_::vorbis_input_stream ov_decoder(source);
+
+	dst.reset(ov_decoder.get_format());
+	dst.reserve(ov_decoder.length());
+	ov_decoder.read(dst);
+}
+
+sequence OGGVorbis_decoder::decode_range_ (
+		std::istream &input,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	page_index index;
+	return decode(input, index, first_frame, frame_count);
+}
+
+sequence OGGVorbis_decoder::decode (
+		std::istream &input,
+		page_index &index,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	ogg_vorbis_::vorbis_input_stream ov_decoder(input);
+	ov_decoder.seek(first_frame, index);
+
+	sequence seq(ov_decoder.get_format());
+	if (frame_count > 0) {
+		ov_decoder.read(seq, frame_count);
+	}
+
+	return seq;
+}
+
+bool OGGVorbis_decoder::sniff (const unsigned char *data, size_t size) noexcept {
+	// the first page of the stream holds the identification header
+	if (size < 27 || memcmp(data, "OggS", 4) != 0) {
+		return false;
+	}
+
+	size_t packet = 27 + data[26];
+
+	return size >= packet + 7
+		&& data[packet] == 0x01
+		&& memcmp(data + packet + 1, "vorbis", 6) == 0;
+}
+
+codec::info OGGVorbis_decoder::probe_ (std::istream &input) const {
+	return ogg_vorbis_::probe(input);
+}
+
+void OGGVorbis_decoder::page_index::insert (int64_t granule, int64_t offset) {
+	pages_[granule] = offset;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Decoder ///////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -260,10 +1206,12 @@ namespace ogg_vorbis_ {
 
 class ogg_output_stream {
 public:
-	ogg_output_stream (std::ostream &output) :
+	ogg_output_stream (std::ostream &output, int serial) :
 		output_(output) {
-		if (ogg_stream_init(&state_, (int)time(nullptr)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+		libogg.require(error::CoderNotFound);
+
+		if (ogg_stream_init(&state_, serial) < 0) {
+			error::raise_literal(error::CodecUnexpectedError,
 					"Ogg internal error");
 		}
 	}
@@ -279,7 +1227,7 @@ public:
 
 	void write_packet (ogg_packet &packet) {
 		if (ogg_stream_packetin(&state_, &packet) < 0) {
-			error::raise(error::CodecUnexpectedError, 
+			error::raise_literal(error::CodecUnexpectedError, 
 					"Ogg internal error");
 		}
 
@@ -303,35 +1251,193 @@ private:
 	ogg_stream_state state_;
 };
 
-class vorbis_output_stream {
+// Setup of a Vorbis encoder and its header packets. Building them is
+// costly, the process keeps the ones it built, keyed by format and
+// settings, and shares them between the encoders of all threads, so that
+// the threads encoding the links of a chained stream build it once.
+class vorbis_setup {
 public:
-	vorbis_output_stream (std::ostream &output, const format &fmt, float quality) :
-		ogg_stream_(output) {
+	vorbis_setup (const format &fmt, const encoder_options &options) {
+		libvorbis.require(error::CoderNotFound);
+		libvorbisenc.require(error::CoderNotFound);
+
 		vorbis_info_init(&info_);
 
 		int status;
+		long bitrate = 1000*(options.bitrate > 0 ? options.bitrate : 128);
+
+		switch (options.bitrate_mode) {
+		case encoder_options::ConstantBitrate:
+			status = vorbis_encode_init(
+				&info_,
+				fmt.channel_count(), fmt.sample_rate(),
+				bitrate, bitrate, bitrate
+			);
+			break;
+
+		case encoder_options::AverageBitrate:
+			status = vorbis_encode_init(
+				&info_,
+				fmt.channel_count(), fmt.sample_rate(),
+				-1, bitrate, -1
+			);
+			break;
 
-		if ((status = vorbis_encode_init_vbr(
+		default:
+			// Vorbis VBR quality goes from -0.1 to 1
+			status = vorbis_encode_init_vbr(
 				&info_,
 				fmt.channel_count(), fmt.sample_rate(),
-				quality)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+				1.1f*std::min(1.f, std::max(0.f, options.quality)) - .1f
+			);
+			break;
+		}
+
+		if (status < 0) {
+			vorbis_info_clear(&info_);
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 
-		if (vorbis_analysis_init(&dsp_, &info_) != 0) {
-			error::raise(error::CodecUnexpectedError,
+		try {
+			encode_header_();
+		} catch (...) {
+			vorbis_info_clear(&info_);
+			throw;
+		}
+	}
+
+	vorbis_setup (const vorbis_setup &) = delete;
+	vorbis_setup & operator= (const vorbis_setup &) = delete;
+
+	virtual ~vorbis_setup () {
+		vorbis_info_clear(&info_);
+	}
+
+	static std::shared_ptr<vorbis_setup> get (
+			const format &fmt,
+			const encoder_options &options) {
+		typedef std::tuple<unsigned int, unsigned int, int, unsigned int, float> key;
+
+		// setups in use are kept alive by their encoders when the
+		// others are forgotten
+		const size_t max_setup_count = 64;
+
+		static std::mutex mutex;
+		static std::map<key, std::shared_ptr<vorbis_setup>> setups;
+
+		const key k(
+			fmt.channel_count(), fmt.sample_rate(),
+			options.bitrate_mode, options.bitrate, options.quality
+		);
+
+		// built under the lock so that concurrent encoders with the
+		// same settings wait for a single setup
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = setups.find(k);
+
+		if (it != setups.end()) {
+			return it->second;
+		}
+
+		if (setups.size() >= max_setup_count) {
+			setups.clear();
+		}
+
+		std::shared_ptr<vorbis_setup> setup =
+			std::make_shared<vorbis_setup>(fmt, options);
+		setups.emplace(k, setup);
+
+		return setup;
+	}
+
+public:
+	// The setup is only read by the encoders once it is complete, they
+	// can share it.
+	vorbis_info * info () {
+		return &info_;
+	}
+
+	// Returns the identification, comment or codebook header packet.
+	ogg_packet header (unsigned int index) {
+		ogg_packet packet;
+
+		packet.packet = headers_[index].data();
+		packet.bytes = headers_[index].size();
+		packet.b_o_s = index == 0;
+		packet.e_o_s = 0;
+		packet.granulepos = 0;
+		packet.packetno = index;
+
+		return packet;
+	}
+
+private:
+	void encode_header_ () {
+		vorbis_dsp_state dsp;
+		vorbis_comment comment;
+
+		// analysis also completes the codebooks of the setup
+		if (vorbis_analysis_init(&dsp, &info_) != 0) {
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 
-		if (vorbis_block_init(&dsp_, &block_) != 0) {
-			error::raise(error::CodecUnexpectedError,
+		vorbis_comment_init(&comment);
+		vorbis_comment_add_tag(&comment, "ENCODER", "audio-toolkit");
+		vorbis_comment_add_tag(&comment, "VENDOR", "nealrame.com");
+
+		// fill theses packet with:
+		// - stream id -> sid
+		// - comments -> comm
+		// - codebook -> code
+		ogg_packet packets[3];
+		int status = vorbis_analysis_headerout(
+			&dsp, &comment, &packets[0], &packets[1], &packets[2]
+		);
+
+		if (status >= 0) {
+			for (int i = 0; i < 3; ++i) {
+				headers_[i].assign(
+					packets[i].packet,
+					packets[i].packet + packets[i].bytes
+				);
+			}
+		}
+
+		vorbis_comment_clear(&comment);
+		vorbis_dsp_clear(&dsp);
+
+		if (status < 0) {
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
+	}
 
-		vorbis_comment_init(&comment_);
-		vorbis_comment_add_tag(&comment_, "ENCODER", "audio-toolkit");
-		vorbis_comment_add_tag(&comment_, "VENDOR", "nealrame.com");
+private:
+	vorbis_info info_;
+	std::vector<unsigned char> headers_[3];
+};
+
+class vorbis_output_stream {
+public:
+	vorbis_output_stream (
+			std::ostream &output,
+			const format &fmt,
+			const encoder_options &options,
+			int serial = time(nullptr)) :
+		ogg_stream_(output, serial),
+		setup_(vorbis_setup::get(fmt, options)) {
+
+		if (vorbis_analysis_init(&dsp_, setup_->info()) != 0) {
+			error::raise_literal(error::CodecUnexpectedError,
+					"Vorbis internal error");
+		}
+
+		if (vorbis_block_init(&dsp_, &block_) != 0) {
+			error::raise_literal(error::CodecUnexpectedError,
+					"Vorbis internal error");
+		}
 
 		encode_header_();
 	}
@@ -341,13 +1447,12 @@ public:
 		encode_frames_(0);
 		flush();
 		// cleaning up
-		vorbis_comment_clear(&comment_);
+		vorbis_block_clear(&block_);
 		vorbis_dsp_clear(&dsp_);
-		vorbis_info_clear(&info_);
 	}
 
 	format get_format() {
-		return format(info_.channels, info_.rate);
+		return format(setup_->info()->channels, setup_->info()->rate);
 	}
 
 	void flush () {
@@ -355,14 +1460,20 @@ public:
 	}
 
 	void write (const sequence &seq) {
+		write(seq, 0, seq.frame_count());
+	}
+
+	// Writes the given count of frames of the given sequence, starting
+	// from the given frame.
+	void write (
+			const sequence &seq,
+			format::size_type frame_index,
+			format::size_type remaining_frame_count) {
 		if (get_format() != seq.format()) {
-			error::raise(error::CodecFormatError,
+			error::raise_literal(error::CodecFormatError,
 					"Vorbis stream format differs from sequence format");
 		}
 
-		format::size_type remaining_frame_count = seq.frame_count();
-		format::size_type frame_index = 0;
-
 		while (remaining_frame_count > 0) {
 			auto frame_count = std::min(remaining_frame_count, format::size_type(1024));
 
@@ -379,7 +1490,7 @@ private:
 		int status;
 
 		if ((status = vorbis_analysis(&block_, &packet)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 
@@ -387,24 +1498,11 @@ private:
 	}
 
 	void encode_header_ () {
-		int status;
-		ogg_packet sid, comm, code;
-
-		// fill theses packet with:
-		// - stream id -> sid
-		// - comments -> comm
-		// - codebook -> code
-		if ((status = vorbis_analysis_headerout(
-				&dsp_, &comment_, &sid, &comm, &code)) < 0) {
-			error::raise(error::CodecUnexpectedError,
-					"Vorbis internal error");
-		}
-
 		// Write packet to ogg output stream
-
-		ogg_stream_.write_packet(sid);
-		ogg_stream_.write_packet(comm);
-		ogg_stream_.write_packet(code);
+		for (unsigned int i = 0; i < 3; ++i) {
+			ogg_packet packet = setup_->header(i);
+			ogg_stream_.write_packet(packet);
+		}
 
 		flush();
 	}
@@ -413,7 +1511,7 @@ private:
 		int status;
 
 		if ((status = vorbis_analysis_wrote(&dsp_, frame_count)) < 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 
@@ -422,23 +1520,72 @@ private:
 		}
 
 		if (status < 0) {
-			error::raise(error::CodecUnexpectedError,
+			error::raise_literal(error::CodecUnexpectedError,
 					"Vorbis internal error");
 		}
 	}
 
 private:
 	ogg_output_stream ogg_stream_;
+	std::shared_ptr<vorbis_setup> setup_;
 	vorbis_block block_;
-	vorbis_comment comment_;
 	vorbis_dsp_state dsp_;	
-	vorbis_info info_;
 };
 
+// Under this count of frames per link, splitting a sequence costs more than
+// encoding it serially.
+const format::size_type min_link_frame_count = 1 << 20;
+
+// Encodes the given sequence splitting it in segments encoded concurrently,
+// each one as a link of a chained stream. Links end on the exact last
+// frame of their segment, so the chained stream decodes to the same count
+// of frames.
+void write_chained (
+		std::ostream &output,
+		const sequence &seq,
+		const encoder_options &options,
+		unsigned int thread_count) {
+	// links must have distinct serial numbers
+	int serial = time(nullptr);
+
+	size_t link_count = std::min<format::size_type>(
+		thread_count, seq.frame_count()/min_link_frame_count
+	);
+
+	if (link_count < 2) {
+		vorbis_output_stream(output, seq.format(), options, serial).write(seq);
+		return;
+	}
+
+	std::vector<std::ostringstream> links(link_count);
+
+	utils::parallel_for(link_count, thread_count, [&](size_t i) {
+		format::size_type first = seq.frame_count()*i/link_count;
+		format::size_type last = seq.frame_count()*(i + 1)/link_count;
+
+		vorbis_output_stream ov_coder(links[i], seq.format(), options, serial + i);
+		ov_coder.write(seq, first, last - first);
+	});
+
+	for (std::ostringstream &link: links) {
+		output << link.str();
+	}
+}
+
 }; // namespace ogg_vorbis_
 
-void OGGVorbis_coder::encode_ (std::ostream &output, const sequence &seq) const
-	throw(error) {
-	ogg_vorbis_::vorbis_output_stream ov_coder(output, seq.format(), 1.0);
+OGGVorbis_coder::OGGVorbis_coder (const encoder_options &options) :
+	options_(options) {
+}
+
+void OGGVorbis_coder::encode_ (std::ostream &output, const sequence &seq) const {
+	unsigned int thread_count = utils::thread_count(options_.thread_count);
+
+	if (thread_count > 1) {
+		ogg_vorbis_::write_chained(output, seq, options_, thread_count);
+		return;
+	}
+
+	ogg_vorbis_::vorbis_output_stream ov_coder(output, seq.format(), options_);
 	ov_coder.write(seq);
 }
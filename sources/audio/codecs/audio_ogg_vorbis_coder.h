@@ -5,6 +5,7 @@
 #define AUDIO_OGG_VORBIS_CODER_H_
 
 #include <audio/codecs/coder>
+#include <audio/codecs/encoder_options>
 
 namespace com {
 namespace nealrame {
@@ -12,9 +13,21 @@ namespace audio {
 class sequence;
 namespace codec {
 class OGGVorbis_coder : public coder {
+public:
+	/// Constructs an `OGGVorbis_coder`.
+	///
+	/// *Parameters:*
+	/// - `options`
+	///   The encoder settings. With more than one thread, long sequences
+	///   are split into segments encoded concurrently, each one as a link
+	///   of a chained Ogg stream.
+	explicit OGGVorbis_coder (const encoder_options &options = encoder_options());
+
 protected:
-	virtual void encode_ (std::ostream &, const sequence &) const
-		throw(error);
+	virtual void encode_ (std::ostream &, const sequence &) const;
+
+private:
+	encoder_options options_;
 };
 } /* namespace codec */
 } /* namespace audio */
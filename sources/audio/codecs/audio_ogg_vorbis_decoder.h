@@ -6,15 +6,97 @@
 
 #include <audio/codecs/decoder>
 
+#include <cstdint>
+#include <map>
+
 namespace com {
 namespace nealrame {
 namespace audio {
 class sequence;
 namespace codec {
 class OGGVorbis_decoder : public decoder {
+public:
+	/// class com::nealrame::audio::codec::OGGVorbis_decoder::page_index
+	/// ================================================================
+	/// Granule positions and byte offsets of the pages of an Ogg Vorbis
+	/// stream. Pages met while seeking are recorded, so that later seeks
+	/// in the same stream only bisect between the closest known pages.
+	class page_index {
+	public:
+		/// Returns `true` if this `page_index` contains no page.
+		bool empty () const noexcept
+		{ return pages_.empty(); }
+
+		/// Returns the byte offsets of the known pages, keyed by their
+		/// granule positions.
+		const std::map<int64_t, int64_t> & pages () const noexcept
+		{ return pages_; }
+
+		/// Records a page.
+		///
+		/// *Parameters:*
+		/// - `granule`
+		///   The granule position of the page.
+		/// - `offset`
+		///   The offset of the page from the begining of the stream.
+		void insert (int64_t granule, int64_t offset);
+
+	private:
+		std::map<int64_t, int64_t> pages_;
+	};
+
+public:
+	/// Constructs an `OGGVorbis_decoder`.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads used to decode a stream. With more than
+	///   one thread, the pages of long streams are scanned once and
+	///   split into ranges decoded concurrently. The decoded `sequence`
+	///   is the same as with a single thread. A count of 0 stands for the
+	///   count of hardware threads.
+	explicit OGGVorbis_decoder (unsigned int thread_count = 1);
+
+public:
+	/// Returns `true` if the given first bytes of a stream are the ones
+	/// of a Ogg Vorbis stream.
+	static bool sniff (const unsigned char *data, size_t size) noexcept;
+
+public:
+	using decoder::decode;
+
+	/// Decodes a range of frames of the given stream, using and updating
+	/// the given `page_index`.
+	///
+	/// *Parameters:*
+	/// - `stream`
+	///   A seekable stream.
+	/// - `index`
+	///   The `page_index` of the stream.
+	/// - `first_frame`
+	///   Index of the first frame to be decoded.
+	/// - `frame_count`
+	///   The requested count of frames.
+	sequence decode (
+			std::istream &stream,
+			page_index &index,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+
 protected:
-	virtual sequence decode_ (std::istream &) const
-		throw(error);
+	virtual sequence decode_ (std::istream &) const;
+	virtual info probe_ (std::istream &) const;
+	virtual std::unique_ptr<reader> open_file_ (const std::string &) const;
+	virtual sequence decode_source_ (utils::byte_source &) const;
+	virtual void decode_file_into_ (const std::string &, sequence &) const;
+	virtual void decode_source_into_ (utils::byte_source &, sequence &) const;
+	virtual sequence decode_range_ (
+			std::istream &,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+
+private:
+	unsigned int thread_count_;
 };
 } /* namespace codec */
 } /* namespace audio */
@@ -0,0 +1,143 @@
+/// audio_prefetch_reader.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_prefetch_reader.h"
+
+#include "../audio_sequence.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace com::nealrame::audio;
+using com::nealrame::audio::codec::prefetch_reader;
+
+struct prefetch_reader::impl {
+	std::unique_ptr<reader> source;
+	const class format format;
+	const format::size_type chunk_frame_count;
+	const size_t chunk_count;
+
+	std::mutex mutex;
+	std::condition_variable chunk_ready;
+	std::condition_variable chunk_taken;
+
+	std::deque<sequence> chunks;
+	// count of frames of the first chunk already read
+	format::size_type offset;
+	bool done;
+	bool stopping;
+	std::exception_ptr exception;
+
+	std::thread thread;
+
+	impl (
+		std::unique_ptr<reader> source,
+		format::size_type chunk_frame_count,
+		size_t chunk_count) :
+		source(std::move(source)),
+		format(this->source->format()),
+		chunk_frame_count(std::max<format::size_type>(1, chunk_frame_count)),
+		chunk_count(std::max<size_t>(1, chunk_count)),
+		offset(0),
+		done(false),
+		stopping(false) {
+	}
+
+	void run () {
+		try {
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					chunk_taken.wait(lock, [this] {
+						return stopping || chunks.size() < chunk_count;
+					});
+					if (stopping) {
+						return;
+					}
+				}
+
+				sequence chunk(format);
+				format::size_type count = source->read(chunk, chunk_frame_count);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (count > 0) {
+					chunks.push_back(std::move(chunk));
+				}
+				done = count < chunk_frame_count;
+				chunk_ready.notify_one();
+
+				if (done) {
+					return;
+				}
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			exception = std::current_exception();
+			done = true;
+			chunk_ready.notify_one();
+		}
+	}
+};
+
+prefetch_reader::prefetch_reader (
+		std::unique_ptr<reader> source,
+		format::size_type chunk_frame_count,
+		size_t chunk_count) :
+	d_(new impl(std::move(source), chunk_frame_count, chunk_count)) {
+	d_->thread = std::thread(&impl::run, d_.get());
+}
+
+prefetch_reader::~prefetch_reader () {
+	{
+		std::lock_guard<std::mutex> lock(d_->mutex);
+		d_->stopping = true;
+	}
+	d_->chunk_taken.notify_one();
+	d_->thread.join();
+}
+
+const format & prefetch_reader::format () const noexcept {
+	return d_->format;
+}
+
+format::size_type
+prefetch_reader::read (sequence &seq, format::size_type frame_count) {
+	format::size_type total = 0;
+	std::unique_lock<std::mutex> lock(d_->mutex);
+
+	while (total < frame_count) {
+		d_->chunk_ready.wait(lock, [this] {
+			return ! d_->chunks.empty() || d_->done;
+		});
+
+		if (d_->chunks.empty()) {
+			// frames read before the error are returned first
+			if (d_->exception && total == 0) {
+				std::rethrow_exception(d_->exception);
+			}
+			break;
+		}
+
+		const sequence &chunk = d_->chunks.front();
+		format::size_type count =
+			std::min(frame_count - total, chunk.frame_count() - d_->offset);
+
+		seq.append(chunk.data(d_->offset), count);
+		total += count;
+		d_->offset += count;
+
+		if (d_->offset == chunk.frame_count()) {
+			d_->chunks.pop_front();
+			d_->offset = 0;
+			d_->chunk_taken.notify_one();
+		}
+	}
+
+	return total;
+}
@@ -0,0 +1,57 @@
+/// audio_prefetch_reader.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_PREFETCH_READER_H_
+#define AUDIO_PREFETCH_READER_H_
+
+#include <audio/codecs/reader>
+
+#include <utils/pimpl>
+
+#include <cstddef>
+#include <memory>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// class com::nealrame::audio::codec::prefetch_reader
+/// ==================================================
+/// Decodes the frames of another `reader` ahead of their reads, on a
+/// thread of its own. Decoded frames are kept in a bounded count of
+/// chunks, the thread waits once they are all full.
+///
+/// Errors of the underlying reader are raised by `read` once the frames
+/// decoded before them have been read.
+class prefetch_reader : public reader {
+public:
+	/// Constructs a `prefetch_reader` and starts decoding.
+	///
+	/// *Parameters:*
+	/// - `source`
+	///   The reader to be prefetched.
+	/// - `chunk_frame_count`
+	///   The count of frames of a chunk.
+	/// - `chunk_count`
+	///   The maximum count of chunks decoded ahead.
+	explicit prefetch_reader (
+		std::unique_ptr<reader> source,
+		format::size_type chunk_frame_count = 4096,
+		size_t chunk_count = 8);
+
+	/// Stops decoding.
+	virtual ~prefetch_reader ();
+
+public:
+	virtual const class format & format () const noexcept;
+	using reader::read;
+	virtual format::size_type read (sequence &seq, format::size_type frame_count);
+
+	PIMPL
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_PREFETCH_READER_H_ */
@@ -0,0 +1,459 @@
+/// audio_raw_codec.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "audio_raw_format.h"
+#include "audio_raw_coder.h"
+#include "audio_raw_decoder.h"
+
+#include "../audio_sequence.h"
+#include "../audio_format.h"
+#include "../audio_sample.h"
+
+#include "../../utils/utils_byte_source.h"
+#include "../../utils/utils_mapped_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace com::nealrame;
+using namespace com::nealrame::audio;
+using com::nealrame::audio::codec::raw_format;
+using com::nealrame::audio::codec::RAW_coder;
+using com::nealrame::audio::codec::RAW_decoder;
+
+//////////////////////////////////////////////////////////////////////////////
+// Common ////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace raw_ {
+
+// Count of frames converted or read at once when streaming.
+const format::size_type chunk_frame_count = 65536;
+
+bool is_little_endian () noexcept {
+	const uint16_t probe = 1;
+	return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+}
+
+template <typename T>
+T swap_bytes (T value) noexcept {
+	unsigned char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	std::reverse(bytes, bytes + sizeof(T));
+	std::memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+template <typename T>
+T from_little_endian (const unsigned char *bytes) noexcept {
+	T value;
+	std::memcpy(&value, bytes, sizeof(T));
+	return is_little_endian() ? value : swap_bytes(value);
+}
+
+// Converts `count` samples stored with the given encoding to floats.
+void to_samples (
+		enum raw_format::encoding encoding,
+		const unsigned char *bytes,
+		size_t count,
+		float *samples) noexcept {
+	switch (encoding) {
+	case raw_format::Float32:
+		if (is_little_endian()) {
+			std::memcpy(samples, bytes, count*sizeof(float));
+		} else {
+			for (size_t i = 0; i < count; ++i, bytes += sizeof(float)) {
+				samples[i] = from_little_endian<float>(bytes);
+			}
+		}
+		break;
+
+	case raw_format::Int16:
+		for (size_t i = 0; i < count; ++i, bytes += sizeof(int16_t)) {
+			samples[i] = value_to_sample(from_little_endian<int16_t>(bytes));
+		}
+		break;
+	}
+}
+
+// Converts `count` floats to samples stored with the given encoding.
+void from_samples (
+		enum raw_format::encoding encoding,
+		const float *samples,
+		size_t count,
+		unsigned char *bytes) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		switch (encoding) {
+		case raw_format::Float32: {
+				float value = is_little_endian()
+					? samples[i]
+					: swap_bytes(samples[i]);
+				std::memcpy(bytes, &value, sizeof(float));
+				bytes += sizeof(float);
+			}
+			break;
+
+		case raw_format::Int16: {
+				int16_t value = sample_to_value<int16_t>(samples[i]);
+				if (! is_little_endian()) {
+					value = swap_bytes(value);
+				}
+				std::memcpy(bytes, &value, sizeof(int16_t));
+				bytes += sizeof(int16_t);
+			}
+			break;
+		}
+	}
+}
+
+// Reads up to `frame_count` frames from the stream at its current position.
+sequence read (
+		std::istream &in,
+		const raw_format &raw,
+		format::size_type frame_count) {
+	const size_t frame_size = raw.frame_size();
+	const size_t channel_count = raw.format.channel_count();
+	const bool in_place = raw.encoding == raw_format::Float32
+		&& is_little_endian();
+
+	sequence seq(raw.format);
+	std::vector<unsigned char> buffer;
+
+	if (! in_place) {
+		buffer.resize(chunk_frame_count*frame_size);
+	}
+
+	while (frame_count > 0 && in) {
+		format::size_type count = std::min(frame_count, chunk_frame_count);
+		format::size_type offset = seq.frame_count();
+
+		seq.set_frame_count(offset + count);
+
+		unsigned char *dst = in_place
+			? reinterpret_cast<unsigned char *>(seq.data(offset))
+			: buffer.data();
+
+		in.read(reinterpret_cast<char *>(dst), count*frame_size);
+
+		format::size_type read_count = in.gcount()/frame_size;
+
+		if (! in_place) {
+			to_samples(raw.encoding, dst, read_count*channel_count,
+				seq.data(offset));
+		}
+		seq.set_frame_count(offset + read_count);
+		frame_count -= read_count;
+
+		if (read_count < count) {
+			break;
+		}
+	}
+
+	return seq;
+}
+
+std::shared_ptr<const utils::mapped_file> map (const std::string &filepath) {
+	auto file = std::make_shared<const utils::mapped_file>(filepath);
+
+	if (! file->is_open()) {
+		error::raise(error::IOError, "failed to map " + filepath);
+	}
+
+	return file;
+}
+
+// Converts up to `frame_count` frames of the given bytes into the given
+// sequence, which must be empty and of the format of the bytes.
+void decode (
+		const unsigned char *data,
+		size_t size,
+		const raw_format &raw,
+		format::size_type first_frame,
+		format::size_type frame_count,
+		sequence &seq) {
+	const size_t frame_size = raw.frame_size();
+	const format::size_type total = size/frame_size;
+
+	if (first_frame < total) {
+		frame_count = std::min(frame_count, total - first_frame);
+		seq.set_frame_count(frame_count);
+		to_samples(
+			raw.encoding,
+			data + first_frame*frame_size,
+			frame_count*raw.format.channel_count(),
+			seq.data(0));
+	}
+}
+
+} // namespace raw_
+
+size_t raw_format::frame_size () const noexcept {
+	return format.channel_count()
+		*(encoding == Float32 ? sizeof(float) : sizeof(int16_t));
+}
+
+std::string raw_format::sidecar_path (const std::string &filepath) {
+	return filepath + ".format";
+}
+
+raw_format raw_format::load (const std::string &filepath) {
+	std::ifstream in(sidecar_path(filepath));
+
+	if (! in) {
+		error::raise(error::IOError,
+			"failed to open " + sidecar_path(filepath));
+	}
+
+	std::string encoding;
+	unsigned int channel_count, sample_rate;
+
+	if (! (in >> encoding >> channel_count >> sample_rate)) {
+		error::raise_literal(error::CodecFormatError, "malformed raw PCM format");
+	}
+
+	if (encoding == "f32") {
+		return raw_format{Float32, audio::format(channel_count, sample_rate)};
+	}
+	if (encoding == "s16") {
+		return raw_format{Int16, audio::format(channel_count, sample_rate)};
+	}
+
+	error::raise(error::CodecFormatError,
+		"unhandled raw PCM encoding " + encoding);
+	return raw_format{Float32, audio::format(channel_count, sample_rate)};
+}
+
+void raw_format::save (const std::string &filepath) const {
+	std::ofstream out(sidecar_path(filepath));
+
+	out << (encoding == Float32 ? "f32" : "s16") << ' '
+		<< format.channel_count() << ' '
+		<< format.sample_rate() << '\n';
+
+	if (! out) {
+		error::raise(error::IOError,
+			"failed to write " + sidecar_path(filepath));
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Coder /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+RAW_coder::RAW_coder (enum raw_format::encoding encoding) :
+	encoding_(encoding) {
+}
+
+void
+RAW_coder::encode_ (std::ostream &out, const sequence &seq) const {
+	const raw_format raw{encoding_, seq.format()};
+	const size_t frame_size = raw.frame_size();
+	const size_t channel_count = seq.format().channel_count();
+	const format::size_type frame_count = seq.frame_count();
+
+	if (encoding_ == raw_format::Float32 && raw_::is_little_endian()) {
+		if (frame_count > 0) {
+			out.write(reinterpret_cast<const char *>(seq.data(0)),
+				frame_count*frame_size);
+		}
+	} else {
+		std::vector<unsigned char> buffer(
+			std::min(frame_count, raw_::chunk_frame_count)*frame_size);
+
+		for (format::size_type offset = 0; offset < frame_count;) {
+			format::size_type count =
+				std::min(frame_count - offset, raw_::chunk_frame_count);
+
+			raw_::from_samples(encoding_, seq.data(offset),
+				count*channel_count, buffer.data());
+			out.write(reinterpret_cast<const char *>(buffer.data()),
+				count*frame_size);
+			offset += count;
+		}
+	}
+
+	if (! out) {
+		error::raise_literal(error::IOError, "failed to write raw PCM stream");
+	}
+}
+
+void
+RAW_coder::encode_file_ (const std::string &filepath, const sequence &seq) const {
+	coder::encode_file_(filepath, seq);
+	raw_format{encoding_, seq.format()}.save(filepath);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Decoder ///////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+RAW_decoder::mapping::mapping (
+		std::shared_ptr<const utils::mapped_file> file,
+		const class format &format) :
+	file_(std::move(file)),
+	format_(format),
+	data_(static_cast<const float *>(file_->data())),
+	frame_count_(file_->size()/(format.channel_count()*sizeof(float))) {
+}
+
+sequence
+RAW_decoder::mapping::copy () const {
+	sequence seq(format_);
+
+	if (frame_count_ > 0) {
+		seq.set_frame_count(frame_count_);
+		std::memcpy(seq.data(0), data_,
+			frame_count_*format_.channel_count()*sizeof(float));
+	}
+
+	return seq;
+}
+
+RAW_decoder::RAW_decoder () {
+}
+
+RAW_decoder::RAW_decoder (const raw_format &format) :
+	format_(std::make_shared<const raw_format>(format)) {
+}
+
+RAW_decoder::mapping
+RAW_decoder::map (const std::string &filepath) const {
+	const raw_format raw = file_format_(filepath);
+
+	if (raw.encoding != raw_format::Float32 || ! raw_::is_little_endian()) {
+		error::raise_literal(error::CodecFormatError,
+			"only native float raw PCM files can be mapped");
+	}
+
+	return mapping(raw_::map(filepath), raw.format);
+}
+
+sequence
+RAW_decoder::decode_ (std::istream &in) const {
+	return decode_range_(in, 0, static_cast<format::size_type>(-1));
+}
+
+sequence
+RAW_decoder::decode_file_ (const std::string &filepath) const {
+	return decode_file_range_(filepath, 0, static_cast<format::size_type>(-1));
+}
+
+sequence
+RAW_decoder::decode_file_range_ (
+		const std::string &filepath,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	const raw_format raw = file_format_(filepath);
+	const auto file = raw_::map(filepath);
+
+	sequence seq(raw.format);
+	raw_::decode(
+		static_cast<const unsigned char *>(file->data()), file->size(),
+		raw, first_frame, frame_count, seq);
+
+	return seq;
+}
+
+void
+RAW_decoder::decode_file_into_ (const std::string &filepath, sequence &dst)
+	const {
+	const raw_format raw = file_format_(filepath);
+	const auto file = raw_::map(filepath);
+
+	dst.reset(raw.format);
+	raw_::decode(
+		static_cast<const unsigned char *>(file->data()), file->size(),
+		raw, 0, static_cast<format::size_type>(-1), dst);
+}
+
+void
+RAW_decoder::decode_source_into_ (utils::byte_source &source, sequence &dst)
+	const {
+	if (source.data() == nullptr) {
+		decoder::decode_source_into_(source, dst);
+		return;
+	}
+
+	const raw_format raw = stream_format_();
+	const size_t offset = source.tell();
+
+	dst.reset(raw.format);
+	raw_::decode(source.data() + offset, source.size() - offset,
+		raw, 0, static_cast<format::size_type>(-1), dst);
+	source.seek(source.size());
+}
+
+sequence
+RAW_decoder::decode_range_ (
+		std::istream &in,
+		format::size_type first_frame,
+		format::size_type frame_count) const {
+	const raw_format raw = stream_format_();
+
+	if (first_frame > 0) {
+		in.seekg(first_frame*raw.frame_size(), std::ios::cur);
+		if (! in) {
+			return sequence(raw.format);
+		}
+	}
+
+	return raw_::read(in, raw, frame_count);
+}
+
+codec::info
+RAW_decoder::probe_ (std::istream &in) const {
+	const raw_format raw = stream_format_();
+	std::streampos pos = in.tellg();
+
+	in.seekg(0, std::ios::end);
+	if (pos < 0 || ! in) {
+		error::raise_literal(error::IOError, "input stream is not seekable");
+	}
+
+	format::size_type size = in.tellg() - pos;
+	in.seekg(pos);
+
+	return codec::info{
+		"raw",
+		raw.format,
+		size/raw.frame_size(),
+		static_cast<unsigned int>(8*raw.frame_size()*raw.format.sample_rate())
+	};
+}
+
+codec::info
+RAW_decoder::probe_file_ (const std::string &filepath) const {
+	const raw_format raw = file_format_(filepath);
+	std::ifstream in(filepath, std::ifstream::binary|std::ifstream::ate);
+
+	if (! in) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	format::size_type size = in.tellg();
+
+	return codec::info{
+		"raw",
+		raw.format,
+		size/raw.frame_size(),
+		static_cast<unsigned int>(8*raw.frame_size()*raw.format.sample_rate())
+	};
+}
+
+raw_format
+RAW_decoder::stream_format_ () const {
+	if (! format_) {
+		error::raise_literal(error::CodecFormatError, "unknown raw PCM format");
+	}
+	return *format_;
+}
+
+raw_format
+RAW_decoder::file_format_ (const std::string &filepath) const {
+	return format_ ? *format_ : raw_format::load(filepath);
+}
@@ -0,0 +1,38 @@
+/// audio_raw_coder.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_RAW_CODER_H_
+#define AUDIO_RAW_CODER_H_
+
+#include <audio/codecs/coder>
+#include <audio/codecs/raw_format>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+class sequence;
+namespace codec {
+class RAW_coder : public coder {
+public:
+	/// Constructs a `RAW_coder`. Files are written with their sidecar,
+	/// see `raw_format`. Streams only get the samples.
+	///
+	/// *Parameters:*
+	/// - `encoding`
+	///   The encoding of the samples. `Float32` streams hold the samples
+	///   of the `sequence` unchanged.
+	explicit RAW_coder (enum raw_format::encoding encoding = raw_format::Float32);
+
+protected:
+	virtual void encode_ (std::ostream &, const sequence &) const;
+	virtual void encode_file_ (const std::string &, const sequence &) const;
+
+private:
+	enum raw_format::encoding encoding_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_RAW_CODER_H_ */
@@ -0,0 +1,105 @@
+/// audio_raw_decoder.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_RAW_DECODER_H_
+#define AUDIO_RAW_DECODER_H_
+
+#include <audio/codecs/decoder>
+#include <audio/codecs/raw_format>
+
+#include <memory>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+class mapped_file;
+} /* namespace utils */
+namespace audio {
+class sequence;
+namespace codec {
+class RAW_decoder : public decoder {
+public:
+	/// class com::nealrame::audio::codec::RAW_decoder::mapping
+	/// =======================================================
+	/// The frames of a `Float32` raw file, mapped in memory. The frames
+	/// are read from the file as they are accessed and stay valid as long
+	/// as the `mapping` or one of its copies exists.
+	class mapping {
+	public:
+		/// Returns the format of the frames.
+		const class format & format () const noexcept
+		{ return format_; }
+
+		/// Returns the count of frames.
+		format::size_type frame_count () const noexcept
+		{ return frame_count_; }
+
+		/// Returns the interleaved samples starting at the given frame.
+		const float * data (format::size_type index) const noexcept
+		{ return data_ + index*format_.channel_count(); }
+
+		/// Copies the frames to a `sequence`.
+		sequence copy () const;
+
+	private:
+		friend class RAW_decoder;
+		mapping (
+			std::shared_ptr<const utils::mapped_file> file,
+			const class format &format);
+
+	private:
+		std::shared_ptr<const utils::mapped_file> file_;
+		class format format_;
+		const float *data_;
+		format::size_type frame_count_;
+	};
+
+public:
+	/// Constructs a `RAW_decoder` reading the `raw_format` of files from
+	/// their sidecar. Streams can not be decoded.
+	RAW_decoder ();
+
+	/// Constructs a `RAW_decoder` for streams and files of the given
+	/// `raw_format`.
+	explicit RAW_decoder (const raw_format &format);
+
+public:
+	/// Maps the given file in memory, without copying its frames.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of a raw file of `Float32` samples.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	mapping map (const std::string &filepath) const;
+
+protected:
+	virtual sequence decode_ (std::istream &) const;
+	virtual sequence decode_file_ (const std::string &) const;
+	virtual void decode_file_into_ (const std::string &, sequence &) const;
+	virtual void decode_source_into_ (utils::byte_source &, sequence &) const;
+	virtual sequence decode_file_range_ (
+			const std::string &,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+	virtual sequence decode_range_ (
+			std::istream &,
+			format::size_type first_frame,
+			format::size_type frame_count) const;
+	virtual info probe_ (std::istream &) const;
+	virtual info probe_file_ (const std::string &) const;
+
+private:
+	raw_format stream_format_ () const;
+	raw_format file_format_ (const std::string &filepath) const;
+
+private:
+	std::shared_ptr<const raw_format> format_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_RAW_DECODER_H_ */
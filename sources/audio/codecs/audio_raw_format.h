@@ -0,0 +1,68 @@
+/// audio_raw_format.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_RAW_FORMAT_H_
+#define AUDIO_RAW_FORMAT_H_
+
+#include <audio/error>
+#include <audio/format>
+
+#include <cstddef>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// struct com::nealrame::audio::codec::raw_format
+/// ==============================================
+/// Layout of a headerless PCM stream: interleaved little endian samples.
+///
+/// Files written by `RAW_coder` come with a sidecar text file holding
+/// their `raw_format`, named after them with a `.format` suffix.
+struct raw_format {
+	enum encoding {
+		/// 32 bits IEEE float samples, as stored by `sequence`.
+		Float32,
+		/// 16 bits signed integer samples.
+		Int16,
+	};
+
+	/// Encoding of the samples.
+	enum encoding encoding;
+
+	/// Audio format of the stream.
+	class format format;
+
+	/// Returns the size in bytes of a frame.
+	size_t frame_size () const noexcept;
+
+	/// Returns the path of the sidecar file of the given raw file.
+	static std::string sidecar_path (const std::string &filepath);
+
+	/// Reads the `raw_format` of the given raw file from its sidecar.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the raw file.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	static raw_format load (const std::string &filepath);
+
+	/// Writes this `raw_format` to the sidecar of the given raw file.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the raw file.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	void save (const std::string &filepath) const;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_RAW_FORMAT_H_ */
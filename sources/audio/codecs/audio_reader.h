@@ -0,0 +1,58 @@
+/// audio_reader.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_READER_H_
+#define AUDIO_READER_H_
+
+#include <audio/error>
+#include <audio/format>
+
+#include <system_error>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+class sequence;
+namespace codec {
+/// class com::nealrame::audio::codec::reader
+/// =========================================
+/// Decodes a stream a few frames at a time. See `decoder::open`.
+class reader {
+public:
+	virtual ~reader ();
+
+public:
+	/// Returns the format of the decoded frames.
+	virtual const class format & format () const noexcept = 0;
+
+	/// Decodes at most the given count of frames and appends them to the
+	/// given sequence.
+	///
+	/// *Parameters:*
+	/// - `seq`
+	///   A sequence of the format of this reader.
+	/// - `frame_count`
+	///   The requested count of frames.
+	///
+	/// *Returns:*
+	/// The count of frames actually read. Fewer frames than requested are
+	/// read only at the end of the stream.
+	///
+	/// *Exceptions:*
+	/// - `error`
+	virtual format::size_type read (sequence &seq, format::size_type frame_count) = 0;
+
+	/// Same as above, but failures are reported through `ec` instead of
+	/// an exception. `ec` is cleared on success, see `error::capture`.
+	/// Readers still throw on failure, the exception is caught here.
+	format::size_type read (
+			sequence &seq,
+			format::size_type frame_count,
+			std::error_code &ec) noexcept;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_READER_H_ */
@@ -0,0 +1,199 @@
+/// audio_registry.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "audio_registry.h"
+
+#include "audio_wave_coder.h"
+#include "audio_wave_decoder.h"
+#include "audio_flac_coder.h"
+#include "audio_flac_decoder.h"
+#include "audio_mp3_coder.h"
+#include "audio_mp3_decoder.h"
+#include "audio_ogg_vorbis_coder.h"
+#include "audio_ogg_vorbis_decoder.h"
+#include "audio_raw_coder.h"
+#include "audio_raw_decoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+
+using namespace com::nealrame::audio;
+using com::nealrame::audio::codec::registry;
+
+namespace registry_ {
+
+template <typename Decoder, typename Coder>
+registry::entry make_entry (
+		std::string name,
+		std::vector<std::string> extensions,
+		bool (*sniff) (const unsigned char *, size_t)) {
+	return registry::entry{
+		std::move(name),
+		std::move(extensions),
+		sniff,
+		std::make_shared<Decoder>(),
+		std::make_shared<Coder>(),
+		[](const codec::encoder_options &options) -> std::shared_ptr<codec::coder> {
+			return std::make_shared<Coder>(options);
+		},
+		[](unsigned int thread_count) -> std::shared_ptr<codec::decoder> {
+			return std::make_shared<Decoder>(thread_count);
+		}
+	};
+}
+
+bool equals_ignore_case (const std::string &lhs, const std::string &rhs) {
+	return lhs.size() == rhs.size()
+		&& std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+			[](char a, char b) {
+				return std::tolower(static_cast<unsigned char>(a))
+					== std::tolower(static_cast<unsigned char>(b));
+			});
+}
+
+} // namespace registry_
+
+// Entries are listed from the most recently registered one, which has
+// precedence. A node is immutable once published.
+struct registry::node_ {
+	const entry value;
+	const node_ *const next;
+};
+
+registry::registry () :
+	head_(nullptr) {
+	add(registry::entry{
+		"wave",
+		{ ".wav", ".wave" },
+		&codec::WAVE_decoder::sniff,
+		std::make_shared<codec::WAVE_decoder>(),
+		std::make_shared<codec::WAVE_coder>(),
+		[](const codec::encoder_options &) -> std::shared_ptr<codec::coder> {
+			return std::make_shared<codec::WAVE_coder>();
+		},
+		[](unsigned int thread_count) -> std::shared_ptr<codec::decoder> {
+			return std::make_shared<codec::WAVE_decoder>(thread_count);
+		}
+	});
+	add(registry_::make_entry<codec::MP3_decoder, codec::MP3_coder>(
+		"mp3",
+		{ ".mp3" },
+		&codec::MP3_decoder::sniff
+	));
+	add(registry_::make_entry<codec::OGGVorbis_decoder, codec::OGGVorbis_coder>(
+		"vorbis",
+		{ ".ogg", ".oga" },
+		&codec::OGGVorbis_decoder::sniff
+	));
+	add(registry_::make_entry<codec::FLAC_decoder, codec::FLAC_coder>(
+		"flac",
+		{ ".flac" },
+		&codec::FLAC_decoder::sniff
+	));
+
+	// raw PCM streams have no magic bytes, their format is read from the
+	// sidecar of their files
+	auto raw_decoder = std::make_shared<codec::RAW_decoder>();
+	for (auto encoding: { codec::raw_format::Float32, codec::raw_format::Int16 }) {
+		auto raw_coder = std::make_shared<codec::RAW_coder>(encoding);
+		add(registry::entry{
+			"raw",
+			encoding == codec::raw_format::Float32
+				? std::vector<std::string>{ ".f32", ".raw" }
+				: std::vector<std::string>{ ".s16" },
+			nullptr,
+			raw_decoder,
+			raw_coder,
+			[raw_coder](const codec::encoder_options &) -> std::shared_ptr<codec::coder> {
+				return raw_coder;
+			}
+		});
+	}
+}
+
+registry & registry::instance () {
+	static registry instance_;
+	return instance_;
+}
+
+registry::~registry () {
+	const node_ *node = head_.load();
+
+	while (node != nullptr) {
+		const node_ *next = node->next;
+		delete node;
+		node = next;
+	}
+}
+
+void registry::add (entry e) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	head_.store(
+		new node_{ std::move(e), head_.load(std::memory_order_relaxed) },
+		std::memory_order_release);
+}
+
+const registry::entry * registry::find_extension (const std::string &extension)
+	const noexcept {
+	for (const node_ *node = head_.load(std::memory_order_acquire);
+			node != nullptr; node = node->next) {
+		for (const std::string &ext: node->value.extensions) {
+			if (registry_::equals_ignore_case(ext, extension)) {
+				return &node->value;
+			}
+		}
+	}
+	return nullptr;
+}
+
+const registry::entry * registry::find_content (const void *data, size_t size)
+	const noexcept {
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+	for (const node_ *node = head_.load(std::memory_order_acquire);
+			node != nullptr; node = node->next) {
+		if (node->value.sniff != nullptr && node->value.sniff(bytes, size)) {
+			return &node->value;
+		}
+	}
+	return nullptr;
+}
+
+const registry::entry * registry::find_content (std::istream &stream) const {
+	char data[sniff_size];
+	std::streampos pos = stream.tellg();
+
+	if (pos < 0) {
+		error::raise_literal(error::IOError, "input stream is not seekable");
+	}
+
+	stream.read(data, sniff_size);
+	std::streamsize size = stream.gcount();
+
+	stream.clear();
+	stream.seekg(pos);
+
+	return find_content(data, size);
+}
+
+const registry::entry * registry::find_file (const std::string &filepath) const {
+	std::ifstream in(filepath, std::ifstream::binary);
+
+	if (! in) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	const entry *e = find_content(in);
+
+	if (e == nullptr) {
+		std::string::size_type dot = filepath.find_last_of("./");
+		if (dot != std::string::npos && filepath[dot] == '.') {
+			e = find_extension(filepath.substr(dot));
+		}
+	}
+
+	return e;
+}
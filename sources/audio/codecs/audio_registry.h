@@ -0,0 +1,136 @@
+/// audio_registry.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef AUDIO_REGISTRY_H_
+#define AUDIO_REGISTRY_H_
+
+#include <audio/codecs/coder>
+#include <audio/codecs/decoder>
+#include <audio/codecs/encoder_options>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace com {
+namespace nealrame {
+namespace audio {
+namespace codec {
+/// class com::nealrame::audio::codec::registry
+/// ===========================================
+/// The known codecs. A codec is found either by a file extension or by
+/// the magic bytes starting its streams. The built-in codecs are
+/// registered when the registry is first used, others can register
+/// themselves with a static `registry::registrar`.
+///
+/// Codecs may be registered and looked up from several threads. Entries
+/// are never moved nor removed, the entries returned by lookups stay
+/// valid as long as the program runs. Registrations are serialized, but
+/// lookups take no lock: each entry is published atomically in front of
+/// the older ones.
+class registry {
+public:
+	/// struct com::nealrame::audio::codec::registry::entry
+	/// ===================================================
+	struct entry {
+		/// Name of the codec, as in `info::codec`.
+		std::string name;
+
+		/// Extensions of the files of the codec, with their leading
+		/// dot.
+		std::vector<std::string> extensions;
+
+		/// Returns `true` if the given first bytes of a stream belong
+		/// to this codec. May be null if the codec has no magic bytes.
+		bool (*sniff) (const unsigned char *data, size_t size);
+
+		/// The shared decoder of the codec. May be null.
+		std::shared_ptr<codec::decoder> shared_decoder;
+
+		/// The shared coder of the codec, with default settings. May
+		/// be null.
+		std::shared_ptr<codec::coder> shared_coder;
+
+		/// Builds a coder with the given settings. May be null.
+		std::function<std::shared_ptr<codec::coder> (const encoder_options &)>
+			make_coder;
+
+		/// Builds a decoder using the given count of threads. May be
+		/// null.
+		std::function<std::shared_ptr<codec::decoder> (unsigned int)>
+			make_decoder;
+
+		/// Version of the decoder. It must be bumped when the decoded
+		/// sequences change, so that the decoded sequences kept by a
+		/// `cache` are not used anymore.
+		unsigned int version = 1;
+	};
+
+	/// struct com::nealrame::audio::codec::registry::registrar
+	/// =======================================================
+	/// Registers the given codec when constructed.
+	struct registrar {
+		registrar (entry e)
+		{ registry::instance().add(std::move(e)); }
+	};
+
+public:
+	/// Count of bytes needed by the sniffers to recognize a stream.
+	static const size_t sniff_size = 4096;
+
+public:
+	/// Returns the registry.
+	static registry & instance ();
+
+public:
+	/// Registers the given codec. Codecs registered later have
+	/// precedence over codecs registered sooner.
+	void add (entry e);
+
+	/// Returns the codec of the files with the given extension, or null
+	/// if there is none. Extensions are compared case insensitively.
+	///
+	/// *Parameters:*
+	/// - `extension`
+	///   A file extension with its leading dot.
+	const entry * find_extension (const std::string &extension) const noexcept;
+
+	/// Returns the codec of the stream starting with the given bytes, or
+	/// null if there is none.
+	///
+	/// *Parameters:*
+	/// - `data`
+	///   The first bytes of the stream, up to `sniff_size` bytes.
+	/// - `size`
+	///   The count of bytes.
+	const entry * find_content (const void *data, size_t size) const noexcept;
+
+	/// Returns the codec of the given stream, or null if there is none.
+	/// The first bytes of the stream are read then put back, the stream
+	/// must be seekable.
+	const entry * find_content (std::istream &stream) const;
+
+	/// Returns the codec of the given file, found by its content or else
+	/// by its extension. Returns null if there is none.
+	const entry * find_file (const std::string &filepath) const;
+
+private:
+	registry ();
+	~registry ();
+
+private:
+	struct node_;
+
+	std::mutex mutex_;
+	std::atomic<const node_ *> head_;
+};
+} /* namespace codec */
+} /* namespace audio */
+} /* namespace nealrame */
+} /* namespace com */
+#endif /* AUDIO_REGISTRY_H_ */
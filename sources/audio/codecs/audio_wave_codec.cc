@@ -7,12 +7,19 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <istream>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 #include <audio/sequence>
 #include <audio/error>
 #include <audio/sample>
+#include <utils/buffer>
+#include <utils/byte_source>
+#include <utils/parallel>
 
 #if defined(DEBUG)
 #	include <iostream>
@@ -24,6 +31,7 @@
 #	endif
 #endif
 
+using namespace com::nealrame;
 using namespace com::nealrame::audio;
 using com::nealrame::audio::codec::WAVE_coder;
 using com::nealrame::audio::codec::WAVE_decoder;
@@ -50,6 +58,12 @@ struct WaveDataChunk {
 	uint32_t size;
 } __attribute__((packed));
 
+enum WaveAudioFormat {
+	WavePCMFormat = 0x0001,
+	WaveMSADPCMFormat = 0x0002,
+	WaveIMAADPCMFormat = 0x0011,
+};
+
 #if defined (DEBUG) && (defined(DEBUG_WAVE_CODER)||defined(DEBUG_WAVE_CODER))
 
 template<int N>
@@ -129,92 +143,637 @@ inline void check_data<WaveDataChunk> (WaveDataChunk &data) {
 }
 
 template <typename T>
-inline void read (std::istream &in, T &data) {
-	in.read(reinterpret_cast<char *>(&data), sizeof(T));
-	if (in.gcount() != sizeof(T)) {
+inline void read (utils::byte_source &in, T &data) {
+	if (in.read(&data, sizeof(T)) != sizeof(T)) {
 		error::raise(error::IOError);
 	}
 	check_data<T>(data);
 }
 
+namespace wave_ {
+
+struct header {
+	WaveFormatChunk format_chunk;
+	WaveDataChunk data_chunk;
+
+	/// ADPCM only, 0 if the format chunk does not tell.
+	uint16_t frames_per_block;
+
+	/// MS ADPCM only, pairs of predictor coefficients.
+	std::vector<int16_t> coefficients;
+
+	/// Count of frames of the fact chunk, 0 if there is none.
+	uint32_t fact_frame_count;
+};
+
 template <typename T>
-inline void read (std::istream &in, std::vector<T> &pcm_buf) {
-	in.read(reinterpret_cast<char *>(pcm_buf.data()), sizeof(T)*pcm_buf.size());
-	pcm_buf.resize(in.gcount()/sizeof(T));
+T read_le (const unsigned char *data) {
+	typename std::make_unsigned<T>::type value = 0;
+	for (size_t i = sizeof(T); i-- > 0;) {
+		value = (value << 8) | data[i];
+	}
+	return static_cast<T>(value);
 }
 
-template <typename T>
-inline 
-format::size_type fill_audio_buffer (const std::vector<T> &pcm_buf, sequence &seq) {
-	format::size_type channel_count = seq.format().channel_count();
-	format::size_type frame_count = pcm_buf.size()/channel_count;
-	format::size_type total_frame_count = seq.frame_count() + frame_count;
-
-	auto it = pcm_buf.begin();
-	std::for_each(
-		seq.set_frame_count(total_frame_count), seq.end(),
-		[&](sequence::frame frame) {
-			for (float &sample: frame) {
-				sample = value_to_sample<T>(*it++);
-			}
+void read_bytes (utils::byte_source &in, std::vector<unsigned char> &data) {
+	if (in.read(data.data(), data.size()) != data.size()) {
+		error::raise(error::IOError);
+	}
+}
+
+// Moves past the next `size` bytes of the source without copying them.
+// Sizes come from the file and are checked against the source first.
+void skip_bytes (utils::byte_source &in, uint64_t size) {
+	if (in.seekable() && in.size() != utils::byte_source::unknown_size) {
+		const size_t offset = in.tell();
+		if (offset > in.size() || size > in.size() - offset
+				|| ! in.seek(offset + size)) {
+			error::raise(error::IOError);
 		}
-	);
-	return frame_count;
+		return;
+	}
+	while (size > 0) {
+		utils::byte_source::span span = in.read(
+			std::min<uint64_t>(size, std::numeric_limits<size_t>::max()));
+		if (span.size == 0) {
+			error::raise(error::IOError);
+		}
+		size -= span.size;
+	}
 }
 
+// Returns the next `size` bytes of the source, or less at its end. They
+// are copied to the given buffer only if the source does not give them
+// at once.
+utils::byte_source::span read_contiguous (
+		utils::byte_source &in,
+		size_t size,
+		utils::buffer &storage) {
+	utils::byte_source::span span = in.read(size);
+
+	if (span.size == size || span.size == 0) {
+		return span;
+	}
+
+	storage.resize(0);
+	do {
+		storage.append(span.data, span.size);
+		size -= span.size;
+	} while (size > 0 && (span = in.read(size)).size > 0);
+
+	return utils::byte_source::span{
+		storage.data<unsigned char>(),
+		storage.size()
+	};
+}
+
+// Decodes the PCM samples of the data chunk. The samples are converted
+// straight from the spans of the source.
 template <typename T>
-void read_data_chunk (std::istream &in, sequence &seq) {
-	format::size_type channel_count = seq.format().channel_count();
-	format::size_type frame_count = seq.capacity();
+void read_data_chunk (utils::byte_source &in, size_t size, sequence &seq) {
+	const format::size_type channel_count = seq.format().channel_count();
+	const size_t sample_count = size/(sizeof(T)*channel_count)*channel_count;
+
+	seq.set_frame_count(sample_count/channel_count);
+
+	float *pcm = sample_count > 0 ? seq.data(0) : nullptr;
+	size_t remaining = sample_count*sizeof(T);
+	size_t count = 0;
+
+	// a sample may be split over two spans
+	unsigned char carry[sizeof(T)];
+	size_t carry_size = 0;
+
+	while (remaining > 0) {
+		utils::byte_source::span span = in.read(remaining);
+		if (span.size == 0) {
+			break;
+		}
+		remaining -= span.size;
+
+		const unsigned char *data = span.data;
+		const unsigned char *end = span.data + span.size;
 
-	std::vector<T> pcm_buffer;
-	pcm_buffer.reserve(1024*channel_count);
+		if (carry_size > 0) {
+			size_t n = std::min<size_t>(sizeof(T) - carry_size, end - data);
+			std::memcpy(carry + carry_size, data, n);
+			carry_size += n;
+			data += n;
+			if (carry_size == sizeof(T)) {
+				pcm[count++] = value_to_sample<T>(read_le<T>(carry));
+				carry_size = 0;
+			}
+		}
 
-	while (frame_count > 0 && ! in.eof()) {
-		format::size_type n = std::min<format::size_type>(frame_count, 1024);
+		for (; end - data >= ptrdiff_t(sizeof(T)); data += sizeof(T)) {
+			pcm[count++] = value_to_sample<T>(read_le<T>(data));
+		}
 
-		pcm_buffer.resize(n*channel_count);
-		read(in, pcm_buffer);
-		frame_count -= fill_audio_buffer<T>(pcm_buffer, seq);
+		carry_size = end - data;
+		std::memcpy(carry, data, carry_size);
 	}
+
+	seq.set_frame_count(count/channel_count);
 }
 
-sequence
-WAVE_decoder::decode_ (std::istream &in) const throw(error) {
+} // namespace wave_
+
+inline void read_header (utils::byte_source &in, wave_::header &header) {
 	RIFFHeaderChunk header_chunk;
 	read(in, header_chunk);
-	
-	WaveFormatChunk format_chunk;
-	read(in, format_chunk);
-	
-	WaveDataChunk data_chunk;
-	read(in, data_chunk);
+	read(in, header.format_chunk);
 
-	format::size_type frame_count =
-		data_chunk.size/format_chunk.bytePerFrame;
+	WaveFormatChunk &format_chunk = header.format_chunk;
+	header.frames_per_block = 0;
+	header.fact_frame_count = 0;
 
-	sequence seq(format(
-		format_chunk.channelCount,
-		format_chunk.sampleRate));
+	// ADPCM formats extend the PCM format chunk
+	size_t pcm_size = sizeof(WaveFormatChunk) - 8;
+	if (format_chunk.size < pcm_size) {
+		error::raise(error::CodecFormatError);
+	}
+
+	// sizes of the data are divided by both
+	if (format_chunk.channelCount == 0 || format_chunk.bytePerFrame == 0) {
+		error::raise(error::CodecFormatError);
+	}
+
+	// only the fields read below are copied, the rest is skipped
+	uint64_t extension_size =
+		uint64_t(format_chunk.size) - pcm_size + (format_chunk.size & 1);
+
+	std::vector<unsigned char> extension(std::min<uint64_t>(extension_size, 6));
+	wave_::read_bytes(in, extension);
+	extension_size -= extension.size();
+
+	if ((format_chunk.audioFormat == WaveIMAADPCMFormat
+			|| format_chunk.audioFormat == WaveMSADPCMFormat)
+		&& extension.size() >= 4) {
+		header.frames_per_block = wave_::read_le<uint16_t>(&extension[2]);
+	}
+
+	if (format_chunk.audioFormat == WaveMSADPCMFormat && extension.size() >= 6) {
+		size_t count = wave_::read_le<uint16_t>(&extension[4]);
+		std::vector<unsigned char> coefficients(
+			std::min<uint64_t>(extension_size, 4*count));
+		wave_::read_bytes(in, coefficients);
+		extension_size -= coefficients.size();
+
+		for (size_t i = 0; i + 1 < coefficients.size(); i += 2) {
+			header.coefficients.push_back(
+				wave_::read_le<int16_t>(&coefficients[i]));
+		}
+	}
+
+	wave_::skip_bytes(in, extension_size);
+
+	// skip the chunks up to the data one
+	for (;;) {
+		WaveDataChunk &chunk = header.data_chunk;
+
+		if (in.read(&chunk, sizeof(WaveDataChunk)) != sizeof(WaveDataChunk)) {
+			error::raise(error::IOError);
+		}
+
+		if (strncmp(chunk.id, "data", 4) == 0) {
+			break;
+		}
+
+		// widened first, a size of 0xFFFFFFFF is padded past 32 bits
+		uint64_t size = uint64_t(chunk.size) + (chunk.size & 1);
+
+		if (strncmp(chunk.id, "fact", 4) == 0 && size >= 4) {
+			unsigned char frame_count[4];
+			if (in.read(frame_count, sizeof(frame_count)) != sizeof(frame_count)) {
+				error::raise(error::IOError);
+			}
+			header.fact_frame_count = wave_::read_le<uint32_t>(frame_count);
+			size -= sizeof(frame_count);
+		}
+
+		wave_::skip_bytes(in, size);
+	}
+
+	debug_wave_data_chunk(header.data_chunk);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ADPCM /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace wave_ {
+
+const int ima_index_table[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+const int ima_step_table[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+	41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+	190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+	724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+	7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818,
+	18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+const int ms_adaptation_table[16] = {
+	230, 230, 230, 230, 307, 409, 512, 614,
+	768, 614, 512, 409, 307, 230, 230, 230,
+};
+
+const int16_t ms_coefficients[7][2] = {
+	{ 256,    0 },
+	{ 512, -256 },
+	{   0,    0 },
+	{ 192,   64 },
+	{ 240,    0 },
+	{ 460, -208 },
+	{ 392, -232 },
+};
+
+// Size of the block header of each channel.
+const size_t ima_header_size = 4;
+const size_t ms_header_size = 7;
+
+// Blocks decoded by a task.
+const size_t blocks_per_task = 64;
+
+inline int clamp16 (int value) {
+	return std::min(32767, std::max(-32768, value));
+}
+
+struct ima_state {
+	int predictor;
+	int index;
+
+	int decode (unsigned int nibble) noexcept {
+		int step = ima_step_table[index];
+		int diff = step >> 3;
+
+		if (nibble & 1) diff += step >> 2;
+		if (nibble & 2) diff += step >> 1;
+		if (nibble & 4) diff += step;
+		if (nibble & 8) diff = -diff;
+
+		predictor = clamp16(predictor + diff);
+		index = std::min(88, std::max(0, index + ima_index_table[nibble]));
+		return predictor;
+	}
+
+	unsigned int encode (int sample) noexcept {
+		int step = ima_step_table[index];
+		int diff = sample - predictor;
+		unsigned int nibble = 0;
+
+		if (diff < 0) {
+			nibble = 8;
+			diff = -diff;
+		}
+		if (diff >= step) {
+			nibble |= 4;
+			diff -= step;
+		}
+		step >>= 1;
+		if (diff >= step) {
+			nibble |= 2;
+			diff -= step;
+		}
+		step >>= 1;
+		if (diff >= step) {
+			nibble |= 1;
+		}
+
+		// follow the decoder
+		decode(nibble);
+		return nibble;
+	}
+};
+
+struct ms_state {
+	int coefficient1;
+	int coefficient2;
+	int delta;
+	int sample1;
+	int sample2;
+
+	int decode (unsigned int nibble) noexcept {
+		int predictor = (sample1*coefficient1 + sample2*coefficient2) >> 8;
+		int value = (nibble & 8) ? int(nibble) - 16 : int(nibble);
+		int sample = clamp16(predictor + value*delta);
+
+		sample2 = sample1;
+		sample1 = sample;
+		delta = std::max(16, (ms_adaptation_table[nibble]*delta) >> 8);
+		delta = std::min(delta, std::numeric_limits<int>::max()/768);
+		return sample;
+	}
+
+	unsigned int encode (int sample) noexcept {
+		int predictor = (sample1*coefficient1 + sample2*coefficient2) >> 8;
+		int diff = sample - predictor;
+		int value = (diff + (diff >= 0 ? delta/2 : -delta/2))/delta;
+		unsigned int nibble = std::min(7, std::max(-8, value)) & 0x0f;
+
+		// follow the decoder
+		decode(nibble);
+		return nibble;
+	}
+};
+
+// Returns the count of frames of an ADPCM block of the given size.
+format::size_type block_frame_count (
+		unsigned int audio_format,
+		unsigned int channel_count,
+		size_t block_size) noexcept {
+	if (audio_format == WaveIMAADPCMFormat) {
+		if (block_size < ima_header_size*channel_count) {
+			return 0;
+		}
+		size_t data_size = block_size - ima_header_size*channel_count;
+		// samples of several channels are interleaved by groups of 8
+		return channel_count == 1
+			? 2*data_size + 1
+			: 8*(data_size/(4*channel_count)) + 1;
+	}
+
+	if (block_size < ms_header_size*channel_count) {
+		return 0;
+	}
+	return 2*(block_size - ms_header_size*channel_count)/channel_count + 2;
+}
+
+void decode_ima_block (
+		const unsigned char *block,
+		unsigned int channel_count,
+		format::size_type frame_count,
+		float *pcm) {
+	const unsigned char *data = block + ima_header_size*channel_count;
+
+	for (unsigned int c = 0; c < channel_count; ++c) {
+		const unsigned char *header = block + ima_header_size*c;
+		ima_state state{
+			read_le<int16_t>(header),
+			std::min<int>(header[2], 88)
+		};
+		float *out = pcm + c;
+
+		out[0] = value_to_sample<int16_t>(state.predictor);
+		for (format::size_type i = 1; i < frame_count; ++i) {
+			size_t n = i - 1;
+			unsigned char byte = data[4*((n/8)*channel_count + c) + (n%8)/2];
+			unsigned int nibble = (n & 1) ? byte >> 4 : byte & 0x0f;
+			out[i*channel_count] = value_to_sample<int16_t>(state.decode(nibble));
+		}
+	}
+}
+
+void decode_ms_block (
+		const unsigned char *block,
+		unsigned int channel_count,
+		format::size_type frame_count,
+		const std::vector<int16_t> &coefficients,
+		float *pcm) {
+	const unsigned char *data = block + ms_header_size*channel_count;
+
+	for (unsigned int c = 0; c < channel_count; ++c) {
+		size_t predictor = block[c];
+		if (2*predictor + 1 >= coefficients.size()) {
+			error::raise_literal(error::CodecFormatError, "invalid MS ADPCM predictor");
+		}
+
+		ms_state state{
+			coefficients[2*predictor],
+			coefficients[2*predictor + 1],
+			read_le<int16_t>(block + channel_count + 2*c),
+			read_le<int16_t>(block + 3*channel_count + 2*c),
+			read_le<int16_t>(block + 5*channel_count + 2*c)
+		};
+		float *out = pcm + c;
+
+		out[0] = value_to_sample<int16_t>(state.sample2);
+		if (frame_count > 1) {
+			out[channel_count] = value_to_sample<int16_t>(state.sample1);
+		}
+		for (format::size_type i = 2; i < frame_count; ++i) {
+			size_t n = (i - 2)*channel_count + c;
+			unsigned char byte = data[n/2];
+			unsigned int nibble = (n & 1) ? byte & 0x0f : byte >> 4;
+			out[i*channel_count] = value_to_sample<int16_t>(state.decode(nibble));
+		}
+	}
+}
+
+void decode_adpcm (
+		utils::byte_source &in,
+		const header &header,
+		unsigned int thread_count,
+		sequence &seq) {
+	const WaveFormatChunk &format_chunk = header.format_chunk;
+	const unsigned int audio_format = format_chunk.audioFormat;
+	const unsigned int channel_count = format_chunk.channelCount;
+	const size_t block_size = format_chunk.bytePerFrame;
+
+	if (format_chunk.bitPerSample != 4) {
+		error::raise(error::FormatUnhandledSampleQuantificationValueError);
+	}
+
+	format::size_type frames_per_block =
+		block_frame_count(audio_format, channel_count, block_size);
+	if (header.frames_per_block > 0) {
+		frames_per_block = std::min<format::size_type>(
+			frames_per_block, header.frames_per_block);
+	}
+	if (frames_per_block == 0) {
+		error::raise(error::CodecFormatError);
+	}
+
+	std::vector<int16_t> coefficients = header.coefficients;
+	if (coefficients.empty()) {
+		coefficients.assign(&ms_coefficients[0][0], &ms_coefficients[7][0]);
+	}
+
+	utils::buffer storage;
+	const utils::byte_source::span data =
+		read_contiguous(in, header.data_chunk.size, storage);
+	const unsigned char *blocks = data.data;
+	const size_t size = data.size;
+
+	// the last block may be partial
+	const size_t block_count = (size + block_size - 1)/block_size;
+	const size_t last_block_size = size - (block_count > 0 ? (block_count - 1)*block_size : 0);
+	const format::size_type last_frame_count = std::min(frames_per_block,
+		block_frame_count(audio_format, channel_count, last_block_size));
+
+	format::size_type frame_count = block_count > 0
+		? (block_count - 1)*frames_per_block + last_frame_count
+		: 0;
+
+	seq.set_frame_count(frame_count);
+
+	// blocks are independent
+	utils::parallel_for(
+		(block_count + blocks_per_task - 1)/blocks_per_task,
+		thread_count,
+		[&](size_t task) {
+			size_t first = task*blocks_per_task;
+			size_t last = std::min(block_count, first + blocks_per_task);
 
-	seq.reserve(frame_count);
+			for (size_t i = first; i < last; ++i) {
+				const unsigned char *block = blocks + i*block_size;
+				format::size_type count =
+					i + 1 < block_count ? frames_per_block : last_frame_count;
+				float *pcm = seq.data(i*frames_per_block);
+
+				if (audio_format == WaveIMAADPCMFormat) {
+					decode_ima_block(block, channel_count, count, pcm);
+				} else {
+					decode_ms_block(block, channel_count, count, coefficients, pcm);
+				}
+			}
+		});
+
+	// the encoder pads the last block
+	if (header.fact_frame_count > 0 && header.fact_frame_count < frame_count) {
+		seq.set_frame_count(header.fact_frame_count);
+	}
+}
+
+// Decodes the data chunk into the given sequence, which must be empty and
+// of the format of the stream. The sequence is sized once from the size of
+// the chunk.
+void decode (
+		utils::byte_source &in,
+		const header &header,
+		unsigned int thread_count,
+		sequence &seq) {
+	const WaveFormatChunk &format_chunk = header.format_chunk;
+
+	switch (format_chunk.audioFormat) {
+	case WaveIMAADPCMFormat:
+	case WaveMSADPCMFormat:
+		decode_adpcm(in, header, thread_count, seq);
+		return;
+
+	default:
+		break;
+	}
 
 	switch (format_chunk.bitPerSample) {
 	case 8:
-		read_data_chunk<int8_t>(in, seq);
+		read_data_chunk<int8_t>(in, header.data_chunk.size, seq);
 		break;
 
 	case 16:
-		read_data_chunk<int16_t>(in, seq);
+		read_data_chunk<int16_t>(in, header.data_chunk.size, seq);
 		break;
 
 	default:
 		throw error(error::FormatUnhandledSampleQuantificationValueError);
 	}
+}
+
+} // namespace wave_
+
+WAVE_decoder::WAVE_decoder (unsigned int thread_count) :
+	thread_count_(thread_count) {
+}
+
+sequence
+WAVE_decoder::decode_ (std::istream &in) const {
+	utils::stream_source source(in);
+	return decode_source_(source);
+}
+
+sequence
+WAVE_decoder::decode_file_ (const std::string &filepath) const {
+	utils::mapped_source source(filepath);
+
+	if (! source.is_open()) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	return decode_source_(source);
+}
+
+sequence
+WAVE_decoder::decode_source_ (utils::byte_source &in) const {
+	wave_::header header;
+	read_header(in, header);
+
+	sequence seq(format(
+		header.format_chunk.channelCount,
+		header.format_chunk.sampleRate));
+	wave_::decode(in, header, utils::thread_count(thread_count_), seq);
 
 	return seq;
 }
 
+void
+WAVE_decoder::decode_file_into_ (const std::string &filepath, sequence &dst)
+	const {
+	utils::mapped_source source(filepath);
+
+	if (! source.is_open()) {
+		error::raise(error::IOError, "failed to open " + filepath);
+	}
+
+	decode_source_into_(source, dst);
+}
+
+void
+WAVE_decoder::decode_source_into_ (utils::byte_source &in, sequence &dst)
+	const {
+	wave_::header header;
+	read_header(in, header);
+
+	dst.reset(format(
+		header.format_chunk.channelCount,
+		header.format_chunk.sampleRate));
+	wave_::decode(in, header, utils::thread_count(thread_count_), dst);
+}
+
+bool
+WAVE_decoder::sniff (const unsigned char *data, size_t size) noexcept {
+	return size >= 12
+		&& memcmp(data, "RIFF", 4) == 0
+		&& memcmp(data + 8, "WAVE", 4) == 0;
+}
+
+codec::info
+WAVE_decoder::probe_ (std::istream &in) const {
+	utils::stream_source source(in, 4096);
+	return probe_source_(source);
+}
+
+codec::info
+WAVE_decoder::probe_source_ (utils::byte_source &in) const {
+	wave_::header header;
+	read_header(in, header);
+
+	const WaveFormatChunk &format_chunk = header.format_chunk;
+	format::size_type frame_count =
+		header.data_chunk.size/format_chunk.bytePerFrame;
+
+	if (format_chunk.audioFormat == WaveIMAADPCMFormat
+		|| format_chunk.audioFormat == WaveMSADPCMFormat) {
+		frame_count = header.fact_frame_count > 0
+			? header.fact_frame_count
+			: frame_count*wave_::block_frame_count(
+				format_chunk.audioFormat,
+				format_chunk.channelCount,
+				format_chunk.bytePerFrame);
+	}
+
+	return codec::info{
+		"wave",
+		format(format_chunk.channelCount, format_chunk.sampleRate),
+		frame_count,
+		8*format_chunk.byteRate
+	};
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Coder /////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -291,9 +850,193 @@ inline void write<WaveDataChunk> (std::ostream &out, const sequence &seq) {
 	}
 }
 
-void WAVE_coder::encode_ (std::ostream &out, const sequence &seq) const
-	throw(error) {
-	write<RIFFHeaderChunk>(out, seq);
-	write<WaveFormatChunk>(out, seq);
-	write<WaveDataChunk>  (out, seq);
+namespace wave_ {
+
+template <typename T>
+void write_le (std::ostream &out, T value) {
+	typename std::make_unsigned<T>::type bits = value;
+	for (size_t i = 0; i < sizeof(T); ++i, bits >>= 8) {
+		out.put(static_cast<char>(bits & 0xff));
+	}
+}
+
+template <typename T>
+void put_le (unsigned char *data, T value) {
+	typename std::make_unsigned<T>::type bits = value;
+	for (size_t i = 0; i < sizeof(T); ++i, bits >>= 8) {
+		data[i] = bits & 0xff;
+	}
+}
+
+void encode_ima_block (
+		const std::vector<std::vector<int>> &samples,
+		std::vector<ima_state> &states,
+		unsigned char *block) {
+	const unsigned int channel_count = samples.size();
+	unsigned char *data = block + ima_header_size*channel_count;
+
+	for (unsigned int c = 0; c < channel_count; ++c) {
+		const std::vector<int> &x = samples[c];
+		ima_state &state = states[c];
+		unsigned char *header = block + ima_header_size*c;
+
+		// the step index follows from the previous block
+		state.predictor = x[0];
+		put_le<int16_t>(header, x[0]);
+		header[2] = state.index;
+		header[3] = 0;
+
+		for (size_t i = 1; i < x.size(); ++i) {
+			size_t n = i - 1;
+			unsigned int nibble = state.encode(x[i]);
+			data[4*((n/8)*channel_count + c) + (n%8)/2] |=
+				(n & 1) ? nibble << 4 : nibble;
+		}
+	}
+}
+
+void encode_ms_block (
+		const std::vector<std::vector<int>> &samples,
+		unsigned char *block) {
+	const unsigned int channel_count = samples.size();
+	unsigned char *data = block + ms_header_size*channel_count;
+
+	for (unsigned int c = 0; c < channel_count; ++c) {
+		const std::vector<int> &x = samples[c];
+
+		// the predictor giving the smallest error is kept
+		ms_state best;
+		unsigned int best_predictor = 0;
+		uint64_t best_error = std::numeric_limits<uint64_t>::max();
+
+		for (unsigned int p = 0; p < 7; ++p) {
+			ms_state state{ ms_coefficients[p][0], ms_coefficients[p][1], 16, x[1], x[0] };
+			int predictor = (x[1]*state.coefficient1 + x[0]*state.coefficient2) >> 8;
+			state.delta = std::max(16, std::abs(x[2] - predictor)/4);
+
+			ms_state initial = state;
+			uint64_t error = 0;
+			for (size_t i = 2; i < x.size() && error < best_error; ++i) {
+				state.encode(x[i]);
+				int64_t diff = state.sample1 - x[i];
+				error += diff*diff;
+			}
+			if (error < best_error) {
+				best = initial;
+				best_predictor = p;
+				best_error = error;
+			}
+		}
+
+		block[c] = best_predictor;
+		put_le<int16_t>(block + channel_count + 2*c, best.delta);
+		put_le<int16_t>(block + 3*channel_count + 2*c, best.sample1);
+		put_le<int16_t>(block + 5*channel_count + 2*c, best.sample2);
+
+		for (size_t i = 2; i < x.size(); ++i) {
+			size_t n = (i - 2)*channel_count + c;
+			unsigned int nibble = best.encode(x[i]);
+			data[n/2] |= (n & 1) ? nibble : nibble << 4;
+		}
+	}
+}
+
+void encode_adpcm (
+		std::ostream &out,
+		const sequence &seq,
+		unsigned int audio_format) {
+	const unsigned int channel_count = seq.format().channel_count();
+	const unsigned int sample_rate = seq.format().sample_rate();
+	const format::size_type frame_count = seq.frame_count();
+
+	// usual block sizes: 256 bytes per channel up to 11025 Hz, 512 up to
+	// 22050 Hz and 1024 above
+	const size_t block_size =
+		256*channel_count*std::min(4u, std::max(1u, sample_rate/11025));
+	const format::size_type frames_per_block =
+		block_frame_count(audio_format, channel_count, block_size);
+	const size_t block_count = (frame_count + frames_per_block - 1)/frames_per_block;
+	const uint32_t data_size = block_count*block_size;
+
+	const bool ima = audio_format == WaveIMAADPCMFormat;
+	const uint32_t format_size = ima ? 20 : 50;
+
+	out.write("RIFF", 4);
+	write_le<uint32_t>(out, 4 + 8 + format_size + 8 + 4 + 8 + data_size);
+	out.write("WAVE", 4);
+
+	out.write("fmt ", 4);
+	write_le<uint32_t>(out, format_size);
+	write_le<uint16_t>(out, audio_format);
+	write_le<uint16_t>(out, channel_count);
+	write_le<uint32_t>(out, sample_rate);
+	write_le<uint32_t>(out, uint64_t(sample_rate)*block_size/frames_per_block);
+	write_le<uint16_t>(out, block_size);
+	write_le<uint16_t>(out, 4);
+	write_le<uint16_t>(out, format_size - 18);
+	write_le<uint16_t>(out, frames_per_block);
+	if (! ima) {
+		write_le<uint16_t>(out, 7);
+		for (const int16_t *coefficients: ms_coefficients) {
+			write_le<int16_t>(out, coefficients[0]);
+			write_le<int16_t>(out, coefficients[1]);
+		}
+	}
+
+	out.write("fact", 4);
+	write_le<uint32_t>(out, 4);
+	write_le<uint32_t>(out, frame_count);
+
+	out.write("data", 4);
+	write_le<uint32_t>(out, data_size);
+
+	std::vector<std::vector<int>> samples(channel_count, std::vector<int>(frames_per_block));
+	std::vector<ima_state> states(channel_count, ima_state{ 0, 0 });
+	std::vector<unsigned char> block(block_size);
+
+	for (size_t b = 0; b < block_count; ++b) {
+		format::size_type first = b*frames_per_block;
+		format::size_type count = std::min(frames_per_block, frame_count - first);
+		const float *pcm = seq.data(first);
+
+		// the last block is padded with its last frame
+		for (format::size_type i = 0; i < frames_per_block; ++i) {
+			const float *frame = pcm + std::min(i, count - 1)*channel_count;
+			for (unsigned int c = 0; c < channel_count; ++c) {
+				samples[c][i] = sample_to_value<int16_t>(frame[c]);
+			}
+		}
+
+		std::fill(block.begin(), block.end(), 0);
+		if (ima) {
+			encode_ima_block(samples, states, block.data());
+		} else {
+			encode_ms_block(samples, block.data());
+		}
+		out.write(reinterpret_cast<const char *>(block.data()), block.size());
+	}
+}
+
+} // namespace wave_
+
+WAVE_coder::WAVE_coder (enum encoding encoding) :
+	encoding_(encoding) {
+}
+
+void WAVE_coder::encode_ (std::ostream &out, const sequence &seq) const {
+	switch (encoding_) {
+	case ImaAdpcm:
+		wave_::encode_adpcm(out, seq, WaveIMAADPCMFormat);
+		break;
+
+	case MsAdpcm:
+		wave_::encode_adpcm(out, seq, WaveMSADPCMFormat);
+		break;
+
+	default:
+		write<RIFFHeaderChunk>(out, seq);
+		write<WaveFormatChunk>(out, seq);
+		write<WaveDataChunk>  (out, seq);
+		break;
+	}
 }
@@ -13,8 +13,30 @@ class sequence;
 namespace codec {
 class WAVE_coder : public coder {
 public:
-	virtual void encode_ (std::ostream &, const sequence &) const
-		throw(error);
+	/// Encoding of the samples.
+	enum encoding {
+		/// 16 bits linear PCM.
+		LinearPCM,
+		/// 4 bits IMA ADPCM.
+		ImaAdpcm,
+		/// 4 bits Microsoft ADPCM.
+		MsAdpcm,
+	};
+
+public:
+	/// Constructs a `WAVE_coder`.
+	///
+	/// *Parameters:*
+	/// - `encoding`
+	///   The encoding of the samples. ADPCM streams are a quarter of the
+	///   size of 16 bits PCM streams, at the cost of some quality.
+	explicit WAVE_coder (enum encoding encoding = LinearPCM);
+
+public:
+	virtual void encode_ (std::ostream &, const sequence &) const;
+
+private:
+	enum encoding encoding_;
 };
 } /* namespace codec */
 } /* namespace audio */
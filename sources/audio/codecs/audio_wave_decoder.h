@@ -12,8 +12,33 @@ namespace audio {
 class sequence;
 namespace codec {
 class WAVE_decoder: public decoder {
+public:
+	/// Constructs a `WAVE_decoder`. Linear PCM, IMA ADPCM and Microsoft
+	/// ADPCM streams are decoded.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads used to decode ADPCM streams, whose blocks
+	///   are decoded concurrently. A count of 0 stands for the count of
+	///   hardware threads.
+	explicit WAVE_decoder (unsigned int thread_count = 1);
+
+public:
+	/// Returns `true` if the given first bytes of a stream are the ones
+	/// of a RIFF/WAVE stream.
+	static bool sniff (const unsigned char *data, size_t size) noexcept;
+
 protected:
-	virtual sequence decode_ (std::istream &) const throw(error);
+	virtual sequence decode_ (std::istream &) const;
+	virtual sequence decode_file_ (const std::string &) const;
+	virtual sequence decode_source_ (utils::byte_source &) const;
+	virtual void decode_file_into_ (const std::string &, sequence &) const;
+	virtual void decode_source_into_ (utils::byte_source &, sequence &) const;
+	virtual info probe_ (std::istream &) const;
+	virtual info probe_source_ (utils::byte_source &) const;
+
+private:
+	unsigned int thread_count_;
 };
 } /* namespace codec */
 } /* namespace audio */
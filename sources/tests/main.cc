@@ -2,10 +2,30 @@
 #include <iomanip>
 #include <sstream>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <audio/client>
 #include <audio/codec>
+#include <audio/sample>
 #include <audio/sequence>
+#include <audio/server>
+#include <audio/shared_sequence>
+
+#include <audio/codecs/cache>
+#include <audio/codecs/flac_decoder>
+#include <audio/codecs/mp3_decoder>
+#include <audio/codecs/ogg_vorbis_decoder>
+#include <audio/codecs/prefetch_reader>
+#include <audio/codecs/raw_coder>
+#include <audio/codecs/raw_decoder>
+#include <audio/codecs/wave_coder>
+#include <audio/codecs/wave_decoder>
 
 #include <audio_toolkit_version>
 
@@ -17,9 +37,578 @@
 #include <audio/generators/sine>
 
 #include <utils/buffer>
+#include <utils/shared_memory>
+#include <utils/unix_socket>
+
+#include <dirent.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace com::nealrame;
 
+// Rounds the samples of the given sequence to 16 bits values, so that
+// lossless codecs give them back exactly.
+audio::sequence quantize (audio::sequence seq) {
+	if (seq.frame_count() > 0) {
+		float *sample = seq.data(0);
+		float *end = sample + seq.frame_count()*seq.format().channel_count();
+		for (; sample < end; ++sample) {
+			*sample = audio::value_to_sample(audio::sample_to_value<int16_t>(*sample));
+		}
+	}
+	return seq;
+}
+
+bool same_samples (const audio::sequence &lhs, const audio::sequence &rhs) {
+	if (! (lhs.format() == rhs.format()) || lhs.frame_count() != rhs.frame_count()) {
+		return false;
+	}
+	if (lhs.frame_count() == 0) {
+		return true;
+	}
+	return std::equal(
+		lhs.data(0),
+		lhs.data(0) + lhs.frame_count()*lhs.format().channel_count(),
+		rhs.data(0));
+}
+
+// Returns `true` if the given sequences have the same format and frame
+// count, and samples which differ by the given tolerance at most.
+bool close_samples (
+		const audio::sequence &lhs,
+		const audio::sequence &rhs,
+		float tolerance) {
+	if (! (lhs.format() == rhs.format()) || lhs.frame_count() != rhs.frame_count()) {
+		return false;
+	}
+	if (lhs.frame_count() == 0) {
+		return true;
+	}
+	return std::equal(
+		lhs.data(0),
+		lhs.data(0) + lhs.frame_count()*lhs.format().channel_count(),
+		rhs.data(0),
+		[=](float a, float b) { return std::fabs(a - b) <= tolerance; });
+}
+
+// Returns the given range of frames of the given sequence.
+audio::sequence range (
+		const audio::sequence &seq,
+		audio::format::size_type first_frame,
+		audio::format::size_type frame_count) {
+	audio::sequence res(seq.format());
+	res.append(seq.data(first_frame), frame_count);
+	return res;
+}
+
+bool check (const std::string &what, bool passed) {
+	std::cout << what << ": " << (passed ? "ok" : "FAILED") << std::endl;
+	return passed;
+}
+
+// Lossless round trip, noise is large enough once compressed to be decoded
+// by segments.
+bool test_flac () {
+	bool passed = true;
+
+	audio::generator<audio::generators::noise> noise(audio::format(2, 44100), 0.8);
+	audio::sequence samples = quantize(noise.sequence(2.));
+
+	audio::store_buffer("noise.flac", samples);
+	audio::sequence flac = audio::codec::FLAC_decoder(1).decode("noise.flac");
+
+	passed &= check("flac round trip", same_samples(samples, flac));
+	passed &= check("flac parallel decode",
+		same_samples(flac, audio::codec::FLAC_decoder(4).decode("noise.flac")));
+
+	return passed;
+}
+
+// Streams are split in segments of about a million frames at least.
+audio::sequence long_sine () {
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	return sine.sequence(60.);
+}
+
+// Segments decoded concurrently give the same samples as a serial decode.
+bool test_mp3_parallel_decode () {
+	audio::store_buffer("long_sine.mp3", long_sine());
+
+	return check("mp3 parallel decode", same_samples(
+		audio::codec::MP3_decoder(1).decode("long_sine.mp3"),
+		audio::codec::MP3_decoder(4).decode("long_sine.mp3")));
+}
+
+bool test_vorbis_parallel_decode () {
+	audio::store_buffer("long_sine.ogg", long_sine());
+
+	return check("vorbis parallel decode", same_samples(
+		audio::codec::OGGVorbis_decoder(1).decode("long_sine.ogg"),
+		audio::codec::OGGVorbis_decoder(4).decode("long_sine.ogg")));
+}
+
+// Ranges decoded from a frame index match the same frames of a full decode,
+// and indexes come back unchanged from their sidecar files.
+bool test_mp3_seek () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	audio::store_buffer("sine_10s.mp3", sine.sequence(10.));
+
+	const audio::codec::MP3_decoder decoder;
+	const audio::sequence full = decoder.decode("sine_10s.mp3");
+
+	std::ifstream input("sine_10s.mp3", std::ifstream::binary);
+	audio::codec::MP3_decoder::frame_index index = decoder.scan(input);
+
+	passed &= check("mp3 index length", index.frame_count() == full.frame_count());
+
+	const audio::format::size_type first_frame = 123457;
+	const audio::format::size_type frame_count = 4096;
+
+	passed &= check("mp3 seek", close_samples(
+		decoder.decode(input, index, first_frame, frame_count),
+		range(full, first_frame, frame_count),
+		1e-3f));
+
+	index.save("sine_10s.mp3.index");
+	audio::codec::MP3_decoder::frame_index loaded =
+		audio::codec::MP3_decoder::frame_index::load("sine_10s.mp3.index");
+
+	passed &= check("mp3 index sidecar",
+		loaded.offsets() == index.offsets()
+		&& loaded.step() == index.step()
+		&& loaded.frame_count() == index.frame_count());
+
+	return passed;
+}
+
+// Ranges found by bisecting the pages match the same frames of a full
+// decode, also once pages are known from a previous seek.
+bool test_vorbis_seek () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	audio::store_buffer("sine_10s.ogg", sine.sequence(10.));
+
+	const audio::codec::OGGVorbis_decoder decoder;
+	const audio::sequence full = decoder.decode("sine_10s.ogg");
+
+	std::ifstream input("sine_10s.ogg", std::ifstream::binary);
+	audio::codec::OGGVorbis_decoder::page_index index;
+
+	const audio::format::size_type frame_count = 4096;
+
+	for (audio::format::size_type first_frame: { 300001, 100003 }) {
+		passed &= check("vorbis seek to " + std::to_string(first_frame), close_samples(
+			decoder.decode(input, index, first_frame, frame_count),
+			range(full, first_frame, frame_count),
+			1e-3f));
+	}
+	passed &= check("vorbis page index", ! index.empty());
+
+	return passed;
+}
+
+// Probes read the format and the length of streams from their headers.
+bool test_probe () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = sine.sequence(1.5);
+
+	audio::store_buffer("probe.wav", samples);
+	audio::store_buffer("probe.flac", samples);
+
+	const audio::codec::info wave = audio::probe("probe.wav");
+	passed &= check("wave probe",
+		wave.codec == "wave"
+		&& wave.format == samples.format()
+		&& wave.frame_count == samples.frame_count()
+		&& wave.bitrate == 44100*2*16);
+
+	const audio::codec::info flac = audio::probe("probe.flac");
+	passed &= check("flac probe",
+		flac.codec == "flac"
+		&& flac.format == samples.format()
+		&& flac.frame_count == samples.frame_count()
+		&& flac.bitrate > 0);
+
+	std::ofstream("probe.txt") << "not an audio stream" << std::endl;
+	try {
+		audio::probe("probe.txt");
+		passed &= check("unknown stream probe", false);
+	} catch (const audio::error &err) {
+		passed &= check("unknown stream probe",
+			err.status() == audio::error::DecoderNotFound);
+	}
+
+	return passed;
+}
+
+// ADPCM streams decode to the length of the encoded sequence, close to its
+// samples, and the same whatever the count of threads.
+bool test_adpcm () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = sine.sequence(2.);
+
+	const struct {
+		const char *name;
+		enum audio::codec::WAVE_coder::encoding encoding;
+	} encodings[] = {
+		{ "ima adpcm", audio::codec::WAVE_coder::ImaAdpcm },
+		{ "ms adpcm", audio::codec::WAVE_coder::MsAdpcm },
+	};
+
+	for (const auto &e: encodings) {
+		const std::string name(e.name);
+		const std::string path = "sine_" + name.substr(0, name.find(' ')) + ".wav";
+
+		audio::codec::WAVE_coder(e.encoding).encode(path, samples);
+		const audio::sequence decoded = audio::codec::WAVE_decoder(1).decode(path);
+
+		passed &= check(name + " round trip", close_samples(samples, decoded, 0.05f));
+		passed &= check(name + " parallel decode",
+			same_samples(decoded, audio::codec::WAVE_decoder(4).decode(path)));
+	}
+
+	return passed;
+}
+
+// Raw files come back from their sidecar, `Float32` ones unchanged and
+// `Int16` ones rounded to 16 bits, and mappings hold the same frames.
+bool test_raw () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = sine.sequence(1.5);
+
+	const audio::codec::RAW_decoder decoder;
+
+	audio::codec::RAW_coder(audio::codec::raw_format::Float32).encode("sine.f32", samples);
+	passed &= check("f32 round trip", same_samples(samples, decoder.decode("sine.f32")));
+	passed &= check("f32 range", same_samples(
+		range(samples, 1001, 2048),
+		decoder.decode("sine.f32", 1001, 2048)));
+
+	const audio::codec::RAW_decoder::mapping mapping = decoder.map("sine.f32");
+	passed &= check("f32 mapping",
+		mapping.format() == samples.format()
+		&& mapping.frame_count() == samples.frame_count()
+		&& std::equal(
+			mapping.data(0),
+			mapping.data(0) + mapping.frame_count()*mapping.format().channel_count(),
+			samples.data(0))
+		&& same_samples(samples, mapping.copy()));
+
+	audio::codec::RAW_coder(audio::codec::raw_format::Int16).encode("sine.s16", samples);
+	passed &= check("s16 round trip",
+		close_samples(samples, decoder.decode("sine.s16"), 1.f/32768));
+
+	return passed;
+}
+
+// Returns the count of files of the given directory whose name ends with
+// the given suffix. Files are removed as well if `remove` is `true`.
+size_t count_files (
+		const std::string &directory,
+		const std::string &suffix,
+		bool remove = false) {
+	size_t count = 0;
+	if (DIR *dir = opendir(directory.c_str())) {
+		while (struct dirent *dirent = readdir(dir)) {
+			const std::string name(dirent->d_name);
+			if (name[0] != '.' && name.size() >= suffix.size()
+				&& name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+				if (remove) {
+					std::remove((directory + "/" + name).c_str());
+				}
+				++count;
+			}
+		}
+		closedir(dir);
+	}
+	return count;
+}
+
+// Files are decoded once, then read from the cache until their content
+// changes, and trims evict entries down to the byte budget.
+bool test_cache () {
+	bool passed = true;
+
+	count_files("cache", "", true);
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = quantize(sine.sequence(1.));
+
+	audio::store_buffer("cached.wav", samples);
+
+	const audio::codec::cache cache("cache", uint64_t(1) << 30);
+
+	passed &= check("cache miss", same_samples(samples, cache.load("cached.wav")));
+	passed &= check("cache entry", count_files("cache", ".f32") == 1);
+
+	const audio::codec::RAW_decoder::mapping mapping = cache.map("cached.wav");
+	passed &= check("cache hit",
+		same_samples(samples, mapping.copy())
+		&& same_samples(samples, cache.load("cached.wav"))
+		&& count_files("cache", ".f32") == 1);
+
+	const audio::sequence changed = quantize(sine.sequence(.5));
+	audio::store_buffer("cached.wav", changed);
+
+	passed &= check("cache of a changed file",
+		same_samples(changed, cache.load("cached.wav"))
+		&& count_files("cache", ".f32") == 2);
+
+	// one entry fits in the budget, not both
+	audio::codec::cache("cache", 400000).trim();
+	passed &= check("cache trim", count_files("cache", ".f32") == 1);
+
+	return passed;
+}
+
+// Returns the status of the error held by the given future, or `-1` if it
+// holds a result.
+template <typename T>
+int error_status (std::future<T> future) {
+	try {
+		future.get();
+	} catch (const audio::error &err) {
+		return err.status();
+	}
+	return -1;
+}
+
+// Cancelled encodes remove the file they were writing, and cancelled
+// operations raise `OperationCancelled` whether they started or not.
+bool test_cancellation () {
+	bool passed = true;
+
+	const auto samples = std::make_shared<const audio::sequence>(long_sine());
+
+	const audio::codec::cancellation encode_cancel;
+	std::future<void> encoded =
+		audio::codec::WAVE_coder().encode_async("cancelled.wav", samples, encode_cancel);
+	encode_cancel.cancel();
+
+	passed &= check("cancelled encode",
+		error_status(std::move(encoded)) == audio::error::OperationCancelled
+		&& ! std::ifstream("cancelled.wav"));
+
+	audio::codec::WAVE_coder().encode("long_sine.wav", *samples);
+
+	const audio::codec::cancellation decode_cancel;
+	decode_cancel.cancel();
+
+	passed &= check("decode cancelled before it starts",
+		error_status(audio::codec::WAVE_decoder().decode_async(
+			"long_sine.wav", decode_cancel)) == audio::error::OperationCancelled);
+
+	passed &= check("decode not cancelled", same_samples(
+		audio::codec::WAVE_decoder().decode("long_sine.wav"),
+		audio::codec::WAVE_decoder().decode_async("long_sine.wav").get()));
+
+	return passed;
+}
+
+// Reads the given count of frames of silence, then fails. Reads are not
+// cut short before the failure.
+class failing_reader : public audio::codec::reader {
+public:
+	failing_reader (audio::format::size_type frame_count) :
+		format_(2, 44100),
+		frame_count_(frame_count) {
+	}
+
+public:
+	virtual const audio::format & format () const noexcept
+	{ return format_; }
+
+	using reader::read;
+	virtual audio::format::size_type read (
+			audio::sequence &seq,
+			audio::format::size_type frame_count) {
+		if (frame_count_ == 0) {
+			audio::error::raise_literal(audio::error::IOError, "read failed");
+		}
+		const std::vector<float> silence(frame_count*format_.channel_count(), 0.f);
+		seq.append(silence.data(), frame_count);
+		frame_count_ -= std::min(frame_count, frame_count_);
+		return frame_count;
+	}
+
+private:
+	audio::format format_;
+	audio::format::size_type frame_count_;
+};
+
+// Prefetched frames are read in order whatever the size of the reads, and
+// errors come once the frames decoded before them are read.
+bool test_prefetch () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = quantize(sine.sequence(5.));
+
+	audio::store_buffer("prefetch.wav", samples);
+
+	audio::codec::prefetch_reader reader(
+		audio::codec::WAVE_decoder().open("prefetch.wav"), 4096, 2);
+	audio::sequence prefetched(reader.format());
+	while (reader.read(prefetched, 1000) > 0);
+
+	passed &= check("prefetch", same_samples(samples, prefetched));
+
+	audio::codec::prefetch_reader failing(
+		std::unique_ptr<audio::codec::reader>(new failing_reader(8192)), 4096, 2);
+	audio::sequence read(failing.format());
+	try {
+		while (failing.read(read, 1000) > 0);
+		passed &= check("prefetch error", false);
+	} catch (const audio::error &err) {
+		passed &= check("prefetch error",
+			err.status() == audio::error::IOError && read.frame_count() == 8192);
+	}
+
+	return passed;
+}
+
+// Variants reporting failures through a `std::error_code` give the status
+// the throwing ones raise, and clear the code on success.
+bool test_error_codes () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = quantize(sine.sequence(.5));
+
+	std::error_code ec = audio::error::CodecFormatError;
+	audio::codec::WAVE_coder().encode("error_codes.wav", samples, ec);
+	passed &= check("encode error code cleared", ! ec);
+
+	audio::codec::WAVE_coder().encode("no_such_directory/error_codes.wav", samples, ec);
+	passed &= check("encode error code",
+		ec == audio::error::IOError && ec.category() == audio::error_category());
+
+	audio::sequence decoded(samples.format());
+	audio::codec::WAVE_decoder().decode_into("error_codes.wav", decoded, ec);
+	passed &= check("decode error code cleared", ! ec && same_samples(samples, decoded));
+
+	std::ofstream("error_codes.txt") << "not an audio stream" << std::endl;
+	int status = -1;
+	try {
+		audio::codec::WAVE_decoder().decode("error_codes.txt");
+	} catch (const audio::error &err) {
+		status = err.status();
+	}
+	audio::codec::WAVE_decoder().decode_into("error_codes.txt", decoded, ec);
+	passed &= check("decode error code",
+		ec.value() == status && ec.category() == audio::error_category());
+
+	failing_reader reader(4096);
+	audio::sequence read(reader.format());
+	reader.read(read, 4096, ec);
+	passed &= check("read error code cleared", ! ec && read.frame_count() == 4096);
+	reader.read(read, 4096, ec);
+	passed &= check("read error code", ec == audio::error::IOError);
+
+	return passed;
+}
+
+// Sent frames are sealed and mapped by the receiver as they were written,
+// and areas which are not sealed are refused.
+bool test_shared_sequence () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = sine.sequence(.5);
+
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+		return check("shared sequence socket", false);
+	}
+
+	audio::shared_sequence shared(samples);
+	passed &= check("shared sequence copy",
+		! shared.is_sealed() && same_samples(samples, shared.copy()));
+
+	shared.send(sockets[0]);
+	passed &= check("shared sequence sealed",
+		shared.is_sealed() && shared.writable_data(0) == nullptr);
+
+	const audio::shared_sequence received = audio::shared_sequence::receive(sockets[1]);
+	passed &= check("shared sequence received",
+		received.is_sealed() && same_samples(samples, received.copy()));
+
+	utils::shared_memory unsealed(4096);
+	passed &= check("unsealed area not adopted",
+		utils::shared_memory::adopt(dup(unsealed.descriptor())) == nullptr);
+
+	const char byte = 0;
+	utils::send_message(sockets[0], &byte, sizeof(byte), unsealed.descriptor());
+	try {
+		audio::shared_sequence::receive(sockets[1]);
+		passed &= check("unsealed area not received", false);
+	} catch (const audio::error &err) {
+		passed &= check("unsealed area not received",
+			err.status() == audio::error::IOError);
+	}
+
+	close(sockets[0]);
+	close(sockets[1]);
+
+	return passed;
+}
+
+// Requests sent by a client to a server running in another thread give
+// the results of the codecs of the client process, errors included.
+bool test_server () {
+	bool passed = true;
+
+	audio::generator<audio::generators::sine> sine(audio::format(2, 44100), 0., 0.8, 110.);
+	const audio::sequence samples = quantize(sine.sequence(1.));
+
+	audio::store_buffer("served.wav", samples);
+
+	std::remove("audio_test.sock");
+	audio::server server("audio_test.sock");
+	std::thread thread([&server] { server.run(); });
+
+	try {
+		audio::client client("audio_test.sock");
+
+		passed &= check("served decode",
+			same_samples(samples, client.decode("served.wav").copy()));
+
+		const std::shared_ptr<const utils::shared_memory> flac =
+			client.transcode("served.wav", ".flac");
+		passed &= check("served transcode", same_samples(
+			samples,
+			audio::codec::FLAC_decoder().decode(flac->data(), flac->size())));
+
+		try {
+			client.decode("no_such_file.wav");
+			passed &= check("served error", false);
+		} catch (const audio::error &err) {
+			passed &= check("served error", err.status() == audio::error::IOError);
+		}
+
+		passed &= check("served probe after an error",
+			client.probe("served.wav").frame_count == samples.frame_count());
+	} catch (...) {
+		server.stop();
+		thread.join();
+		throw;
+	}
+
+	server.stop();
+	thread.join();
+
+	return passed;
+}
+
 int main (int argc, char **argv) {
 
 #if defined(DEBUG)
@@ -48,6 +637,33 @@ int main (int argc, char **argv) {
 		return 1;
 	}
 
+	try {
+		bool passed = true;
+
+		passed &= test_mp3_seek();
+		passed &= test_vorbis_seek();
+		passed &= test_probe();
+		passed &= test_mp3_parallel_decode();
+		passed &= test_vorbis_parallel_decode();
+		passed &= test_flac();
+		passed &= test_adpcm();
+		passed &= test_raw();
+		passed &= test_cache();
+		passed &= test_cancellation();
+		passed &= test_prefetch();
+		passed &= test_error_codes();
+		passed &= test_shared_sequence();
+		passed &= test_server();
+
+		if (! passed) {
+			return 1;
+		}
+	} catch (audio::error &err) {
+		std::cerr << err.status() << std::endl;
+		std::cerr << err.what() << std::endl;
+		return 1;
+	}
+
 	// try {
 	// 	if (argc > 1) {
 	// 		audio::sequence seq = audio::load_buffer(argv[1]);
@@ -0,0 +1,90 @@
+/// daemon.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+///
+/// Serves the probe, decode, encode and transcode requests of the local
+/// processes over a Unix socket, until interrupted. See `audio::server`.
+///
+///     audiotoolkitd [-j THREADS] [-p MAX_PENDING] [-b BATCH_SIZE]
+///                   [-m CACHE_MEGABYTES] [-c CACHE_ENTRIES] SOCKET
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <audio/server>
+
+using namespace com::nealrame;
+
+namespace {
+
+audio::server *running_server = nullptr;
+
+void usage (const char *program) {
+	std::cerr
+		<< "usage: " << program
+		<< " [-j THREADS] [-p MAX_PENDING] [-b BATCH_SIZE] [-m CACHE_MEGABYTES]"
+		<< " [-c CACHE_ENTRIES] SOCKET" << std::endl;
+}
+
+void on_signal (int) {
+	if (running_server != nullptr) {
+		running_server->stop();
+	}
+}
+
+} // namespace
+
+int main (int argc, char **argv) {
+	audio::server::settings settings;
+	std::vector<std::string> args;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg(argv[i]);
+		const bool has_value = i + 1 < argc;
+
+		if (arg == "-j" && has_value) {
+			settings.thread_count = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-p" && has_value) {
+			settings.max_pending = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "-b" && has_value) {
+			settings.batch_size = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "-m" && has_value) {
+			settings.cache_budget = size_t(std::strtoul(argv[++i], nullptr, 10)) << 20;
+		} else if (arg == "-c" && has_value) {
+			settings.cache_entry_count = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			args.push_back(arg);
+		}
+	}
+
+	if (args.size() != 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	try {
+		audio::server server(args[0], settings);
+
+		running_server = &server;
+		std::signal(SIGINT, on_signal);
+		std::signal(SIGTERM, on_signal);
+		std::signal(SIGPIPE, SIG_IGN);
+
+		std::cout << "listening at " << args[0] << std::endl;
+		server.run();
+		running_server = nullptr;
+	} catch (const std::exception &err) {
+		std::cerr << err.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
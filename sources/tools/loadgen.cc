@@ -0,0 +1,184 @@
+/// loadgen.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+///
+/// Sends requests to an `audiotoolkitd` server from several connections at
+/// once, then reports their throughput and latencies. Requests cycle over
+/// the given files.
+///
+///     audioloadgen [-c CONNECTIONS] [-n REQUESTS] [-o OPERATION]
+///                  [-e EXTENSION] SOCKET FILE...
+///
+/// OPERATION is one of `probe`, `decode`, `encode` or `transcode`, the
+/// default. Files to be encoded are decoded by the server first.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <audio/client>
+
+using namespace com::nealrame;
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+
+void usage (const char *program) {
+	std::cerr
+		<< "usage: " << program
+		<< " [-c CONNECTIONS] [-n REQUESTS] [-o OPERATION] [-e EXTENSION]"
+		<< " SOCKET FILE..." << std::endl;
+}
+
+// Latency of the given percentile by the nearest rank method, in
+// milliseconds. Latencies must be sorted.
+double percentile (const std::vector<double> &latencies, double p) {
+	if (latencies.empty()) {
+		return 0.;
+	}
+	size_t rank = size_t(std::ceil(p*latencies.size()));
+	return latencies[std::max<size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+int main (int argc, char **argv) {
+	unsigned int connection_count = 8;
+	size_t request_count = 1000;
+	std::string operation = "transcode";
+	std::string extension = ".flac";
+	std::vector<std::string> args;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg(argv[i]);
+		const bool has_value = i + 1 < argc;
+
+		if (arg == "-c" && has_value) {
+			connection_count = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "-n" && has_value) {
+			request_count = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-o" && has_value) {
+			operation = argv[++i];
+		} else if (arg == "-e" && has_value) {
+			extension = argv[++i];
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			args.push_back(arg);
+		}
+	}
+
+	if (args.size() < 2
+			|| (operation != "probe" && operation != "decode"
+				&& operation != "encode" && operation != "transcode")) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (extension[0] != '.') {
+		extension = "." + extension;
+	}
+
+	const std::string socket_path = args[0];
+	const std::vector<std::string> files(args.begin() + 1, args.end());
+
+	std::atomic<size_t> next(0);
+	std::mutex mutex;
+	std::vector<double> latencies;
+	size_t failed = 0;
+	std::string first_error;
+
+	auto run = [&] {
+		std::vector<double> local;
+		size_t local_failed = 0;
+		std::string local_error;
+
+		try {
+			audio::client client(socket_path);
+
+			// frames to be encoded are decoded once
+			std::vector<audio::shared_sequence> sequences;
+			if (operation == "encode") {
+				for (const std::string &file : files) {
+					sequences.push_back(client.decode(file));
+				}
+			}
+
+			for (size_t i = next++; i < request_count; i = next++) {
+				const size_t index = i%files.size();
+				const auto start = steady_clock::now();
+
+				try {
+					if (operation == "probe") {
+						client.probe(files[index]);
+					} else if (operation == "decode") {
+						client.decode(files[index]);
+					} else if (operation == "encode") {
+						client.encode(sequences[index], extension);
+					} else {
+						client.transcode(files[index], extension);
+					}
+				} catch (const std::exception &err) {
+					if (local_failed++ == 0) {
+						local_error = err.what();
+					}
+					continue;
+				}
+
+				local.push_back(std::chrono::duration<double, std::milli>(
+					steady_clock::now() - start).count());
+			}
+		} catch (const std::exception &err) {
+			local_error = err.what();
+			++local_failed;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		latencies.insert(latencies.end(), local.begin(), local.end());
+		failed += local_failed;
+		if (first_error.empty()) {
+			first_error = local_error;
+		}
+	};
+
+	const auto start = steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < connection_count; ++i) {
+		threads.emplace_back(run);
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	const double elapsed =
+		std::chrono::duration<double>(steady_clock::now() - start).count();
+
+	std::sort(latencies.begin(), latencies.end());
+
+	std::cout
+		<< std::fixed << std::setprecision(3)
+		<< latencies.size() << " " << operation << " requests in "
+		<< elapsed << "s over " << connection_count << " connections, "
+		<< latencies.size()/elapsed << " requests/s" << std::endl
+		<< "latency p50 " << percentile(latencies, .5) << "ms"
+		<< ", p99 " << percentile(latencies, .99) << "ms"
+		<< ", max " << percentile(latencies, 1.) << "ms" << std::endl;
+
+	if (failed > 0) {
+		std::cout << failed << " failed: " << first_error << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/// transcode.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+///
+/// Transcodes the audio files of a directory tree to another directory
+/// tree, using all the threads of the machine.
+///
+///     audiotranscode [-j THREADS] [-m MEGABYTES] [-b KBPS] [-q QUALITY]
+///                    [-f] INPUT_DIR OUTPUT_DIR EXTENSION
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <audio/batch>
+#include <audio/codecs/registry>
+
+using namespace com::nealrame;
+
+namespace {
+
+void usage (const char *program) {
+	std::cerr
+		<< "usage: " << program
+		<< " [-j THREADS] [-m MEGABYTES] [-b KBPS] [-q QUALITY] [-f]"
+		<< " INPUT_DIR OUTPUT_DIR EXTENSION" << std::endl;
+}
+
+bool make_directory (const std::string &path) {
+	return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool is_decodable (const std::string &name) {
+	std::string::size_type dot = name.find_last_of('.');
+	if (dot == std::string::npos) {
+		return false;
+	}
+
+	const audio::codec::registry::entry *entry =
+		audio::codec::registry::instance().find_extension(name.substr(dot));
+
+	return entry != nullptr && entry->shared_decoder;
+}
+
+std::string replace_extension (const std::string &name, const std::string &ext) {
+	return name.substr(0, name.find_last_of('.')) + ext;
+}
+
+// Adds a job for each decodable file of the input tree and creates the
+// matching directories of the output tree.
+void collect (
+		const std::string &input_dir,
+		const std::string &output_dir,
+		const std::string &ext,
+		const audio::codec::encoder_options &options,
+		std::vector<audio::batch::job> &jobs) {
+	DIR *dir = opendir(input_dir.c_str());
+
+	if (dir == nullptr) {
+		std::cerr << "failed to open " << input_dir << std::endl;
+		return;
+	}
+
+	while (struct dirent *dirent = readdir(dir)) {
+		const std::string name(dirent->d_name);
+		if (name == "." || name == "..") {
+			continue;
+		}
+
+		const std::string input = input_dir + "/" + name;
+		struct stat st;
+		if (stat(input.c_str(), &st) != 0) {
+			continue;
+		}
+
+		if (S_ISDIR(st.st_mode)) {
+			const std::string output = output_dir + "/" + name;
+			if (make_directory(output)) {
+				collect(input, output, ext, options, jobs);
+			} else {
+				std::cerr << "failed to create " << output << std::endl;
+			}
+		} else if (S_ISREG(st.st_mode) && is_decodable(name)) {
+			jobs.push_back(audio::batch::job{
+				input,
+				output_dir + "/" + replace_extension(name, ext),
+				options
+			});
+		}
+	}
+	closedir(dir);
+}
+
+} // namespace
+
+int main (int argc, char **argv) {
+	unsigned int thread_count = 0;
+	size_t memory_budget = audio::batch::default_memory_budget;
+	audio::codec::encoder_options options;
+	std::vector<std::string> args;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg(argv[i]);
+		const bool has_value = i + 1 < argc;
+
+		if (arg == "-j" && has_value) {
+			thread_count = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-m" && has_value) {
+			memory_budget = size_t(std::strtoul(argv[++i], nullptr, 10)) << 20;
+		} else if (arg == "-b" && has_value) {
+			options.bitrate = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-q" && has_value) {
+			options.quality = std::strtof(argv[++i], nullptr);
+			options.bitrate_mode = audio::codec::encoder_options::VariableBitrate;
+		} else if (arg == "-f") {
+			options.fast = true;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			args.push_back(arg);
+		}
+	}
+
+	if (args.size() != 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::string ext = args[2];
+	if (ext[0] != '.') {
+		ext = "." + ext;
+	}
+
+	if (! make_directory(args[1])) {
+		std::cerr << "failed to create " << args[1] << std::endl;
+		return 1;
+	}
+
+	std::vector<audio::batch::job> jobs;
+	collect(args[0], args[1], ext, options, jobs);
+
+	audio::batch batch(thread_count, memory_budget);
+	size_t failed = 0;
+
+	batch.run(jobs, [&](size_t index, const audio::batch::result &res) {
+		const audio::batch::job &job = jobs[index];
+		if (res.status == audio::batch::result::Done) {
+			std::cout << "done   " << job.output
+				<< " (" << res.duration << "s)" << std::endl;
+		} else {
+			std::cout << "failed " << job.input
+				<< ": " << res.message << std::endl;
+			++failed;
+		}
+	});
+
+	std::cout
+		<< jobs.size() - failed << " of " << jobs.size()
+		<< " files transcoded with " << batch.thread_count() << " threads"
+		<< std::endl;
+
+	return failed > 0 ? 1 : 0;
+}
@@ -64,3 +64,18 @@ void buffer::copy (const void *data, size_type size, size_type offset) {
 	}
 	memcpy(this->data<int8_t>() + offset, data, size);
 }
+
+buffer com::nealrame::utils::read (std::istream &stream) {
+	const buffer::size_type chunk_size = 65536;
+	buffer data;
+	buffer::size_type size = 0;
+
+	while (stream.good()) {
+		data.resize(size + chunk_size);
+		stream.read(data.data<char>() + size, chunk_size);
+		size += stream.gcount();
+	}
+	data.resize(size);
+
+	return data;
+}
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <istream>
 #include <iterator>
 
 namespace com {
@@ -217,6 +218,11 @@ private:
 	size_t size_;
 	void * data_;
 };
+
+/// Reads the given stream up to its end and returns its content.
+/// *parameters:*
+/// - `stream`
+buffer read (std::istream &stream);
 } /* namespace utils */
 } /* namespace nealrame */
 } /* namespace com */
@@ -0,0 +1,310 @@
+/// utils_byte_source.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "utils_byte_source.h"
+#include "utils_mapped_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace com::nealrame::utils;
+
+//////////////////////////////////////////////////////////////////////////////
+// byte_source ///////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+byte_source::byte_source () :
+	eof_(false) {
+}
+
+byte_source::~byte_source () {
+}
+
+size_t byte_source::read (void *data, size_t size) {
+	unsigned char *out = static_cast<unsigned char *>(data);
+	size_t count = 0;
+
+	while (count < size) {
+		span s = read(size - count);
+		if (s.size == 0) {
+			break;
+		}
+		std::memcpy(out + count, s.data, s.size);
+		count += s.size;
+	}
+
+	return count;
+}
+
+const unsigned char * byte_source::data () const noexcept {
+	return nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// memory_source /////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+memory_source::memory_source (const void *data, size_t size) noexcept {
+	reset(data, size);
+}
+
+void memory_source::reset (const void *data, size_t size) noexcept {
+	data_ = static_cast<const unsigned char *>(data);
+	size_ = data_ != nullptr ? size : 0;
+	offset_ = 0;
+}
+
+byte_source::span memory_source::read (size_t max_size) {
+	size_t size = std::min(max_size, size_ - offset_);
+	span s{ data_ + offset_, size };
+	offset_ += size;
+	return s;
+}
+
+bool memory_source::seek (size_t offset) {
+	if (offset > size_) {
+		return false;
+	}
+	offset_ = offset;
+	return true;
+}
+
+size_t memory_source::tell () const noexcept {
+	return offset_;
+}
+
+size_t memory_source::size () const noexcept {
+	return size_;
+}
+
+bool memory_source::seekable () const noexcept {
+	return true;
+}
+
+const unsigned char * memory_source::data () const noexcept {
+	return data_;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// mapped_source /////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+mapped_source::mapped_source (const std::string &filepath) :
+	memory_source(nullptr, 0),
+	file_(new mapped_file(filepath)) {
+	reset(file_->data(), file_->size());
+}
+
+mapped_source::~mapped_source () {
+}
+
+bool mapped_source::is_open () const noexcept {
+	return file_->is_open();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// file_source ///////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+file_source::file_source (const std::string &filepath, size_t buffer_size) :
+	fd_(::open(filepath.c_str(), O_RDONLY)),
+	size_(0),
+	offset_(0),
+	buffer_(std::max<size_t>(1, buffer_size)) {
+	struct stat st;
+
+	if (fd_ >= 0 && fstat(fd_, &st) == 0) {
+		size_ = st.st_size;
+#if defined(POSIX_FADV_SEQUENTIAL)
+		posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	}
+}
+
+file_source::~file_source () {
+	if (fd_ >= 0) {
+		::close(fd_);
+	}
+}
+
+byte_source::span file_source::read (size_t max_size) {
+	size_t size = std::min({ max_size, size_ - offset_, buffer_.size() });
+	ssize_t count;
+
+	do {
+		count = size > 0 ? pread(fd_, buffer_.data(), size, offset_) : 0;
+	} while (count < 0 && errno == EINTR);
+
+	if (count <= 0) {
+		// the file shrank or can not be read anymore
+		size_ = offset_;
+		return span{ buffer_.data(), 0 };
+	}
+
+	offset_ += count;
+	return span{ buffer_.data(), size_t(count) };
+}
+
+bool file_source::seek (size_t offset) {
+	if (offset > size_) {
+		return false;
+	}
+	offset_ = offset;
+	return true;
+}
+
+size_t file_source::tell () const noexcept {
+	return offset_;
+}
+
+size_t file_source::size () const noexcept {
+	return size_;
+}
+
+bool file_source::seekable () const noexcept {
+	return is_open();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// stream_source /////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+stream_source::stream_source (std::istream &stream, size_t buffer_size) :
+	stream_(stream),
+	origin_(stream.tellg()),
+	size_(unknown_size),
+	offset_(0),
+	buffer_(std::max<size_t>(1, buffer_size)) {
+	if (seekable()) {
+		std::streambuf *buf = stream_.rdbuf();
+		std::streampos end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+
+		buf->pubseekpos(origin_, std::ios_base::in);
+
+		if (end >= origin_) {
+			size_ = end - origin_;
+		}
+	}
+}
+
+byte_source::span stream_source::read (size_t max_size) {
+	stream_.read(
+		reinterpret_cast<char *>(buffer_.data()),
+		std::min(max_size, buffer_.size()));
+
+	size_t count = stream_.gcount();
+
+	offset_ += count;
+	eof_ = count == 0 && max_size > 0;
+
+	return span{ buffer_.data(), count };
+}
+
+bool stream_source::seek (size_t offset) {
+	if (! seekable()) {
+		return false;
+	}
+
+	stream_.clear();
+	if (! stream_.seekg(origin_ + std::streamoff(offset))) {
+		stream_.clear();
+		stream_.seekg(origin_ + std::streamoff(offset_));
+		return false;
+	}
+
+	offset_ = offset;
+	eof_ = false;
+	return true;
+}
+
+size_t stream_source::tell () const noexcept {
+	return offset_;
+}
+
+size_t stream_source::size () const noexcept {
+	return size_;
+}
+
+bool stream_source::seekable () const noexcept {
+	return origin_ >= 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// source_streambuf //////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+source_streambuf::source_streambuf (byte_source &source) noexcept :
+	source_(source) {
+}
+
+source_streambuf::int_type source_streambuf::underflow () {
+	if (gptr() < egptr()) {
+		return traits_type::to_int_type(*gptr());
+	}
+
+	byte_source::span s = source_.read(65536);
+	if (s.size == 0) {
+		setg(nullptr, nullptr, nullptr);
+		return traits_type::eof();
+	}
+
+	char *first = const_cast<char *>(reinterpret_cast<const char *>(s.data));
+	setg(first, first, first + s.size);
+
+	return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize source_streambuf::showmanyc () {
+	size_t size = source_.size();
+	return size != byte_source::unknown_size
+		? std::streamsize(size - source_.tell())
+		: 0;
+}
+
+source_streambuf::pos_type source_streambuf::seekoff (
+		off_type off,
+		std::ios_base::seekdir dir,
+		std::ios_base::openmode which) {
+	// position of the next byte of the get area
+	off_type current = source_.tell() - (egptr() - gptr());
+
+	switch (dir) {
+	case std::ios_base::cur:
+		if (off == 0) {
+			return pos_type(current);
+		}
+		off += current;
+		break;
+
+	case std::ios_base::end:
+		if (source_.size() == byte_source::unknown_size) {
+			return pos_type(off_type(-1));
+		}
+		off += source_.size();
+		break;
+
+	default:
+		break;
+	}
+
+	return seekpos(off, which);
+}
+
+source_streambuf::pos_type source_streambuf::seekpos (
+		pos_type pos,
+		std::ios_base::openmode which) {
+	off_type off = pos;
+
+	if (! (which & std::ios_base::in) || off < 0 || ! source_.seek(off)) {
+		return pos_type(off_type(-1));
+	}
+
+	setg(nullptr, nullptr, nullptr);
+	return pos;
+}
@@ -0,0 +1,232 @@
+/// utils_byte_source.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_BYTE_SOURCE_H_
+#define UTILS_BYTE_SOURCE_H_
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+class mapped_file;
+
+/// class com::nealrame::utils::byte_source
+/// =======================================
+/// Bytes read sequentially as contiguous spans. Sources in memory give
+/// spans of their own data, others give spans of an internal buffer.
+class byte_source {
+public:
+	/// struct com::nealrame::utils::byte_source::span
+	/// ==============================================
+	struct span {
+		const unsigned char *data;
+		size_t size;
+	};
+
+	/// Size returned by `size` when the source does not know its size.
+	static const size_t unknown_size = static_cast<size_t>(-1);
+
+public:
+	virtual ~byte_source ();
+
+public:
+	/// Returns the next bytes of the source and moves past them. The
+	/// bytes stay valid until the next call to `read` or `seek`.
+	///
+	/// *Parameters:*
+	/// - `max_size`
+	///   The maximum count of bytes to be read.
+	///
+	/// *Returns:*
+	/// At least one byte, unless the end of the source is reached or
+	/// `max_size` is 0.
+	virtual span read (size_t max_size) = 0;
+
+	/// Moves to the given offset, relative to the start of the source.
+	/// Returns `false` if the source is not seekable or if the offset is
+	/// out of it.
+	virtual bool seek (size_t offset) = 0;
+
+	/// Returns the offset of the next byte to be read, relative to the
+	/// start of the source.
+	virtual size_t tell () const noexcept = 0;
+
+	/// Returns the size of the source, or `unknown_size`.
+	virtual size_t size () const noexcept = 0;
+
+	/// Returns `true` if `seek` can be used.
+	virtual bool seekable () const noexcept = 0;
+
+	/// Returns the whole bytes of the source if they are in memory,
+	/// `nullptr` otherwise. They stay valid as long as the source.
+	/// Default implementation returns `nullptr`.
+	virtual const unsigned char * data () const noexcept;
+
+public:
+	/// Copies the next bytes of the source to the given data and moves
+	/// past them. Returns the count of bytes copied, fewer than requested
+	/// only at the end of the source.
+	size_t read (void *data, size_t size);
+
+	/// Returns `true` if there is no more byte to be read.
+	bool eof () const noexcept
+	{ return size() != unknown_size ? tell() >= size() : eof_; }
+
+protected:
+	byte_source ();
+
+	/// To be set by sources which do not know their size, when their
+	/// end is reached.
+	bool eof_;
+};
+
+/// class com::nealrame::utils::memory_source
+/// =========================================
+/// A `byte_source` over a memory area. Reads do not copy anything, the
+/// data must outlive the `memory_source`.
+class memory_source : public byte_source {
+public:
+	memory_source (const void *data, size_t size) noexcept;
+
+public:
+	using byte_source::read;
+	virtual span read (size_t max_size);
+	virtual bool seek (size_t offset);
+	virtual size_t tell () const noexcept;
+	virtual size_t size () const noexcept;
+	virtual bool seekable () const noexcept;
+	virtual const unsigned char * data () const noexcept;
+
+protected:
+	void reset (const void *data, size_t size) noexcept;
+
+private:
+	const unsigned char *data_;
+	size_t size_;
+	size_t offset_;
+};
+
+/// class com::nealrame::utils::mapped_source
+/// =========================================
+/// A `byte_source` over a file mapped in memory, see `mapped_file`.
+class mapped_source : public memory_source {
+public:
+	/// Maps the given file. If the file can not be mapped, the source is
+	/// empty and not open, see `is_open`.
+	explicit mapped_source (const std::string &filepath);
+
+	virtual ~mapped_source ();
+
+public:
+	/// Returns `true` if the file is mapped.
+	bool is_open () const noexcept;
+
+private:
+	std::unique_ptr<mapped_file> file_;
+};
+
+/// class com::nealrame::utils::file_source
+/// =======================================
+/// A `byte_source` reading a file with `pread`. The kernel is told the
+/// file is read sequentially.
+class file_source : public byte_source {
+public:
+	/// Opens the given file. If the file can not be opened, the source is
+	/// empty and not open, see `is_open`.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file.
+	/// - `buffer_size`
+	///   The maximum count of bytes read at once.
+	explicit file_source (const std::string &filepath, size_t buffer_size = 65536);
+
+	file_source (const file_source &) = delete;
+	file_source & operator= (const file_source &) = delete;
+
+	virtual ~file_source ();
+
+public:
+	/// Returns `true` if the file is open.
+	bool is_open () const noexcept
+	{ return fd_ >= 0; }
+
+public:
+	using byte_source::read;
+	virtual span read (size_t max_size);
+	virtual bool seek (size_t offset);
+	virtual size_t tell () const noexcept;
+	virtual size_t size () const noexcept;
+	virtual bool seekable () const noexcept;
+
+private:
+	int fd_;
+	size_t size_;
+	size_t offset_;
+	std::vector<unsigned char> buffer_;
+};
+
+/// class com::nealrame::utils::stream_source
+/// =========================================
+/// A `byte_source` reading a `std::istream`. Offsets are relative to the
+/// position of the stream when the `stream_source` is constructed, its
+/// size is the one of the stream at that time. The stream must outlive
+/// the `stream_source`.
+class stream_source : public byte_source {
+public:
+	/// *Parameters:*
+	/// - `stream`
+	///   The stream to be read.
+	/// - `buffer_size`
+	///   The maximum count of bytes read at once.
+	explicit stream_source (std::istream &stream, size_t buffer_size = 65536);
+
+public:
+	using byte_source::read;
+	virtual span read (size_t max_size);
+	virtual bool seek (size_t offset);
+	virtual size_t tell () const noexcept;
+	virtual size_t size () const noexcept;
+	virtual bool seekable () const noexcept;
+
+private:
+	std::istream &stream_;
+	std::streampos origin_;
+	size_t size_;
+	size_t offset_;
+	std::vector<unsigned char> buffer_;
+};
+
+/// class com::nealrame::utils::source_streambuf
+/// ============================================
+/// A read-only `std::streambuf` over a `byte_source`. The spans of the
+/// source are used as get areas, nothing is copied.
+class source_streambuf : public std::streambuf {
+public:
+	explicit source_streambuf (byte_source &source) noexcept;
+
+protected:
+	virtual int_type underflow ();
+	virtual std::streamsize showmanyc ();
+	virtual pos_type seekoff (
+			off_type off,
+			std::ios_base::seekdir dir,
+			std::ios_base::openmode which);
+	virtual pos_type seekpos (pos_type pos, std::ios_base::openmode which);
+
+private:
+	byte_source &source_;
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_BYTE_SOURCE_H_ */
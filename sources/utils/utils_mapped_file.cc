@@ -0,0 +1,46 @@
+/// utils_mapped_file.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "utils_mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace com::nealrame::utils;
+
+mapped_file::mapped_file (const std::string &filepath) :
+	data_(nullptr),
+	size_(0),
+	open_(false) {
+	int fd = ::open(filepath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == 0) {
+		size_ = st.st_size;
+		if (size_ == 0) {
+			open_ = true;
+		} else {
+			void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				posix_madvise(data, size_, POSIX_MADV_SEQUENTIAL);
+				data_ = data;
+				open_ = true;
+			}
+		}
+	}
+
+	// the mapping outlives the descriptor
+	::close(fd);
+}
+
+mapped_file::~mapped_file () {
+	if (data_ != nullptr) {
+		munmap(data_, size_);
+	}
+}
@@ -0,0 +1,57 @@
+/// utils_mapped_file.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_MAPPED_FILE_H_
+#define UTILS_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// class com::nealrame::utils::mapped_file
+/// =======================================
+/// A file mapped read-only in memory. The file is unmapped when the
+/// `mapped_file` is destroyed.
+class mapped_file {
+public:
+	/// Maps the given file. If the file can not be opened or mapped, the
+	/// `mapped_file` is not open, see `is_open`.
+	///
+	/// *Parameters:*
+	/// - `filepath`
+	///   Path of the file to be mapped.
+	explicit mapped_file (const std::string &filepath);
+
+	mapped_file (const mapped_file &) = delete;
+	mapped_file & operator= (const mapped_file &) = delete;
+
+	~mapped_file ();
+
+public:
+	/// Returns `true` if the file is mapped.
+	bool is_open () const noexcept
+	{ return open_; }
+
+	/// Returns the content of the file. May be null if the file is empty.
+	const void * data () const noexcept
+	{ return data_; }
+
+	/// Returns the size of the file.
+	size_t size () const noexcept
+	{ return size_; }
+
+private:
+	void *data_;
+	size_t size_;
+	bool open_;
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_MAPPED_FILE_H_ */
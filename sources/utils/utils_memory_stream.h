@@ -0,0 +1,83 @@
+/// utils_memory_stream.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_MEMORY_STREAM_H_
+#define UTILS_MEMORY_STREAM_H_
+
+#include <istream>
+#include <streambuf>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// class com::nealrame::utils::memory_streambuf
+/// ============================================
+/// A read-only, seekable `std::streambuf` over a memory area. The data are
+/// not copied and must outlive the `memory_streambuf`.
+class memory_streambuf : public std::streambuf {
+public:
+	/// Constructs a `memory_streambuf` over the given data.
+	/// *parameters:*
+	/// - `data`
+	/// - `size`
+	memory_streambuf (const void *data, size_t size) {
+		char *first = const_cast<char *>(static_cast<const char *>(data));
+		setg(first, first, first + size);
+	}
+
+protected:
+	virtual pos_type seekoff (
+			off_type off,
+			std::ios_base::seekdir dir,
+			std::ios_base::openmode which) {
+		switch (dir) {
+		case std::ios_base::cur:
+			off += gptr() - eback();
+			break;
+
+		case std::ios_base::end:
+			off += egptr() - eback();
+			break;
+
+		default:
+			break;
+		}
+		return seekpos(off, which);
+	}
+
+	virtual pos_type seekpos (pos_type pos, std::ios_base::openmode which) {
+		off_type off = pos;
+		if (! (which & std::ios_base::in) || off < 0 || off > egptr() - eback()) {
+			return pos_type(off_type(-1));
+		}
+		setg(eback(), eback() + off, egptr());
+		return pos;
+	}
+};
+
+/// class com::nealrame::utils::memory_istream
+/// ==========================================
+/// A `std::istream` reading from a memory area without copying it.
+class memory_istream : public std::istream {
+public:
+	/// Constructs a `memory_istream` over the given data.
+	/// *parameters:*
+	/// - `data`
+	/// - `size`
+	memory_istream (const void *data, size_t size) :
+		std::istream(nullptr),
+		buffer_(data, size) {
+		rdbuf(&buffer_);
+	}
+
+private:
+	memory_streambuf buffer_;
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_MEMORY_STREAM_H_ */
@@ -0,0 +1,62 @@
+/// utils_parallel.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "utils_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace com::nealrame;
+
+unsigned int utils::thread_count (unsigned int requested) {
+	if (requested == 0) {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+	return requested;
+}
+
+void utils::parallel_for (
+		size_t count,
+		unsigned int thread_count,
+		const std::function<void (size_t)> &task) {
+	std::atomic<size_t> next(0);
+	std::exception_ptr exception;
+	std::mutex mutex;
+
+	auto worker = [&] {
+		size_t i;
+		while ((i = next++) < count) {
+			try {
+				task(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (! exception) {
+					exception = std::current_exception();
+				}
+				next = count;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	size_t extra_threads = std::min<size_t>(count, utils::thread_count(thread_count)) - (count > 0 ? 1 : 0);
+
+	for (size_t i = 0; i < extra_threads; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+
+	for (auto &thread: threads) {
+		thread.join();
+	}
+
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
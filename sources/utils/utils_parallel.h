@@ -0,0 +1,42 @@
+/// utils_parallel.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_PARALLEL_H_
+#define UTILS_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// Returns the count of threads to be used for a requested count of
+/// threads. A requested count of 0 stands for the count of hardware
+/// threads.
+unsigned int thread_count (unsigned int requested);
+
+/// Calls `task(i)` for each `i` in `[0, count)` using at most
+/// `thread_count` threads, the calling thread included.
+///
+/// If a task throws, the remaining tasks are not started and the first
+/// exception is rethrown once all threads are done.
+///
+/// *Parameters:*
+/// - `count`
+///   The count of tasks.
+/// - `thread_count`
+///   The maximum count of threads.
+/// - `task`
+///   The task to be run.
+void parallel_for (
+	size_t count,
+	unsigned int thread_count,
+	const std::function<void (size_t)> &task);
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_PARALLEL_H_ */
@@ -0,0 +1,44 @@
+/// utils_shared_library.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "utils_shared_library.h"
+
+#include <dlfcn.h>
+
+using namespace com::nealrame::utils;
+
+shared_library::shared_library (std::initializer_list<const char *> names) :
+	names_(names.begin(), names.end()),
+	handle_(nullptr) {
+}
+
+shared_library::~shared_library () {
+	if (handle_ != nullptr) {
+		dlclose(handle_);
+	}
+}
+
+bool shared_library::load () const {
+	std::call_once(flag_, [this] {
+		for (const std::string &name: names_) {
+			if ((handle_ = dlopen(name.c_str(), RTLD_NOW|RTLD_LOCAL)) != nullptr) {
+				break;
+			}
+		}
+	});
+	return handle_ != nullptr;
+}
+
+void * shared_library::symbol (const char *name) const {
+	return load() ? dlsym(handle_, name) : nullptr;
+}
+
+std::string shared_library::names () const {
+	std::string res;
+	for (const std::string &name: names_) {
+		if (! res.empty()) res += ", ";
+		res += name;
+	}
+	return res;
+}
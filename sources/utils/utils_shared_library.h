@@ -0,0 +1,58 @@
+/// utils_shared_library.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_SHARED_LIBRARY_H_
+#define UTILS_SHARED_LIBRARY_H_
+
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// class com::nealrame::utils::shared_library
+/// ==========================================
+/// A shared library loaded at runtime, the first time it is used. It stays
+/// loaded until the `shared_library` is destroyed.
+class shared_library {
+public:
+	/// Constructs a `shared_library`.
+	///
+	/// *Parameters:*
+	/// - `names`
+	///   The file names the library may have, tried in order when it is
+	///   loaded.
+	shared_library (std::initializer_list<const char *> names);
+
+	shared_library (const shared_library &) = delete;
+	shared_library & operator= (const shared_library &) = delete;
+
+	virtual ~shared_library ();
+
+public:
+	/// Loads the library if it has not been tried yet. Returns `true` if
+	/// the library is loaded.
+	bool load () const;
+
+	/// Returns the address of the given symbol, or null if the library
+	/// can not be loaded or has no such symbol.
+	void * symbol (const char *name) const;
+
+	/// Returns the names the library may have, separated by commas.
+	std::string names () const;
+
+private:
+	std::vector<std::string> names_;
+	mutable std::once_flag flag_;
+	mutable void *handle_;
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_SHARED_LIBRARY_H_ */
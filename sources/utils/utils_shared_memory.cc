@@ -0,0 +1,137 @@
+/// utils_shared_memory.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "utils_shared_memory.h"
+#include "utils_unix_socket.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace com::nealrame::utils;
+
+namespace shared_memory_ {
+
+#if defined(MFD_ALLOW_SEALING) && defined(F_ADD_SEALS)
+#	define SHARED_MEMORY_SEALING 1
+
+// Seals a receiver relies on: once they are set, the content can neither
+// change under its mapping nor be truncated beneath it.
+const int content_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+#endif
+
+void * map (int fd, size_t size, int protection) {
+	if (size == 0) {
+		return nullptr;
+	}
+	void *data = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+	return data == MAP_FAILED ? nullptr : data;
+}
+
+} // namespace shared_memory_
+
+shared_memory::shared_memory (size_t size) :
+	fd_(-1),
+	data_(nullptr),
+	size_(size),
+	sealed_(false) {
+#if defined(SHARED_MEMORY_SEALING)
+	int fd = memfd_create("audio", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) {
+		return;
+	}
+	if (ftruncate(fd, size) == 0) {
+		data_ = shared_memory_::map(fd, size, PROT_READ | PROT_WRITE);
+		if (data_ != nullptr || size == 0) {
+			fd_ = fd;
+			return;
+		}
+	}
+	::close(fd);
+#endif
+}
+
+shared_memory::shared_memory (int fd, void *data, size_t size) noexcept :
+	fd_(fd),
+	data_(data),
+	size_(size),
+	sealed_(true) {
+}
+
+shared_memory::~shared_memory () {
+	if (data_ != nullptr) {
+		munmap(data_, size_);
+	}
+	if (fd_ >= 0) {
+		::close(fd_);
+	}
+}
+
+bool shared_memory::seal () noexcept {
+#if defined(SHARED_MEMORY_SEALING)
+	if (! is_open()) {
+		return false;
+	}
+	if (sealed_) {
+		return true;
+	}
+	// F_SEAL_WRITE is refused while a writable shared mapping exists.
+	if (data_ != nullptr) {
+		munmap(data_, size_);
+		data_ = nullptr;
+	}
+	if (fcntl(fd_, F_ADD_SEALS, shared_memory_::content_seals | F_SEAL_SEAL) < 0) {
+		return false;
+	}
+	data_ = shared_memory_::map(fd_, size_, PROT_READ);
+	sealed_ = data_ != nullptr || size_ == 0;
+	return sealed_;
+#else
+	return false;
+#endif
+}
+
+bool shared_memory::send (int socket) const noexcept {
+	const char byte = 0;
+	return sealed_ && send_message(socket, &byte, sizeof(byte), fd_);
+}
+
+std::unique_ptr<shared_memory> shared_memory::receive (int socket) {
+	char byte;
+	int fd;
+	if (receive_message(socket, &byte, sizeof(byte), fd) != sizeof(byte) || fd < 0) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		return nullptr;
+	}
+	return adopt(fd);
+}
+
+std::unique_ptr<shared_memory> shared_memory::adopt (int fd) {
+#if defined(SHARED_MEMORY_SEALING)
+	// The sender may be untrusted: the area is used only if it can not be
+	// modified anymore, and its size is taken from the file itself.
+	struct stat st;
+	int seals = fcntl(fd, F_GET_SEALS);
+	if (seals < 0
+			|| (seals & shared_memory_::content_seals) != shared_memory_::content_seals
+			|| fstat(fd, &st) != 0) {
+		::close(fd);
+		return nullptr;
+	}
+
+	size_t size = st.st_size;
+	void *data = shared_memory_::map(fd, size, PROT_READ);
+	if (data == nullptr && size > 0) {
+		::close(fd);
+		return nullptr;
+	}
+	return std::unique_ptr<shared_memory>(new shared_memory(fd, data, size));
+#else
+	::close(fd);
+	return nullptr;
+#endif
+}
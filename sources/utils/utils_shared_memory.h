@@ -0,0 +1,107 @@
+/// utils_shared_memory.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_SHARED_MEMORY_H_
+#define UTILS_SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <memory>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// class com::nealrame::utils::shared_memory
+/// =========================================
+/// A memory area backed by an anonymous file, to be handed to other
+/// processes through a Unix socket. The area is writable by the process
+/// which creates it until it is sealed. Once sealed, no process can
+/// modify or resize it anymore.
+///
+/// Shared memory areas require `memfd_create` and file seals, on other
+/// systems they are never open.
+class shared_memory {
+public:
+	/// Creates a writable area of the given size. If the area can not be
+	/// created, the `shared_memory` is not open, see `is_open`.
+	explicit shared_memory (size_t size);
+
+	shared_memory (const shared_memory &) = delete;
+	shared_memory & operator= (const shared_memory &) = delete;
+
+	~shared_memory ();
+
+public:
+	/// Receives an area sent over the given Unix socket by `send`. The
+	/// area is mapped read-only.
+	///
+	/// *Returns:*
+	/// The received area, or null if the socket did not hold a
+	/// descriptor or if the area is not sealed.
+	static std::unique_ptr<shared_memory> receive (int socket);
+
+	/// Maps the area of the given descriptor read-only. The descriptor is
+	/// owned by the returned area, or closed if it is refused.
+	///
+	/// *Returns:*
+	/// The area, or null if it is not sealed.
+	static std::unique_ptr<shared_memory> adopt (int fd);
+
+public:
+	/// Returns `true` if the area is open.
+	bool is_open () const noexcept
+	{ return fd_ >= 0; }
+
+	/// Returns `true` if the area is sealed.
+	bool is_sealed () const noexcept
+	{ return sealed_; }
+
+	/// Returns the content of the area.
+	const void * data () const noexcept
+	{ return data_; }
+
+	/// Returns the content of the area to be written, or null once it is
+	/// sealed.
+	void * writable_data () noexcept
+	{ return sealed_ ? nullptr : data_; }
+
+	/// Returns the size of the area.
+	size_t size () const noexcept
+	{ return size_; }
+
+	/// Returns the descriptor of the area, to be sent with
+	/// `send_message`.
+	int descriptor () const noexcept
+	{ return fd_; }
+
+public:
+	/// Seals the area. It is mapped again read-only, so the pointers
+	/// previously returned by `data` are not valid anymore.
+	///
+	/// *Returns:*
+	/// `true` if the area is sealed.
+	bool seal () noexcept;
+
+	/// Sends the descriptor of the area over the given Unix socket. The
+	/// area must be sealed.
+	///
+	/// *Returns:*
+	/// `true` if the descriptor has been sent.
+	bool send (int socket) const noexcept;
+
+private:
+	shared_memory (int fd, void *data, size_t size) noexcept;
+
+private:
+	int fd_;
+	void *data_;
+	size_t size_;
+	bool sealed_;
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_SHARED_MEMORY_H_ */
@@ -0,0 +1,203 @@
+/// utils_thread_pool.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+
+#include "utils_thread_pool.h"
+#include "utils_parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace com::nealrame;
+
+namespace thread_pool_ {
+
+// Queue of a thread of a pool. A thread sleeps on its own condition, it is
+// woken up when a task is queued on its queue or, when it is idle, to steal
+// a task queued on a busy thread.
+struct queue {
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::deque<std::function<void ()>> tasks;
+	std::atomic<bool> idle{false};
+	bool wake = false;
+};
+
+// Pool and queue of the current thread, if it is a thread of a pool.
+thread_local const void *current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace thread_pool_
+
+struct utils::thread_pool::impl {
+	std::vector<thread_pool_::queue> queues;
+	std::vector<std::thread> threads;
+
+	// count of tasks submitted and not done yet
+	std::atomic<size_t> pending{0};
+	std::atomic<size_t> next_queue{0};
+	std::atomic<bool> stopping{false};
+
+	// first exception escaped from a task since the last wait
+	std::exception_ptr error;
+
+	std::mutex mutex;
+	std::condition_variable all_done;
+
+	explicit impl (unsigned int thread_count) :
+		queues(thread_count) {
+	}
+
+	bool pop (size_t index, std::function<void ()> &task) {
+		// own tasks first, most recent first
+		{
+			thread_pool_::queue &q = queues[index];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (! q.tasks.empty()) {
+				task = std::move(q.tasks.back());
+				q.tasks.pop_back();
+				return true;
+			}
+		}
+		// then steal the oldest task of the others
+		for (size_t i = 1; i < queues.size(); ++i) {
+			thread_pool_::queue &q = queues[(index + i)%queues.size()];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (! q.tasks.empty()) {
+				task = std::move(q.tasks.front());
+				q.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Wakes up the thread of the given queue if it is idle, or else any
+	// idle thread so that it steals the task just queued.
+	void notify (size_t index) {
+		for (size_t i = 0; i < queues.size(); ++i) {
+			thread_pool_::queue &q = queues[(index + i)%queues.size()];
+			if (q.idle.load()) {
+				{
+					std::lock_guard<std::mutex> lock(q.mutex);
+					q.wake = true;
+				}
+				q.wakeup.notify_one();
+				return;
+			}
+		}
+	}
+
+	void execute (std::function<void ()> &task) {
+		try {
+			task();
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (! error) {
+				error = std::current_exception();
+			}
+		}
+		task = nullptr;
+
+		if (pending.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(mutex);
+			all_done.notify_all();
+		}
+	}
+
+	void run (size_t index) {
+		thread_pool_::current_pool = this;
+		thread_pool_::current_index = index;
+
+		thread_pool_::queue &q = queues[index];
+		std::function<void ()> task;
+
+		for (;;) {
+			if (pop(index, task)) {
+				execute(task);
+				continue;
+			}
+			if (stopping.load()) {
+				return;
+			}
+
+			// a task queued on a busy thread before this one is seen
+			// idle is found by this last look up
+			q.idle.store(true);
+			if (pop(index, task)) {
+				q.idle.store(false);
+				execute(task);
+				continue;
+			}
+			{
+				std::unique_lock<std::mutex> lock(q.mutex);
+				q.wakeup.wait(lock, [&] {
+					return q.wake || ! q.tasks.empty() || stopping.load();
+				});
+				q.wake = false;
+			}
+			q.idle.store(false);
+		}
+	}
+
+	void wait () {
+		std::unique_lock<std::mutex> lock(mutex);
+		all_done.wait(lock, [this] { return pending.load() == 0; });
+	}
+};
+
+utils::thread_pool::thread_pool (unsigned int thread_count) :
+	d_(new impl(utils::thread_count(thread_count))) {
+	for (size_t i = 0; i < d_->queues.size(); ++i) {
+		d_->threads.emplace_back(&impl::run, d_.get(), i);
+	}
+}
+
+utils::thread_pool::~thread_pool () {
+	d_->wait();
+	d_->stopping.store(true);
+	for (auto &q: d_->queues) {
+		std::lock_guard<std::mutex> lock(q.mutex);
+		q.wakeup.notify_one();
+	}
+	for (auto &thread: d_->threads) {
+		thread.join();
+	}
+}
+
+unsigned int utils::thread_pool::size () const noexcept {
+	return d_->threads.size();
+}
+
+void utils::thread_pool::submit (std::function<void ()> task) {
+	const size_t index = thread_pool_::current_pool == d_.get()
+		? thread_pool_::current_index
+		: d_->next_queue.fetch_add(1)%d_->queues.size();
+
+	d_->pending.fetch_add(1);
+	{
+		thread_pool_::queue &q = d_->queues[index];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		q.tasks.push_back(std::move(task));
+	}
+	d_->notify(index);
+}
+
+void utils::thread_pool::wait () {
+	d_->wait();
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(d_->mutex);
+		std::swap(error, d_->error);
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
@@ -0,0 +1,64 @@
+/// utils_thread_pool.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_THREAD_POOL_H_
+#define UTILS_THREAD_POOL_H_
+
+#include <utils/pimpl>
+
+#include <functional>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// class com::nealrame::utils::thread_pool
+/// =======================================
+/// A fixed set of threads running submitted tasks. Each thread has its own
+/// queue of tasks. It runs the tasks it submitted itself last in first
+/// out, and steals the oldest tasks of the other threads when its queue is
+/// empty.
+class thread_pool {
+public:
+	/// Starts a `thread_pool`.
+	///
+	/// *Parameters:*
+	/// - `thread_count`
+	///   The count of threads. A count of 0 stands for the count of
+	///   hardware threads.
+	explicit thread_pool (unsigned int thread_count = 0);
+
+	thread_pool (const thread_pool &) = delete;
+	thread_pool & operator= (const thread_pool &) = delete;
+
+	/// Waits for the submitted tasks then stops the threads.
+	~thread_pool ();
+
+public:
+	/// Returns the count of threads.
+	unsigned int size () const noexcept;
+
+	/// Submits a task. Tasks submitted from a thread of the pool are
+	/// queued on this thread, others are spread over all threads.
+	///
+	/// Exceptions escaping a task are caught, the first of them is
+	/// rethrown by `wait`.
+	void submit (std::function<void ()> task);
+
+	/// Waits until all submitted tasks are done. Must not be called from
+	/// a task.
+	///
+	/// *Exceptions:*
+	/// - the first exception escaped from a task since the last call, if
+	///   any. The other tasks are done anyway.
+	void wait ();
+
+	PIMPL
+};
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_THREAD_POOL_H_ */
@@ -0,0 +1,206 @@
+/// utils_unix_socket.cc
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#include "utils_unix_socket.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace com::nealrame::utils;
+
+namespace unix_socket_ {
+
+#if defined(MSG_NOSIGNAL)
+// a peer which went away must not kill the sender
+const int send_flags = MSG_NOSIGNAL;
+#else
+const int send_flags = 0;
+#endif
+
+#if defined(MSG_CMSG_CLOEXEC)
+const int receive_flags = MSG_CMSG_CLOEXEC;
+#else
+const int receive_flags = 0;
+#endif
+
+bool make_address (const std::string &path, struct sockaddr_un &address) {
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	std::memcpy(address.sun_path, path.data(), path.size());
+	return true;
+}
+
+int make_socket () {
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (fd >= 0) {
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+	return fd;
+}
+
+} // namespace unix_socket_
+
+int com::nealrame::utils::listen_unix (const std::string &path, int backlog) {
+	struct sockaddr_un address;
+	if (! unix_socket_::make_address(path, address)) {
+		return -1;
+	}
+
+	struct stat st;
+	if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(path.c_str());
+	}
+
+	int fd = unix_socket_::make_socket();
+	if (fd < 0) {
+		return -1;
+	}
+	// connections are refused until listen, the socket is restricted to
+	// its user before
+	if (bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0
+			|| chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0
+			|| listen(fd, backlog) != 0) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int com::nealrame::utils::connect_unix (const std::string &path) {
+	struct sockaddr_un address;
+	if (! unix_socket_::make_address(path, address)) {
+		return -1;
+	}
+
+	int fd = unix_socket_::make_socket();
+	if (fd < 0) {
+		return -1;
+	}
+
+	int status;
+	do {
+		status = connect(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
+	} while (status != 0 && errno == EINTR);
+
+	if (status != 0) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool com::nealrame::utils::peer_is_trusted (int socket) noexcept {
+	uid_t uid;
+#if defined(SO_PEERCRED)
+	struct ucred credentials;
+	socklen_t size = sizeof(credentials);
+	if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) {
+		return false;
+	}
+	uid = credentials.uid;
+#else
+	gid_t gid;
+	if (getpeereid(socket, &uid, &gid) != 0) {
+		return false;
+	}
+#endif
+	return uid == geteuid() || uid == 0;
+}
+
+bool com::nealrame::utils::send_message (
+		int socket,
+		const void *data,
+		size_t size,
+		int fd) noexcept {
+	struct iovec iov;
+	iov.iov_base = const_cast<void *>(data);
+	iov.iov_len = size;
+
+	union {
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(sizeof(int))];
+	} control;
+	std::memset(&control, 0, sizeof(control));
+
+	struct msghdr message;
+	std::memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+
+	if (fd >= 0) {
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+
+		struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	}
+
+	ssize_t count;
+	do {
+		count = sendmsg(socket, &message, unix_socket_::send_flags);
+	} while (count < 0 && errno == EINTR);
+	return count == ssize_t(size);
+}
+
+ssize_t com::nealrame::utils::receive_message (
+		int socket,
+		void *data,
+		size_t size,
+		int &fd) noexcept {
+	fd = -1;
+
+	struct iovec iov;
+	iov.iov_base = data;
+	iov.iov_len = size;
+
+	union {
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(sizeof(int))];
+	} control;
+
+	struct msghdr message;
+	std::memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	ssize_t count;
+	do {
+		count = recvmsg(socket, &message, unix_socket_::receive_flags);
+	} while (count < 0 && errno == EINTR);
+
+	if (count < 0) {
+		return -1;
+	}
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+	if (cmsg != nullptr
+			&& cmsg->cmsg_level == SOL_SOCKET
+			&& cmsg->cmsg_type == SCM_RIGHTS
+			&& cmsg->cmsg_len >= CMSG_LEN(sizeof(int))) {
+		std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	if ((message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+		return -1;
+	}
+	return count;
+}
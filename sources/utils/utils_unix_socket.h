@@ -0,0 +1,78 @@
+/// utils_unix_socket.h
+///
+/// Created on: October 19, 2026
+///     Author: [NealRame](mailto:contact@nealrame.com)
+#ifndef UTILS_UNIX_SOCKET_H_
+#define UTILS_UNIX_SOCKET_H_
+
+#include <cstddef>
+#include <string>
+
+#include <sys/types.h>
+
+namespace com {
+namespace nealrame {
+namespace utils {
+
+/// Unix sockets of sequenced packets: messages keep their boundaries and
+/// may carry a file descriptor, so that a process can hand memory to
+/// another one, see `shared_memory`.
+
+/// Returns a socket listening at the given path, or -1 on failure. A
+/// socket already at this path is removed first, other files are not.
+/// Only the user of the process may connect to it.
+///
+/// *Parameters:*
+/// - `path`
+///   Path of the socket.
+/// - `backlog`
+///   The maximum count of connections waiting to be accepted.
+int listen_unix (const std::string &path, int backlog);
+
+/// Returns a socket connected to the one listening at the given path, or
+/// -1 on failure.
+int connect_unix (const std::string &path);
+
+/// Returns `true` if the peer of the given connected socket runs as the
+/// user of the process or as root.
+bool peer_is_trusted (int socket) noexcept;
+
+/// Sends a message over the given socket.
+///
+/// *Parameters:*
+/// - `socket`
+///   A connected socket.
+/// - `data`
+///   The message, at least 1 byte long.
+/// - `size`
+///   The size of the message.
+/// - `fd`
+///   A descriptor sent with the message, or -1. It stays open.
+///
+/// *Returns:*
+/// `true` if the message has been sent.
+bool send_message (int socket, const void *data, size_t size, int fd = -1) noexcept;
+
+/// Receives a message from the given socket.
+///
+/// *Parameters:*
+/// - `socket`
+///   A connected socket.
+/// - `data`
+///   The buffer of the message.
+/// - `size`
+///   The size of the buffer.
+/// - `fd`
+///   Set to the descriptor sent with the message, or to -1. The caller
+///   owns it.
+///
+/// *Returns:*
+/// The size of the message, 0 if the peer closed the connection, or -1 on
+/// failure or if the message does not fit in the buffer.
+ssize_t receive_message (int socket, void *data, size_t size, int &fd) noexcept;
+
+} /* namespace utils */
+} /* namespace nealrame */
+} /* namespace com */
+
+#endif /* UTILS_UNIX_SOCKET_H_ */